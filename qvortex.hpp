@@ -0,0 +1,474 @@
+/**
+ * Qvortex Hash Library - header-only C++ API
+ *
+ * qvortex::hasher<Backend, Rounds, DigestBytes> is the streaming hasher with
+ * its parameters fixed at compile time: the ARX rounds are unrolled with
+ * constexpr word indices, so the per-round state rotation costs nothing,
+ * and hash<N>(ptr) hashes exactly N bytes with all block and padding logic
+ * resolved by the compiler.
+ *
+ * With the default parameters (portable or dispatch backend, 2 rounds,
+ * 64-byte digest) every digest matches qvortex_hash; other round counts
+ * define a different function, and DigestBytes < 64 truncates the digest.
+ *
+ * Backends:
+ *   qvortex::backend::portable  self-contained C++; needs nothing else
+ *   qvortex::backend::dispatch  the library's runtime-selected SIMD kernels
+ *                               (link libqvortex; default rounds only)
+ *
+ * Requires C++17; update(std::span) is available under C++20.
+ */
+ 
+ #ifndef QVORTEX_HPP
+ #define QVORTEX_HPP
+ 
+ #include <array>
+ #include <cstddef>
+ #include <cstdint>
+ #include <cstring>
+ #include <random>
+ #include <string_view>
+ #include <type_traits>
+ #include <utility>
+ #if defined(__has_include)
+ #if __has_include(<span>) && __cplusplus >= 202002L
+ #include <span>
+ #endif
+ #endif
+ 
+ extern "C" int qvortex_compress(uint64_t state[8], const uint8_t sbox[256],
+                                 const uint8_t *blocks, size_t nblocks);
+ 
+ namespace qvortex {
+ 
+ inline constexpr std::size_t state_words = 8;
+ inline constexpr std::size_t block_bytes = 64;
+ inline constexpr std::size_t max_digest_bytes = 64;
+ inline constexpr int default_rounds = 2;
+ 
+ /* Longest input whose 0x80 byte and 64-bit length still fit in one block */
+ inline constexpr std::size_t short_max = block_bytes - 9;
+ 
+ namespace detail {
+ 
+ constexpr uint64_t rotl64(uint64_t x, unsigned n) {
+   return (x << n) | (x >> ((64 - n) & 63));
+ }
+ 
+ constexpr uint64_t rotr64(uint64_t x, unsigned n) {
+   return (x >> n) | (x << ((64 - n) & 63));
+ }
+ 
+ /* Call f(std::integral_constant<std::size_t, I>) for I = 0 .. N-1, unrolled */
+ template <class F, std::size_t... I>
+ constexpr void static_for(F &&f, std::index_sequence<I...>) {
+   (f(std::integral_constant<std::size_t, I>{}), ...);
+ }
+ 
+ template <std::size_t N, class F>
+ constexpr void static_for(F &&f) {
+   static_for(std::forward<F>(f), std::make_index_sequence<N>{});
+ }
+ 
+ inline constexpr uint64_t keccak_rc[24] = {
+   0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+   0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+   0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+   0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+   0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+   0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+   0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+   0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+ };
+ inline constexpr uint8_t keccak_rho[24] = {1, 3, 6, 10, 15, 21, 28, 36,
+                                            45, 55, 2, 14, 27, 41, 56, 8,
+                                            25, 43, 62, 18, 39, 61, 20, 44};
+ inline constexpr uint8_t keccak_pi[24] = {1, 6, 9, 22, 14, 20, 2, 12,
+                                           13, 19, 23, 15, 4, 24, 21, 8,
+                                           16, 5, 3, 18, 17, 11, 7, 10};
+ 
+ /* Keccak-f[1600] as used by the library's shake128 (same rho/pi tables) */
+ constexpr void keccak_f1600(uint64_t st[25]) {
+   for (int round = 0; round < 24; round++) {
+     uint64_t bc[5] = {};
+     for (int i = 0; i < 5; i++) {
+       bc[i] = st[i] ^ st[i + 5] ^ st[i + 10] ^ st[i + 15] ^ st[i + 20];
+     }
+     for (int i = 0; i < 5; i++) {
+       uint64_t t = rotl64(bc[(i + 1) % 5], 1) ^ bc[(i + 4) % 5];
+       for (int j = 0; j < 25; j += 5) st[j + i] ^= t;
+     }
+ 
+     uint64_t t = st[1];
+     for (int i = 0; i < 24; i++) {
+       uint64_t temp = st[keccak_pi[i]];
+       st[keccak_pi[i]] = rotl64(t, keccak_rho[i]);
+       t = temp;
+     }
+ 
+     for (int j = 0; j < 25; j += 5) {
+       uint64_t a0 = st[j + 0], a1 = st[j + 1], a2 = st[j + 2], a3 = st[j + 3], a4 = st[j + 4];
+       st[j + 0] ^= ~a1 & a2;
+       st[j + 1] ^= ~a2 & a3;
+       st[j + 2] ^= ~a3 & a4;
+       st[j + 3] ^= ~a4 & a0;
+       st[j + 4] ^= ~a0 & a1;
+     }
+ 
+     st[0] ^= keccak_rc[round];
+   }
+ }
+ 
+ /* One-shot SHAKE-128 over the permutation above */
+ inline void shake128(const uint8_t *in, std::size_t inlen, uint8_t *out, std::size_t outlen) {
+   constexpr std::size_t rate = 168;
+   uint64_t st[25] = {};
+   uint8_t *bytes = reinterpret_cast<uint8_t *>(st);
+ 
+   for (; inlen >= rate; in += rate, inlen -= rate) {
+     for (std::size_t i = 0; i < rate; i++) bytes[i] ^= in[i];
+     keccak_f1600(st);
+   }
+   for (std::size_t i = 0; i < inlen; i++) bytes[i] ^= in[i];
+   bytes[inlen] ^= 0x1F;
+   bytes[rate - 1] ^= 0x80;
+   keccak_f1600(st);
+ 
+   for (;;) {
+     std::size_t n = outlen < rate ? outlen : rate;
+     std::memcpy(out, bytes, n);
+     out += n;
+     outlen -= n;
+     if (outlen == 0) break;
+     keccak_f1600(st);
+   }
+ }
+ 
+ /*
+  * The unkeyed S-box, shake128 of 32 bytes of 0xCC, evaluated by the
+  * compiler: the padded seed is written straight into the lanes, and bytes
+  * 168..255 come from a second permutation.
+  */
+ constexpr std::array<uint8_t, 256> derive_default_sbox() {
+   uint64_t st[25] = {};
+   for (int i = 0; i < 4; i++) st[i] = 0xCCCCCCCCCCCCCCCCULL;
+   st[4] ^= 0x1F;
+   st[20] ^= 0x80ULL << 56;
+   keccak_f1600(st);
+ 
+   std::array<uint8_t, 256> sbox{};
+   for (std::size_t i = 0; i < sbox.size(); i++) {
+     if (i == 168) keccak_f1600(st);
+     std::size_t j = i % 168;
+     sbox[i] = static_cast<uint8_t>(st[j / 8] >> (8 * (j % 8)));
+   }
+   return sbox;
+ }
+ 
+ inline constexpr std::array<uint8_t, 256> default_sbox = derive_default_sbox();
+ 
+ /* Pinned to QL_DEFAULT_TEMPLATE in qvortex_lib.c */
+ static_assert(default_sbox[0] == 0xc3 && default_sbox[1] == 0x48 && default_sbox[255] == 0x22,
+               "constexpr Keccak disagrees with the library's default S-box");
+ 
+ inline void mix(uint64_t s[state_words], std::size_t a, std::size_t b, std::size_t c, std::size_t d) {
+   s[a] = s[a] + s[b];
+   s[d] = rotr64(s[d] ^ s[a], 32);
+   s[c] = s[c] + s[d];
+   s[b] = rotr64(s[b] ^ s[c], 24);
+   s[a] = s[a] + s[b];
+   s[d] = rotr64(s[d] ^ s[a], 16);
+   s[c] = s[c] + s[d];
+   s[b] = rotr64(s[b] ^ s[c], 63);
+ }
+ 
+ /*
+  * One compression. Each round of the C library ends by rotating the state
+  * two words left; here round r instead addresses word i as (i + 2r) % 8,
+  * which the unrolled loop turns into plain register renaming.
+  */
+ template <int Rounds>
+ inline void compress_block(uint64_t state[state_words], const uint8_t sbox[256],
+                            const uint8_t block[block_bytes]) {
+   /* S-box into little-endian words, as the library's kernels load them */
+   uint64_t m[state_words];
+   static_for<state_words>([&](auto w) {
+     uint64_t x = 0;
+     static_for<8>([&](auto b) { x |= static_cast<uint64_t>(sbox[block[8 * w + b]]) << (8 * b); });
+     m[w] = x;
+   });
+ 
+   uint64_t s[state_words];
+   static_for<state_words>([&](auto i) {
+     s[i] = state[i] ^ rotl64(m[i], static_cast<unsigned>(m[i] >> 56) & 63);
+   });
+ 
+   static_for<Rounds>([&](auto r) {
+     constexpr std::size_t o = 2 * r;
+     mix(s, o % 8, (o + 2) % 8, (o + 4) % 8, (o + 6) % 8);
+     mix(s, (o + 1) % 8, (o + 3) % 8, (o + 5) % 8, (o + 7) % 8);
+   });
+ 
+   static_for<state_words>([&](auto i) {
+     state[i] ^= s[(i + 2 * Rounds) % 8];
+   });
+ }
+ 
+ } // namespace detail
+ 
+ namespace backend {
+ 
+ /* Self-contained C++ compression; any round count */
+ struct portable {
+   template <int Rounds>
+   static void compress(uint64_t state[state_words], const uint8_t sbox[256],
+                        const uint8_t *blocks, std::size_t nblocks) {
+     for (; nblocks > 0; nblocks--, blocks += block_bytes) {
+       detail::compress_block<Rounds>(state, sbox, blocks);
+     }
+   }
+ };
+ 
+ /* The library's runtime-dispatched NEON/AVX2/AVX-512 kernels */
+ struct dispatch {
+   template <int Rounds>
+   static void compress(uint64_t state[state_words], const uint8_t sbox[256],
+                        const uint8_t *blocks, std::size_t nblocks) {
+     static_assert(Rounds == default_rounds, "the library kernels run the default round count");
+     qvortex_compress(state, sbox, blocks, nblocks);
+   }
+ };
+ 
+ } // namespace backend
+ 
+ /* The IV and keyed S-box for one key, derived once and shared by hashers */
+ struct key_schedule {
+   std::array<uint64_t, state_words> state;
+   std::array<uint8_t, 256> sbox;
+ 
+   key_schedule() : key_schedule(nullptr, 0) {}
+ 
+   key_schedule(const void *key, std::size_t key_len) {
+     state = {0x6A09E667F3BCC908ULL, 0xBB67AE8584CAA73BULL, 0x3C6EF372FE94F82BULL,
+              0xA54FF53A5F1D36F1ULL, 0x510E527FADE682D1ULL, 0x9B05688C2B3E6C1FULL,
+              0x1F83D9ABFB41BD6BULL, 0x5BE0CD19137E2179ULL};
+     if (!key || key_len == 0) {
+       sbox = detail::default_sbox;
+       return;
+     }
+     uint8_t seed[32];
+     detail::shake128(static_cast<const uint8_t *>(key), key_len, seed, sizeof(seed));
+     detail::shake128(seed, sizeof(seed), sbox.data(), sbox.size());
+   }
+ 
+   /* The unkeyed schedule (its S-box is the compile-time default_sbox) */
+   static const key_schedule &unkeyed() {
+     static const key_schedule ks;
+     return ks;
+   }
+ };
+ 
+ template <class Backend = backend::portable, int Rounds = default_rounds,
+           std::size_t DigestBytes = max_digest_bytes>
+ class hasher {
+   static_assert(Rounds >= 1, "at least one round");
+   static_assert(DigestBytes >= 1 && DigestBytes <= max_digest_bytes, "digest is 1..64 bytes");
+ 
+ public:
+   static constexpr std::size_t digest_size = DigestBytes;
+   static constexpr std::size_t block_size = block_bytes;
+   using digest_type = std::array<uint8_t, DigestBytes>;
+ 
+   hasher() : hasher(key_schedule::unkeyed()) {}
+   hasher(const void *key, std::size_t key_len) : hasher(key_schedule(key, key_len)) {}
+   explicit hasher(const key_schedule &ks) : ks_(ks) { reset(); }
+ 
+   /* Start over with the same key */
+   void reset() {
+     state_ = ks_.state;
+     buffer_len_ = 0;
+     total_len_ = 0;
+   }
+ 
+   hasher &update(const void *data, std::size_t len) {
+     const uint8_t *p = static_cast<const uint8_t *>(data);
+     total_len_ += len;
+ 
+     if (buffer_len_ > 0) {
+       std::size_t n = block_bytes - buffer_len_;
+       if (n > len) n = len;
+       std::memcpy(buffer_ + buffer_len_, p, n);
+       buffer_len_ += n;
+       p += n;
+       len -= n;
+       if (buffer_len_ < block_bytes) return *this;
+       compress(buffer_, 1);
+       buffer_len_ = 0;
+     }
+ 
+     if (len >= block_bytes) {
+       std::size_t nblocks = len / block_bytes;
+       compress(p, nblocks);
+       p += nblocks * block_bytes;
+       len -= nblocks * block_bytes;
+     }
+ 
+     std::memcpy(buffer_, p, len);
+     buffer_len_ = len;
+     return *this;
+   }
+ 
+ #if defined(__cpp_lib_span)
+   template <class T, std::size_t Extent>
+   hasher &update(std::span<T, Extent> data) {
+     return update(data.data(), data.size_bytes());
+   }
+ #endif
+ 
+   /* Write the digest; the hasher must be reset() before reuse */
+   void final(uint8_t out[DigestBytes]) {
+     uint8_t block[2 * block_bytes] = {};
+     std::memcpy(block, buffer_, buffer_len_);
+     block[buffer_len_] = 0x80;
+     std::size_t nblocks = buffer_len_ <= short_max ? 1 : 2;
+     uint64_t bits = total_len_ * 8;
+     std::memcpy(block + nblocks * block_bytes - 8, &bits, 8);
+     compress(block, nblocks);
+     std::memcpy(out, state_.data(), DigestBytes);
+   }
+ 
+   digest_type final() {
+     digest_type out;
+     final(out.data());
+     return out;
+   }
+ 
+ private:
+   void compress(const uint8_t *blocks, std::size_t nblocks) {
+     Backend::template compress<Rounds>(state_.data(), ks_.sbox.data(), blocks, nblocks);
+   }
+ 
+   key_schedule ks_;
+   std::array<uint64_t, state_words> state_;
+   uint8_t buffer_[block_bytes];
+   std::size_t buffer_len_;
+   uint64_t total_len_;
+ };
+ 
+ /*
+  * Hash exactly N bytes at data. Block count and padding are compile-time
+  * constants, so for short N this inlines to one or two compressions.
+  */
+ template <std::size_t N, class Backend = backend::portable, int Rounds = default_rounds,
+           std::size_t DigestBytes = max_digest_bytes>
+ inline std::array<uint8_t, DigestBytes> hash(const key_schedule &ks, const void *data) {
+   constexpr std::size_t full = N / block_bytes;
+   constexpr std::size_t tail = N % block_bytes;
+   constexpr std::size_t final_blocks = tail <= short_max ? 1 : 2;
+   const uint8_t *p = static_cast<const uint8_t *>(data);
+ 
+   uint64_t state[state_words];
+   std::memcpy(state, ks.state.data(), sizeof(state));
+   if constexpr (full > 0) {
+     Backend::template compress<Rounds>(state, ks.sbox.data(), p, full);
+   }
+ 
+   uint8_t block[final_blocks * block_bytes] = {};
+   if constexpr (tail > 0) std::memcpy(block, p + full * block_bytes, tail);
+   block[tail] = 0x80;
+   const uint64_t bits = static_cast<uint64_t>(N) * 8;
+   std::memcpy(block + sizeof(block) - 8, &bits, 8);
+   Backend::template compress<Rounds>(state, ks.sbox.data(), block, final_blocks);
+ 
+   std::array<uint8_t, DigestBytes> out;
+   std::memcpy(out.data(), state, DigestBytes);
+   return out;
+ }
+ 
+ template <std::size_t N, class Backend = backend::portable, int Rounds = default_rounds,
+           std::size_t DigestBytes = max_digest_bytes>
+ inline std::array<uint8_t, DigestBytes> hash(const void *data) {
+   return hash<N, Backend, Rounds, DigestBytes>(key_schedule::unkeyed(), data);
+ }
+ 
+ /* One-shot hash of a runtime-sized buffer */
+ template <class Backend = backend::portable, int Rounds = default_rounds,
+           std::size_t DigestBytes = max_digest_bytes>
+ inline std::array<uint8_t, DigestBytes> hash(const void *data, std::size_t len,
+                                              const key_schedule &ks = key_schedule::unkeyed()) {
+   return hasher<Backend, Rounds, DigestBytes>(ks).update(data, len).final();
+ }
+ 
+ /*
+  * 64-bit table hash, equal to qvortex_hash64: the XOR of the eight digest
+  * words, computed straight from the input with no hasher object.
+  */
+ template <class Backend = backend::portable>
+ inline uint64_t hash64(const void *data, std::size_t len, const key_schedule &ks) {
+   const uint8_t *p = static_cast<const uint8_t *>(data);
+   const std::size_t full = len / block_bytes, tail = len % block_bytes;
+   const std::size_t nblocks = tail <= short_max ? 1 : 2;
+ 
+   uint64_t state[state_words];
+   std::memcpy(state, ks.state.data(), sizeof(state));
+   if (full > 0) Backend::template compress<default_rounds>(state, ks.sbox.data(), p, full);
+ 
+   uint8_t block[2 * block_bytes] = {};
+   if (tail > 0) std::memcpy(block, p + full * block_bytes, tail);
+   block[tail] = 0x80;
+   const uint64_t bits = static_cast<uint64_t>(len) * 8;
+   std::memcpy(block + nblocks * block_bytes - 8, &bits, 8);
+   Backend::template compress<default_rounds>(state, ks.sbox.data(), block, nblocks);
+ 
+   return state[0] ^ state[1] ^ state[2] ^ state[3] ^ state[4] ^ state[5] ^ state[6] ^ state[7];
+ }
+ 
+ /* A key schedule from a random key, drawn once per process */
+ inline const key_schedule &process_key() {
+   static const key_schedule ks = [] {
+     std::random_device rd;
+     uint32_t key[8];
+     for (auto &w : key) w = rd();
+     return key_schedule(key, sizeof(key));
+   }();
+   return ks;
+ }
+ 
+ /*
+  * std::hash-style functor for hash tables, keyed with process_key() unless
+  * given a schedule, so bucket placement cannot be predicted from outside.
+  * It is transparent, so std::unordered_map (C++20) and absl::flat_hash_map
+  * keyed by std::string can be probed with a std::string_view or a literal:
+  *
+  *   absl::flat_hash_map<std::string, int, qvortex::table_hash, std::equal_to<>> m;
+  *
+  * Besides strings it hashes any type whose bytes are its value (integers,
+  * enums, pointers, padding-free structs).
+  */
+ template <class Backend = backend::portable>
+ class basic_table_hash {
+ public:
+   using is_transparent = void;
+ 
+   basic_table_hash() : ks_(&process_key()) {}
+   explicit basic_table_hash(const key_schedule &ks) : ks_(&ks) {}
+ 
+   std::size_t operator()(std::string_view s) const {
+     return static_cast<std::size_t>(hash64<Backend>(s.data(), s.size(), *ks_));
+   }
+ 
+   template <class T, class = std::enable_if_t<std::has_unique_object_representations_v<T> &&
+                                               !std::is_convertible_v<const T &, std::string_view>>>
+   std::size_t operator()(const T &value) const {
+     return static_cast<std::size_t>(hash64<Backend>(&value, sizeof(value), *ks_));
+   }
+ 
+ private:
+   const key_schedule *ks_;
+ };
+ 
+ using table_hash = basic_table_hash<>;
+ 
+ } // namespace qvortex
+ 
+ #endif /* QVORTEX_HPP */
@@ -25,27 +25,104 @@ class QvortexError(Exception):
     """Exception raised for Qvortex hash errors"""
     pass
 
-class QvortexContext:
-    """
-    Wrapper for the Qvortex context structure
-    
-    This class should match the C structure layout:
-    typedef struct {
-      uint64_t state[8];
-      uint8_t sbox[256];
-      uint8_t buffer[64];
-      size_t buffer_len;
-      uint64_t total_len;
-    } qvortex_lite_ctx;
-    """
+class _PyBuffer(ctypes.Structure):
+    """ctypes mirror of CPython's Py_buffer"""
+    _fields_ = [
+        ("buf", ctypes.c_void_p),
+        ("obj", ctypes.c_void_p),
+        ("len", ctypes.c_ssize_t),
+        ("itemsize", ctypes.c_ssize_t),
+        ("readonly", c_int),
+        ("ndim", c_int),
+        ("format", ctypes.c_char_p),
+        ("shape", ctypes.c_void_p),
+        ("strides", ctypes.c_void_p),
+        ("suboffsets", ctypes.c_void_p),
+        ("internal", ctypes.c_void_p)
+    ]
+
+_PyObject_GetBuffer = ctypes.pythonapi.PyObject_GetBuffer
+_PyObject_GetBuffer.argtypes = [ctypes.py_object, POINTER(_PyBuffer), c_int]
+_PyObject_GetBuffer.restype = c_int
+
+_PyBuffer_Release = ctypes.pythonapi.PyBuffer_Release
+_PyBuffer_Release.argtypes = [POINTER(_PyBuffer)]
+_PyBuffer_Release.restype = None
+
+_PyBUF_SIMPLE = 0
+
+class _Chunk(ctypes.Structure):
+    """ctypes mirror of qvortex_chunk"""
+    _fields_ = [
+        ("offset", ctypes.c_uint64),
+        ("length", ctypes.c_uint64),
+        ("digest", c_uint8 * 64)
+    ]
+
+class _Range(ctypes.Structure):
+    """ctypes mirror of qvortex_range"""
+    _fields_ = [
+        ("offset", ctypes.c_uint64),
+        ("length", ctypes.c_uint64)
+    ]
+
+class _Stats(ctypes.Structure):
+    """ctypes mirror of qvortex_stats"""
+    _fields_ = [
+        ("bytes", ctypes.c_uint64),
+        ("blocks", ctypes.c_uint64),
+        ("shake128_calls", ctypes.c_uint64),
+        ("tail_copies", ctypes.c_uint64),
+        ("backend", ctypes.c_char_p)
+    ]
+
+class _IoVec(ctypes.Structure):
+    """ctypes mirror of struct iovec"""
     _fields_ = [
-        ("state", c_uint8 * 64),         # 8 uint64_t values = 64 bytes
-        ("sbox", c_uint8 * 256),         # 256 bytes for S-box
-        ("buffer", c_uint8 * 64),        # 64 bytes for block buffer
-        ("buffer_len", c_size_t),        # size_t for buffer length
-        ("total_len", c_uint8 * 8)       # uint64_t for total length
+        ("iov_base", ctypes.c_void_p),
+        ("iov_len", c_size_t)
     ]
 
+class _InputBuffer:
+    """
+    Borrow the memory of a bytes-like object without copying it
+    
+    Accepts anything that supports the buffer protocol (bytes, bytearray,
+    memoryview, mmap, numpy arrays, ...) plus str, which is UTF-8 encoded.
+    The memory stays pinned until release(), so pass ptr/len straight to
+    the C library. Library calls go through ctypes.CDLL, which releases
+    the GIL for their duration, so other Python threads keep running while
+    large buffers are hashed.
+    """
+    
+    def __init__(self, data):
+        if isinstance(data, str):
+            data = data.encode('utf-8')
+        self._view = _PyBuffer()
+        try:
+            _PyObject_GetBuffer(data, ctypes.byref(self._view), _PyBUF_SIMPLE)
+        except BufferError:
+            # Only non-contiguous buffers (e.g. strided views) are copied
+            data = memoryview(data).tobytes()
+            _PyObject_GetBuffer(data, ctypes.byref(self._view), _PyBUF_SIMPLE)
+        self.ptr = self._view.buf
+        self.len = self._view.len
+    
+    def release(self):
+        if self._view is not None:
+            _PyBuffer_Release(ctypes.byref(self._view))
+            self._view = None
+    
+    def __enter__(self):
+        return self
+    
+    def __exit__(self, *exc):
+        self.release()
+        return False
+    
+    def __del__(self):
+        self.release()
+
 class QvortexHash:
     """
     Python wrapper for the Qvortex hash algorithm
@@ -69,7 +146,7 @@ class QvortexHash:
         if library_path is None:
             # Look in current directory first
             if os.path.exists(DEFAULT_LIB_NAME):
-                library_path = DEFAULT_LIB_NAME
+                library_path = os.path.abspath(DEFAULT_LIB_NAME)
             else:
                 # Try to find in the same directory as this script
                 script_dir = os.path.dirname(os.path.abspath(__file__))
@@ -80,7 +157,7 @@ class QvortexHash:
                     library_path = DEFAULT_LIB_NAME
         
         try:
-            self.lib = ctypes.CDLL(library_path)
+            self.lib = ctypes.CDLL(library_path, use_errno=True)
         except OSError as e:
             raise QvortexError(f"Failed to load Qvortex library: {e}")
         
@@ -94,12 +171,22 @@ class QvortexHash:
                 self.key = key.encode('utf-8')
             else:
                 self.key = bytes(key)
+        
+        # Derive the shared key once; hash() and new() reuse its template
+        self._key = self._new_key(self.key)
+        self._template = self.lib.qvortex_key_template(self._key)
+    
+    def __del__(self):
+        key = getattr(self, '_key', None)
+        if key:
+            self.lib.qvortex_key_release(key)
+            self._key = None
 
     def _define_functions(self):
         """Define the C function prototypes"""
         # One-shot hash function
         self.lib.qvortex_hash.argtypes = [
-            POINTER(c_uint8),  # data
+            ctypes.c_void_p,   # data
             c_size_t,          # len
             c_int,             # blocks_per_sbox
             c_int,             # use_precomputed
@@ -122,7 +209,7 @@ class QvortexHash:
         
         self.lib.qvortex_update.argtypes = [
             ctypes.c_void_p,   # ctx
-            POINTER(c_uint8),  # data
+            ctypes.c_void_p,   # data
             c_size_t           # len
         ]
         self.lib.qvortex_update.restype = c_int
@@ -133,17 +220,293 @@ class QvortexHash:
         ]
         self.lib.qvortex_final.restype = c_int
         
+        # Keyed template API
+        self.lib.qvortex_template_size.argtypes = []
+        self.lib.qvortex_template_size.restype = c_size_t
+        
+        self.lib.qvortex_template_init.argtypes = [
+            ctypes.c_void_p,   # tpl
+            POINTER(c_uint8),  # key
+            c_size_t           # key_len
+        ]
+        self.lib.qvortex_template_init.restype = c_int
+        
+        self.lib.qvortex_init_from_template.argtypes = [
+            ctypes.c_void_p,   # ctx
+            ctypes.c_void_p    # tpl
+        ]
+        self.lib.qvortex_init_from_template.restype = c_int
+        
+        self.lib.qvortex_hash_with_template.argtypes = [
+            ctypes.c_void_p,   # tpl
+            ctypes.c_void_p,   # data
+            c_size_t,          # len
+            POINTER(c_uint8)   # out
+        ]
+        self.lib.qvortex_hash_with_template.restype = c_int
+        
+        # Scatter-gather (fragments are hashed in place, as if concatenated)
+        self.lib.qvortex_hashv_with_template.argtypes = [
+            ctypes.c_void_p,   # tpl
+            POINTER(_IoVec),   # iov
+            c_int,             # iovcnt
+            POINTER(c_uint8)   # out
+        ]
+        self.lib.qvortex_hashv_with_template.restype = c_int
+        
+        # Shared keys and compact contexts (the context memory is sized
+        # and aligned by the library, then the context references the key)
+        self.lib.qvortex_key_new.argtypes = [POINTER(c_uint8), c_size_t]
+        self.lib.qvortex_key_new.restype = ctypes.c_void_p
+        self.lib.qvortex_key_release.argtypes = [ctypes.c_void_p]
+        self.lib.qvortex_key_release.restype = None
+        self.lib.qvortex_key_template.argtypes = [ctypes.c_void_p]
+        self.lib.qvortex_key_template.restype = ctypes.c_void_p
+        
+        self.lib.qvortex_ctx_size.argtypes = []
+        self.lib.qvortex_ctx_size.restype = c_size_t
+        self.lib.qvortex_ctx_align.argtypes = []
+        self.lib.qvortex_ctx_align.restype = c_size_t
+        self.ctx_size = self.lib.qvortex_ctx_size()
+        self.ctx_align = self.lib.qvortex_ctx_align()
+        
+        self.lib.qvortex_ctx_init.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+        self.lib.qvortex_ctx_init.restype = c_int
+        self.lib.qvortex_ctx_update.argtypes = [ctypes.c_void_p, ctypes.c_void_p, c_size_t]
+        self.lib.qvortex_ctx_update.restype = c_int
+        self.lib.qvortex_ctx_updatev.argtypes = [ctypes.c_void_p, POINTER(_IoVec), c_int]
+        self.lib.qvortex_ctx_updatev.restype = c_int
+        self.lib.qvortex_ctx_final.argtypes = [ctypes.c_void_p, POINTER(c_uint8)]
+        self.lib.qvortex_ctx_final.restype = c_int
+        self.lib.qvortex_ctx_discard.argtypes = [ctypes.c_void_p]
+        self.lib.qvortex_ctx_discard.restype = None
+        
+        self.lib.qvortex_ctx_clone.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+        self.lib.qvortex_ctx_clone.restype = c_int
+        
+        # Checkpoints: at most 147 bytes, naming the key by id only
+        self.lib.qvortex_ctx_export.argtypes = [
+            ctypes.c_void_p, POINTER(c_uint8), c_size_t, POINTER(c_size_t)
+        ]
+        self.lib.qvortex_ctx_export.restype = c_int
+        self.lib.qvortex_ctx_import.argtypes = [
+            ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p, c_size_t
+        ]
+        self.lib.qvortex_ctx_import.restype = c_int
+        
+        # 64-bit table hash (returns the hash, not a status code)
+        self.lib.qvortex_hash64.argtypes = [
+            ctypes.c_void_p,   # data
+            c_size_t,          # len
+            ctypes.c_void_p    # tpl
+        ]
+        self.lib.qvortex_hash64.restype = ctypes.c_uint64
+        
+        # Multi-buffer batch API
+        self.lib.qvortex_hash_many.argtypes = [
+            POINTER(ctypes.c_void_p),  # msgs
+            POINTER(c_size_t),         # lens
+            c_size_t,                  # n
+            POINTER(c_uint8),          # key
+            c_size_t,                  # key_len
+            POINTER(c_uint8)           # out
+        ]
+        self.lib.qvortex_hash_many.restype = c_int
+        
+        self.lib.qvortex_hash_many_with_template.argtypes = [
+            ctypes.c_void_p,           # tpl
+            POINTER(ctypes.c_void_p),  # msgs
+            POINTER(c_size_t),         # lens
+            c_size_t,                  # n
+            POINTER(c_uint8)           # out
+        ]
+        self.lib.qvortex_hash_many_with_template.restype = c_int
+        
+        # Constant-time MAC verification
+        self.lib.qvortex_verify.argtypes = [
+            ctypes.c_void_p,   # tpl
+            ctypes.c_void_p,   # msg
+            c_size_t,          # len
+            ctypes.c_char_p,   # tag
+            c_size_t           # tag_len
+        ]
+        self.lib.qvortex_verify.restype = c_int
+        
+        self.lib.qvortex_verify_many.argtypes = [
+            ctypes.c_void_p,           # tpl
+            POINTER(ctypes.c_void_p),  # msgs
+            POINTER(c_size_t),         # lens
+            POINTER(ctypes.c_char_p),  # tags
+            c_size_t,                  # tag_len
+            c_size_t,                  # n
+            POINTER(c_uint8)           # bitmap
+        ]
+        self.lib.qvortex_verify_many.restype = c_int
+        
+        # Parallel tree mode
+        self.lib.qvortex_tree_hash.argtypes = [
+            ctypes.c_void_p,   # data
+            c_size_t,          # len
+            POINTER(c_uint8),  # key
+            c_size_t,          # key_len
+            c_int,             # nthreads
+            POINTER(c_uint8)   # out
+        ]
+        self.lib.qvortex_tree_hash.restype = c_int
+        
+        # Incremental tree mode
+        self.lib.qvortex_merkle_new.argtypes = [POINTER(c_uint8), c_size_t]
+        self.lib.qvortex_merkle_new.restype = ctypes.c_void_p
+        self.lib.qvortex_merkle_update.argtypes = [
+            ctypes.c_void_p, ctypes.c_void_p, c_size_t, POINTER(_Range), c_size_t
+        ]
+        self.lib.qvortex_merkle_update.restype = c_int
+        self.lib.qvortex_merkle_update_fd.argtypes = [ctypes.c_void_p, c_int, POINTER(_Range), c_size_t]
+        self.lib.qvortex_merkle_update_fd.restype = c_int
+        self.lib.qvortex_merkle_reset.argtypes = [ctypes.c_void_p]
+        self.lib.qvortex_merkle_reset.restype = c_int
+        self.lib.qvortex_merkle_root.argtypes = [ctypes.c_void_p, POINTER(c_uint8)]
+        self.lib.qvortex_merkle_root.restype = c_int
+        self.lib.qvortex_merkle_export_size.argtypes = [ctypes.c_void_p]
+        self.lib.qvortex_merkle_export_size.restype = c_size_t
+        self.lib.qvortex_merkle_export.argtypes = [
+            ctypes.c_void_p, POINTER(c_uint8), c_size_t, POINTER(c_size_t)
+        ]
+        self.lib.qvortex_merkle_export.restype = c_int
+        self.lib.qvortex_merkle_import.argtypes = [ctypes.c_void_p, ctypes.c_char_p, c_size_t]
+        self.lib.qvortex_merkle_import.restype = c_int
+        self.lib.qvortex_merkle_free.argtypes = [ctypes.c_void_p]
+        self.lib.qvortex_merkle_free.restype = None
+        
+        # Memory-mapped digest index
+        self.lib.qvortex_index_create.argtypes = [ctypes.c_char_p, ctypes.c_uint64, POINTER(ctypes.c_void_p)]
+        self.lib.qvortex_index_create.restype = c_int
+        self.lib.qvortex_index_open.argtypes = [ctypes.c_char_p, c_int, POINTER(ctypes.c_void_p)]
+        self.lib.qvortex_index_open.restype = c_int
+        self.lib.qvortex_index_lookup_many.argtypes = [
+            ctypes.c_void_p, ctypes.c_char_p, POINTER(ctypes.c_uint64), c_size_t, POINTER(c_uint8)
+        ]
+        self.lib.qvortex_index_lookup_many.restype = c_int
+        self.lib.qvortex_index_insert_many.argtypes = [
+            ctypes.c_void_p, ctypes.c_char_p, POINTER(ctypes.c_uint64), c_size_t, POINTER(c_uint8)
+        ]
+        self.lib.qvortex_index_insert_many.restype = c_int
+        self.lib.qvortex_index_count.argtypes = [ctypes.c_void_p]
+        self.lib.qvortex_index_count.restype = ctypes.c_uint64
+        self.lib.qvortex_index_sync.argtypes = [ctypes.c_void_p]
+        self.lib.qvortex_index_sync.restype = c_int
+        self.lib.qvortex_index_close.argtypes = [ctypes.c_void_p]
+        self.lib.qvortex_index_close.restype = None
+        
+        # Optional GPU batch backend (QVORTEX_GPU=1 builds)
+        self.lib.qvortex_gpu_new.argtypes = [POINTER(c_uint8), c_size_t, POINTER(ctypes.c_void_p)]
+        self.lib.qvortex_gpu_new.restype = c_int
+        self.lib.qvortex_gpu_hash_records.argtypes = [
+            ctypes.c_void_p, ctypes.c_void_p, c_size_t, POINTER(_Range), c_size_t, POINTER(c_uint8)
+        ]
+        self.lib.qvortex_gpu_hash_records.restype = c_int
+        self.lib.qvortex_gpu_api.argtypes = []
+        self.lib.qvortex_gpu_api.restype = ctypes.c_char_p
+        self.lib.qvortex_gpu_free.argtypes = [ctypes.c_void_p]
+        self.lib.qvortex_gpu_free.restype = None
+        
+        # File hashing (mmap for large regular files)
+        self.lib.qvortex_hash_file.argtypes = [
+            ctypes.c_char_p,   # path
+            POINTER(c_uint8),  # key
+            c_size_t,          # key_len
+            POINTER(c_uint8)   # out
+        ]
+        self.lib.qvortex_hash_file.restype = c_int
+        
+        # Content-defined chunking; results are freed with qvortex_chunks_free
+        self.lib.qvortex_chunk_buffer.argtypes = [
+            ctypes.c_void_p,                  # data
+            c_size_t,                         # len
+            c_size_t, c_size_t, c_size_t,     # min, avg, max
+            POINTER(c_uint8),                 # key
+            c_size_t,                         # key_len
+            POINTER(POINTER(_Chunk)),         # chunks
+            POINTER(c_size_t)                 # count
+        ]
+        self.lib.qvortex_chunk_buffer.restype = c_int
+        self.lib.qvortex_chunk_file.argtypes = [
+            ctypes.c_char_p,                  # path
+            c_size_t, c_size_t, c_size_t,     # min, avg, max
+            POINTER(c_uint8),                 # key
+            c_size_t,                         # key_len
+            POINTER(POINTER(_Chunk)),         # chunks
+            POINTER(c_size_t)                 # count
+        ]
+        self.lib.qvortex_chunk_file.restype = c_int
+        self.lib.qvortex_chunks_free.argtypes = [POINTER(_Chunk)]
+        self.lib.qvortex_chunks_free.restype = None
+        
         # Version info
         self.lib.qvortex_version.argtypes = []
         self.lib.qvortex_version.restype = ctypes.c_char_p
+        
+        # Selected SIMD backend
+        self.lib.qvortex_backend_name.argtypes = []
+        self.lib.qvortex_backend_name.restype = ctypes.c_char_p
+        
+        # Qvortex's SHAKE-128 variant (not FIPS 202 compatible)
+        self.lib.qvortex_shake128.argtypes = [ctypes.c_void_p, c_size_t, POINTER(c_uint8), c_size_t]
+        self.lib.qvortex_shake128.restype = c_int
+        
+        # Wide variant (Qvortex-1024)
+        self.lib.qvortex_wide_hash_with_template.argtypes = [
+            ctypes.c_void_p, ctypes.c_void_p, c_size_t, POINTER(c_uint8)
+        ]
+        self.lib.qvortex_wide_hash_with_template.restype = c_int
+        
+        # Performance counters (built in with QVORTEX_STATS=1)
+        self.lib.qvortex_stats_snapshot.argtypes = [POINTER(_Stats)]
+        self.lib.qvortex_stats_snapshot.restype = c_int
+    
+    def _new_key(self, key):
+        """Run the key schedule once and return a shared key (one reference)"""
+        key_ptr = None
+        key_len = 0
+        
+        if key:
+            if isinstance(key, str):
+                key = key.encode('utf-8')
+            key_len = len(key)
+            key_ptr = (c_uint8 * key_len)(*key)
+        
+        handle = self.lib.qvortex_key_new(key_ptr, key_len)
+        if not handle:
+            raise QvortexError("Failed to allocate Qvortex key")
+        return handle
+    
+    def _make_template(self, key):
+        """Run the key schedule once and return the template buffer"""
+        template = ctypes.create_string_buffer(self.lib.qvortex_template_size())
+        
+        key_ptr = None
+        key_len = 0
+        
+        if key:
+            key_len = len(key)
+            key_ptr = (c_uint8 * key_len)(*key)
+        
+        result = self.lib.qvortex_template_init(template, key_ptr, key_len)
+        if result != 0:
+            raise QvortexError(f"Failed to derive Qvortex key template: {result}")
+        
+        return template
     
-    def hash(self, data: Union[bytes, bytearray, str], 
+    def hash(self, data: Union[ByteString, memoryview, str], 
              key: Optional[bytes] = None) -> bytes:
         """
         Compute the Qvortex hash of the input data
         
+        The data is hashed in place (no copy) and the GIL is released while
+        the C library runs.
+        
         Args:
-            data: Input data to hash
+            data: Input data to hash (any bytes-like object or str)
             key: Optional key for keyed hashing (overrides the one set in constructor)
         
         Returns:
@@ -152,20 +515,24 @@ class QvortexHash:
         Raises:
             QvortexError: If hashing fails
         """
-        # Convert string to bytes if needed
-        if isinstance(data, str):
-            data = data.encode('utf-8')
-        
-        # Use the provided key or the default one
-        use_key = key if key is not None else self.key
-        
-        # Prepare data buffer
-        data_len = len(data)
-        data_buf = (c_uint8 * data_len)(*data)
-        
         # Prepare output buffer (64 bytes)
         out_buf = (c_uint8 * 64)()
         
+        # Without an override, reuse the template derived in the constructor
+        if key is None:
+            with _InputBuffer(data) as buf:
+                result = self.lib.qvortex_hash_with_template(
+                    self._template,
+                    buf.ptr,
+                    buf.len,
+                    out_buf
+                )
+            if result != 0:
+                raise QvortexError(f"Qvortex hash function failed with error code {result}")
+            return bytes(out_buf)
+        
+        use_key = key
+        
         # Prepare key buffer if needed
         key_ptr = None
         key_len = 0
@@ -178,15 +545,16 @@ class QvortexHash:
             key_ptr = key_buf
         
         # Call the hash function
-        result = self.lib.qvortex_hash(
-            data_buf if data_len > 0 else None,
-            data_len,
-            1,                 # blocks_per_sbox (not used)
-            0,                 # use_precomputed (not used)
-            key_ptr,
-            key_len,
-            out_buf
-        )
+        with _InputBuffer(data) as buf:
+            result = self.lib.qvortex_hash(
+                buf.ptr,
+                buf.len,
+                1,                 # blocks_per_sbox (not used)
+                0,                 # use_precomputed (not used)
+                key_ptr,
+                key_len,
+                out_buf
+            )
         
         # Check for errors
         if result != 0:
@@ -195,62 +563,670 @@ class QvortexHash:
         # Convert output buffer to bytes
         return bytes(out_buf)
     
-    class HashContext:
-        """Context manager for incremental hashing"""
+    def hash64(self, data, key: Optional[bytes] = None) -> int:
+        """
+        Compute the 64-bit Qvortex table hash of the input data
         
-        def __init__(self, qvortex_instance, key=None):
-            self.qvortex = qvortex_instance
-            self.key = key
-            
-            # Allocate memory for the context structure
-            # We're using raw memory allocation since ctypes doesn't handle complex structs well
-            self.ctx = ctypes.create_string_buffer(1024)  # More than enough space
-            
-            # Initialize the context
-            key_ptr = None
-            key_len = 0
+        This is the XOR of the eight 64-bit words of the full digest, made
+        for keying dicts and hash tables; construct QvortexHash with a
+        secret random key to resist hash flooding. The bound method can be
+        used directly as a key function, e.g. QvortexHash(key=k).hash64.
+        
+        Args:
+            data: Input data to hash (any bytes-like object or str)
+            key: Optional key (overrides the one set in constructor; slower,
+                 as the key schedule runs on every call)
+        
+        Returns:
+            int: Unsigned 64-bit hash
+        """
+        template = self._template if key is None else self._make_template(
+            key.encode('utf-8') if isinstance(key, str) else key)
+        
+        # bytes can be passed to the C library as-is
+        if type(data) is bytes:
+            return self.lib.qvortex_hash64(data, len(data), template)
+        with _InputBuffer(data) as buf:
+            return self.lib.qvortex_hash64(buf.ptr, buf.len, template)
+    
+    def hash_many(self, messages, key: Optional[bytes] = None) -> list:
+        """
+        Compute the Qvortex hash of many independent messages in one call
+        
+        The messages are interleaved across SIMD lanes in the C library,
+        which is much faster than calling hash() once per small message.
+        
+        Args:
+            messages: Sequence of bytes-like objects or strings (not copied)
+            key: Optional key for keyed hashing (overrides the one set in constructor)
+        
+        Returns:
+            list: 64-byte digests, in the same order as messages
+        
+        Raises:
+            QvortexError: If hashing fails
+        """
+        n = len(messages)
+        if n == 0:
+            return []
+        
+        out_buf = (c_uint8 * (64 * n))()
+        bufs = []
+        try:
+            bufs = [_InputBuffer(m) for m in messages]
+            msg_ptrs = (ctypes.c_void_p * n)(*[b.ptr for b in bufs])
+            msg_lens = (c_size_t * n)(*[b.len for b in bufs])
             
-            if key:
+            if key is None:
+                result = self.lib.qvortex_hash_many_with_template(
+                    self._template, msg_ptrs, msg_lens, n, out_buf)
+            else:
                 if isinstance(key, str):
                     key = key.encode('utf-8')
                 key_len = len(key)
-                key_buf = (c_uint8 * key_len)(*key)
-                key_ptr = key_buf
-            
-            result = self.qvortex.lib.qvortex_init(
-                self.ctx,
-                key_ptr,
-                key_len
+                key_ptr = (c_uint8 * key_len)(*key) if key_len > 0 else None
+                result = self.lib.qvortex_hash_many(
+                    msg_ptrs, msg_lens, n, key_ptr, key_len, out_buf)
+        finally:
+            for b in bufs:
+                b.release()
+        
+        if result != 0:
+            raise QvortexError(f"Qvortex batch hash failed with error code {result}")
+        
+        digests = bytes(out_buf)
+        return [digests[64 * i:64 * (i + 1)] for i in range(n)]
+    
+    def hashv(self, fragments, key: Optional[bytes] = None) -> bytes:
+        """
+        Hash a sequence of bytes-like fragments as if they were concatenated,
+        without joining them
+        
+        Args:
+            fragments: Sequence of bytes-like objects or strings (not copied)
+            key: Optional key (defaults to the one set in constructor)
+        
+        Returns:
+            bytes: 64-byte Qvortex hash digest
+        """
+        template = self._template if key is None else self._make_template(key)
+        out_buf = (c_uint8 * 64)()
+        bufs = []
+        try:
+            bufs = [_InputBuffer(f) for f in fragments]
+            iov = (_IoVec * max(len(bufs), 1))(*[(b.ptr, b.len) for b in bufs])
+            result = self.lib.qvortex_hashv_with_template(template, iov, len(bufs), out_buf)
+        finally:
+            for b in bufs:
+                b.release()
+        
+        if result != 0:
+            raise QvortexError(f"Qvortex hashv failed with error code {result}")
+        
+        return bytes(out_buf)
+    
+    def shake128(self, data, out_len: int) -> bytes:
+        """
+        Extendable output from the SHAKE-128 sponge of the Qvortex key schedule
+        
+        NOT FIPS 202 SHAKE128: Qvortex's Keccak permutation differs, so this
+        never matches hashlib.shake_128 (b"" gives 665d6a34..., not
+        7f9c2ba4...). Use it only for derivations that stay within Qvortex.
+        
+        Args:
+            data: Input (any bytes-like object or str, not copied)
+            out_len: Number of output bytes
+        
+        Returns:
+            bytes: out_len bytes of output
+        """
+        out_buf = (c_uint8 * out_len)()
+        with _InputBuffer(data) as buf:
+            result = self.lib.qvortex_shake128(buf.ptr, buf.len, out_buf, out_len)
+        
+        if result != 0:
+            raise QvortexError(f"Qvortex SHAKE-128 failed with error code {result}")
+        
+        return bytes(out_buf)
+    
+    def wide_hash(self, data, key: Optional[bytes] = None) -> bytes:
+        """
+        Compute the 128-byte digest of the wide variant, Qvortex-1024
+        
+        Args:
+            data: Input data to hash (any bytes-like object or str)
+            key: Optional key (overrides the one set in constructor)
+        
+        Returns:
+            bytes: 128-byte Qvortex-1024 digest (unrelated to hash())
+        """
+        if isinstance(key, str):
+            key = key.encode('utf-8')
+        template = self._template if key is None else self._make_template(key)
+        out_buf = (c_uint8 * 128)()
+        with _InputBuffer(data) as buf:
+            result = self.lib.qvortex_wide_hash_with_template(template, buf.ptr, buf.len, out_buf)
+        
+        if result != 0:
+            raise QvortexError(f"Qvortex-1024 hash failed with error code {result}")
+        
+        return bytes(out_buf)
+    
+    def verify(self, data, tag: bytes, key: Optional[bytes] = None) -> bool:
+        """
+        Check a MAC tag (the digest or a prefix of it) in constant time
+        
+        Args:
+            data: Message (any bytes-like object or str)
+            tag: Expected tag, 1 to 64 bytes
+            key: Optional key (defaults to the one set in constructor)
+        
+        Returns:
+            bool: True if the tag matches
+        
+        Raises:
+            QvortexError: If the tag length is invalid
+        """
+        template = self._template if key is None else self._make_template(key)
+        tag = bytes(tag)
+        with _InputBuffer(data) as buf:
+            result = self.lib.qvortex_verify(template, buf.ptr, buf.len, tag, len(tag))
+        
+        if result == -6:  # QVORTEX_ERROR_VERIFY
+            return False
+        if result != 0:
+            raise QvortexError(f"Qvortex verify failed with error code {result}")
+        return True
+    
+    def verify_many(self, messages, tags, key: Optional[bytes] = None) -> list:
+        """
+        Check many MAC tags of one length in a single batched call
+        
+        Args:
+            messages: Sequence of bytes-like objects or strings (not copied)
+            tags: Sequence of expected tags, all the same length (1 to 64 bytes)
+            key: Optional key (defaults to the one set in constructor)
+        
+        Returns:
+            list: One bool per message, True where the tag matches
+        """
+        n = len(messages)
+        if n != len(tags):
+            raise ValueError("messages and tags must have the same length")
+        if n == 0:
+            return []
+        tags = [bytes(t) for t in tags]
+        tag_len = len(tags[0])
+        if any(len(t) != tag_len for t in tags):
+            raise ValueError("all tags must have the same length")
+        
+        template = self._template if key is None else self._make_template(key)
+        bitmap = (c_uint8 * ((n + 7) // 8))()
+        bufs = []
+        try:
+            bufs = [_InputBuffer(m) for m in messages]
+            msg_ptrs = (ctypes.c_void_p * n)(*[b.ptr for b in bufs])
+            msg_lens = (c_size_t * n)(*[b.len for b in bufs])
+            tag_ptrs = (ctypes.c_char_p * n)(*tags)
+            result = self.lib.qvortex_verify_many(
+                template, msg_ptrs, msg_lens, tag_ptrs, tag_len, n, bitmap)
+        finally:
+            for b in bufs:
+                b.release()
+        
+        if result != 0:
+            raise QvortexError(f"Qvortex batch verify failed with error code {result}")
+        
+        return [bool(bitmap[i >> 3] >> (i & 7) & 1) for i in range(n)]
+    
+    def tree_hash(self, data, nthreads: int = 0, key: Optional[bytes] = None) -> bytes:
+        """
+        Compute the Qvortex tree-mode digest of the input data
+        
+        Tree mode splits the input into chunks that are hashed in parallel,
+        so its digests differ from hash() for the same input and key.
+        
+        Args:
+            data: Input data to hash (any bytes-like object or str, not copied)
+            nthreads: Worker threads to use (0 = one per CPU)
+            key: Optional key for keyed hashing (defaults to the one set in constructor)
+        
+        Returns:
+            bytes: 64-byte Qvortex tree digest
+        
+        Raises:
+            QvortexError: If hashing fails
+        """
+        use_key = self.key if key is None else key
+        if isinstance(use_key, str):
+            use_key = use_key.encode('utf-8')
+        key_len = len(use_key) if use_key else 0
+        key_ptr = (c_uint8 * key_len)(*use_key) if key_len > 0 else None
+        
+        out_buf = (c_uint8 * 64)()
+        with _InputBuffer(data) as buf:
+            result = self.lib.qvortex_tree_hash(buf.ptr, buf.len, key_ptr, key_len,
+                                                nthreads, out_buf)
+        if result != 0:
+            raise QvortexError(f"Qvortex tree hash failed with error code {result}")
+        
+        return bytes(out_buf)
+    
+    def hash_file(self, path, key: Optional[bytes] = None) -> bytes:
+        """
+        Compute the Qvortex hash of a file without reading it into Python
+        
+        Large files are memory-mapped by the C library and hashed in place,
+        with the GIL released.
+        
+        Args:
+            path: Path of the file to hash (str, bytes or os.PathLike)
+            key: Optional key for keyed hashing (defaults to the one set in constructor)
+        
+        Returns:
+            bytes: 64-byte Qvortex hash digest
+        
+        Raises:
+            OSError: If the file cannot be opened or read
+            QvortexError: If hashing fails
+        """
+        path = os.fsencode(path)
+        
+        use_key = self.key if key is None else key
+        if isinstance(use_key, str):
+            use_key = use_key.encode('utf-8')
+        key_len = len(use_key) if use_key else 0
+        key_ptr = (c_uint8 * key_len)(*use_key) if key_len > 0 else None
+        
+        out_buf = (c_uint8 * 64)()
+        result = self.lib.qvortex_hash_file(path, key_ptr, key_len, out_buf)
+        if result == -4:  # QVORTEX_ERROR_IO
+            err = ctypes.get_errno()
+            raise OSError(err, os.strerror(err) if err else "I/O error", os.fsdecode(path))
+        if result != 0:
+            raise QvortexError(f"Qvortex file hash failed with error code {result}")
+        
+        return bytes(out_buf)
+    
+    def _key_args(self, key):
+        use_key = self.key if key is None else key
+        if isinstance(use_key, str):
+            use_key = use_key.encode('utf-8')
+        key_len = len(use_key) if use_key else 0
+        key_ptr = (c_uint8 * key_len)(*use_key) if key_len > 0 else None
+        return key_ptr, key_len
+    
+    def _take_chunks(self, result, chunks, count, path=None):
+        if result == -4 and path is not None:  # QVORTEX_ERROR_IO
+            err = ctypes.get_errno()
+            raise OSError(err, os.strerror(err) if err else "I/O error", os.fsdecode(path))
+        if result == -3:  # QVORTEX_ERROR_UNSUPPORTED
+            raise ValueError("need 1 <= min_size <= avg_size <= max_size <= 1 GiB and avg_size >= 64")
+        if result != 0:
+            raise QvortexError(f"Qvortex chunking failed with error code {result}")
+        
+        try:
+            return [(c.offset, c.length, bytes(c.digest)) for c in chunks[:count.value]]
+        finally:
+            self.lib.qvortex_chunks_free(chunks)
+    
+    def chunk(self, data, min_size: int = 2048, avg_size: int = 8192,
+              max_size: int = 65536, key: Optional[bytes] = None) -> list:
+        """
+        Split data at content-defined boundaries and digest every chunk, in one pass
+        
+        Args:
+            data: Any bytes-like object (not copied)
+            min_size: Smallest chunk length
+            avg_size: Target chunk length (rounded down to a power of two)
+            max_size: Largest chunk length
+            key: Optional key for keyed chunk digests (defaults to the one set in constructor)
+        
+        Returns:
+            list: (offset, length, digest) tuples in stream order
+        """
+        key_ptr, key_len = self._key_args(key)
+        chunks = POINTER(_Chunk)()
+        count = c_size_t(0)
+        
+        with _InputBuffer(data) as buf:
+            result = self.lib.qvortex_chunk_buffer(
+                buf.ptr, buf.len, min_size, avg_size, max_size,
+                key_ptr, key_len, ctypes.byref(chunks), ctypes.byref(count)
             )
+        
+        return self._take_chunks(result, chunks, count)
+    
+    def chunk_file(self, path, min_size: int = 2048, avg_size: int = 8192,
+                   max_size: int = 65536, key: Optional[bytes] = None) -> list:
+        """
+        Chunk and digest a file through the mmap or read() path, like hash_file()
+        
+        Returns:
+            list: (offset, length, digest) tuples in stream order
+        
+        Raises:
+            OSError: If the file cannot be opened or read
+        """
+        path = os.fsencode(path)
+        key_ptr, key_len = self._key_args(key)
+        chunks = POINTER(_Chunk)()
+        count = c_size_t(0)
+        
+        result = self.lib.qvortex_chunk_file(
+            path, min_size, avg_size, max_size,
+            key_ptr, key_len, ctypes.byref(chunks), ctypes.byref(count)
+        )
+        
+        return self._take_chunks(result, chunks, count, path)
+    
+    class MerkleTree:
+        """Tree-mode digest that rehashes only the chunks touched by an edit"""
+        
+        def __init__(self, qvortex_instance, key=None):
+            self.qvortex = qvortex_instance
+            key_ptr, key_len = qvortex_instance._key_args(key)
+            self.tree = qvortex_instance.lib.qvortex_merkle_new(key_ptr, key_len)
+            if not self.tree:
+                raise QvortexError("Failed to allocate Qvortex Merkle tree")
+        
+        def __del__(self):
+            tree = getattr(self, 'tree', None)
+            if tree:
+                self.qvortex.lib.qvortex_merkle_free(tree)
+                self.tree = None
+        
+        @staticmethod
+        def _ranges(ranges):
+            ranges = list(ranges)
+            return (_Range * len(ranges))(*ranges) if ranges else None, len(ranges)
+        
+        def update(self, data, ranges=()):
+            """
+            Bring the tree up to date with data, of which only the (offset, length)
+            ranges changed; the first call (or one after reset()) hashes everything
+            """
+            arr, n = self._ranges(ranges)
+            with _InputBuffer(data) as buf:
+                result = self.qvortex.lib.qvortex_merkle_update(self.tree, buf.ptr, buf.len, arr, n)
+            if result != 0:
+                raise QvortexError(f"Failed to update Qvortex Merkle tree: {result}")
+        
+        def update_file(self, path, ranges=()):
+            """As update(), reading only the dirty chunks of the file at path"""
+            arr, n = self._ranges(ranges)
+            fd = os.open(path, os.O_RDONLY)
+            try:
+                result = self.qvortex.lib.qvortex_merkle_update_fd(self.tree, fd, arr, n)
+            finally:
+                os.close(fd)
+            if result == -4:  # QVORTEX_ERROR_IO
+                err = ctypes.get_errno()
+                raise OSError(err, os.strerror(err) if err else "I/O error", os.fsdecode(path))
+            if result != 0:
+                raise QvortexError(f"Failed to update Qvortex Merkle tree: {result}")
+        
+        def reset(self):
+            """Make the next update rebuild the whole tree"""
+            self.qvortex.lib.qvortex_merkle_reset(self.tree)
+        
+        def root(self) -> bytes:
+            """The tree_hash() digest of the input as of the last update"""
+            out_buf = (c_uint8 * 64)()
+            result = self.qvortex.lib.qvortex_merkle_root(self.tree, out_buf)
+            if result != 0:
+                raise QvortexError(f"Qvortex Merkle tree is not built: {result}")
+            return bytes(out_buf)
+        
+        def export(self) -> bytes:
+            """Serialize every chaining value, e.g. to store next to the file"""
+            size = self.qvortex.lib.qvortex_merkle_export_size(self.tree)
+            out_buf = (c_uint8 * max(size, 1))()
+            out_len = c_size_t(0)
+            result = self.qvortex.lib.qvortex_merkle_export(self.tree, out_buf, size,
+                                                            ctypes.byref(out_len))
+            if result != 0:
+                raise QvortexError(f"Failed to export Qvortex Merkle tree: {result}")
+            return bytes(out_buf[:out_len.value])
+        
+        def load(self, exported: bytes):
+            """Restore values from export(), made under the same key"""
+            exported = bytes(exported)
+            result = self.qvortex.lib.qvortex_merkle_import(self.tree, exported, len(exported))
+            if result != 0:
+                raise QvortexError(f"Failed to import Qvortex Merkle tree: {result}")
+    
+    def merkle(self, key=None):
+        """Create an incremental tree-mode hasher (see MerkleTree)"""
+        return self.MerkleTree(self, key)
+    
+    class DigestIndex:
+        """Persistent map from 64-byte digests to integers, backed by a mapped file"""
+        
+        def __init__(self, qvortex_instance, path, capacity=None, writable=False):
+            self.qvortex = qvortex_instance
+            self.index = ctypes.c_void_p()
+            path = os.fsencode(path)
+            if capacity is not None:
+                result = qvortex_instance.lib.qvortex_index_create(path, capacity, ctypes.byref(self.index))
+            else:
+                result = qvortex_instance.lib.qvortex_index_open(path, int(writable), ctypes.byref(self.index))
+            if result == -4:  # QVORTEX_ERROR_IO
+                err = ctypes.get_errno()
+                raise OSError(err, os.strerror(err) if err else "I/O error", os.fsdecode(path))
+            if result != 0:
+                raise QvortexError(f"Failed to open Qvortex digest index: {result}")
+        
+        def __del__(self):
+            self.close()
+        
+        def __enter__(self):
+            return self
+        
+        def __exit__(self, exc_type, exc_val, exc_tb):
+            self.close()
+        
+        def __len__(self):
+            return self.qvortex.lib.qvortex_index_count(self.index)
+        
+        def close(self):
+            index = getattr(self, 'index', None)
+            if index:
+                self.qvortex.lib.qvortex_index_close(index)
+                self.index = None
+        
+        def sync(self):
+            """Flush inserted entries to disk"""
+            result = self.qvortex.lib.qvortex_index_sync(self.index)
+            if result != 0:
+                raise QvortexError(f"Failed to sync Qvortex digest index: {result}")
+        
+        def _batch(self, fn, digests, values):
+            digests = list(digests)
+            if any(len(d) != 64 for d in digests):
+                raise ValueError("Digests must be 64 bytes")
+            n = len(digests)
+            vals = (ctypes.c_uint64 * max(n, 1))(*values)
+            bitmap = (c_uint8 * max((n + 7) // 8, 1))()
+            result = fn(self.index, b"".join(digests), vals, n, bitmap)
+            if result != 0:
+                raise QvortexError(f"Qvortex digest index operation failed: {result}")
+            return [vals[i] if bitmap[i >> 3] & (1 << (i & 7)) else None for i in range(n)], vals
+        
+        def get_many(self, digests):
+            """Value stored for each digest, or None where absent"""
+            return self._batch(self.qvortex.lib.qvortex_index_lookup_many, digests, ())[0]
+        
+        def get(self, digest):
+            return self.get_many([digest])[0]
+        
+        def insert_many(self, digests, values):
+            """
+            Add each (digest, value) pair unless the digest is present; returns the
+            stored value for every digest, which is the given one where it was added
+            """
+            digests, values = list(digests), list(values)
+            if len(values) != len(digests):
+                raise ValueError("Need one value per digest")
+            vals = self._batch(self.qvortex.lib.qvortex_index_insert_many, digests, values)[1]
+            return [vals[i] for i in range(len(values))]
+        
+        def insert(self, digest, value):
+            return self.insert_many([digest], [value])[0]
+    
+    def digest_index(self, path, capacity=None, writable=False):
+        """
+        Create a digest index at path with room for capacity entries, or open an
+        existing one when capacity is None (see DigestIndex)
+        """
+        return self.DigestIndex(self, path, capacity, writable)
+    
+    class GpuHasher:
+        """Batches of records hashed on the GPU, the key's S-box uploaded once"""
+        
+        def __init__(self, qvortex_instance, key=None):
+            self.qvortex = qvortex_instance
+            self.handle = ctypes.c_void_p()
+            key_ptr, key_len = qvortex_instance._key_args(key)
+            result = qvortex_instance.lib.qvortex_gpu_new(key_ptr, key_len, ctypes.byref(self.handle))
+            if result == -3:  # QVORTEX_ERROR_UNSUPPORTED
+                raise QvortexError("No GPU backend in this build, or no usable device")
+            if result != 0:
+                raise QvortexError(f"Failed to open Qvortex GPU backend: {result}")
+        
+        def __del__(self):
+            self.close()
+        
+        def close(self):
+            handle = getattr(self, 'handle', None)
+            if handle:
+                self.qvortex.lib.qvortex_gpu_free(handle)
+                self.handle = None
+        
+        def hash_records(self, data, records):
+            """Digest of each (offset, length) record of data, as hash() would give"""
+            records = list(records)
+            n = len(records)
+            arr = (_Range * max(n, 1))(*records)
+            out_buf = (c_uint8 * (64 * max(n, 1)))()
+            with _InputBuffer(data) as buf:
+                result = self.qvortex.lib.qvortex_gpu_hash_records(self.handle, buf.ptr, buf.len,
+                                                                   arr, n, out_buf)
+            if result != 0:
+                raise QvortexError(f"Qvortex GPU batch failed with error code {result}")
+            raw = bytes(out_buf)
+            return [raw[64 * i:64 * (i + 1)] for i in range(n)]
+    
+    def gpu(self, key=None):
+        """Open the GPU batch backend (see GpuHasher); raises QvortexError without one"""
+        return self.GpuHasher(self, key)
+    
+    def gpu_api(self) -> Optional[str]:
+        """"cuda" or "metal" if the library was built with a GPU backend, else None"""
+        api = self.lib.qvortex_gpu_api()
+        return api.decode() if api else None
+    
+    class HashContext:
+        """Context manager for incremental hashing"""
+        
+        EXPORT_MAX = 147
+        
+        def __init__(self, qvortex_instance, key=None, shared_key=None, checkpoint=None):
+            self.qvortex = qvortex_instance
+            self.key = key
+            lib = self.qvortex.lib
+            self._allocate()
+            
+            # The context holds its own reference to the key
+            handle = shared_key if shared_key is not None else self.qvortex._new_key(key)
+            if checkpoint is not None:
+                checkpoint = bytes(checkpoint)
+                result = lib.qvortex_ctx_import(self.ctx, handle, checkpoint, len(checkpoint))
+            else:
+                result = lib.qvortex_ctx_init(self.ctx, handle)
+            if shared_key is None:
+                lib.qvortex_key_release(handle)
             
             if result != 0:
+                self.ctx = None
                 raise QvortexError(f"Failed to initialize Qvortex context: {result}")
         
+        def _allocate(self):
+            # Exactly qvortex_ctx_size() bytes at a qvortex_ctx_align() boundary
+            align = self.qvortex.ctx_align
+            self._mem = ctypes.create_string_buffer(self.qvortex.ctx_size + align - 1)
+            self.ctx = ctypes.c_void_p((ctypes.addressof(self._mem) + align - 1) & ~(align - 1))
+        
+        def __del__(self):
+            # Releases the key if digest() was never called
+            ctx = getattr(self, 'ctx', None)
+            if ctx is not None:
+                self.qvortex.lib.qvortex_ctx_discard(ctx)
+        
         def update(self, data):
-            """Update the hash context with more data"""
-            if isinstance(data, str):
-                data = data.encode('utf-8')
-            
-            data_len = len(data)
-            if data_len == 0:
-                return
+            """Update the hash context with more data (any bytes-like object, not copied)"""
+            with _InputBuffer(data) as buf:
+                if buf.len == 0:
+                    return
                 
-            data_buf = (c_uint8 * data_len)(*data)
+                result = self.qvortex.lib.qvortex_ctx_update(
+                    self.ctx,
+                    buf.ptr,
+                    buf.len
+                )
             
-            result = self.qvortex.lib.qvortex_update(
-                self.ctx,
-                data_buf,
-                data_len
-            )
+            if result != 0:
+                raise QvortexError(f"Failed to update Qvortex context: {result}")
+        
+        def updatev(self, fragments):
+            """Update with a sequence of bytes-like fragments in one call (not copied)"""
+            bufs = []
+            try:
+                bufs = [_InputBuffer(f) for f in fragments]
+                if not bufs:
+                    return
+                iov = (_IoVec * len(bufs))(*[(b.ptr, b.len) for b in bufs])
+                result = self.qvortex.lib.qvortex_ctx_updatev(self.ctx, iov, len(bufs))
+            finally:
+                for b in bufs:
+                    b.release()
             
             if result != 0:
                 raise QvortexError(f"Failed to update Qvortex context: {result}")
         
+        def copy(self):
+            """Fork the stream (hashlib-style); the copy shares the key, not the S-box"""
+            other = self.__class__.__new__(self.__class__)
+            other.qvortex = self.qvortex
+            other.key = self.key
+            other._allocate()
+            
+            result = self.qvortex.lib.qvortex_ctx_clone(other.ctx, self.ctx)
+            if result != 0:
+                other.ctx = None
+                raise QvortexError(f"Failed to copy Qvortex context: {result}")
+            
+            return other
+        
+        def export(self) -> bytes:
+            """Checkpoint the stream; resume it with QvortexHash.resume() under the same key"""
+            out_buf = (c_uint8 * self.EXPORT_MAX)()
+            out_len = c_size_t(0)
+            
+            result = self.qvortex.lib.qvortex_ctx_export(
+                self.ctx, out_buf, self.EXPORT_MAX, ctypes.byref(out_len)
+            )
+            
+            if result != 0:
+                raise QvortexError(f"Failed to export Qvortex context: {result}")
+            
+            return bytes(out_buf[:out_len.value])
+        
         def digest(self):
             """Finalize and return the digest"""
             out_buf = (c_uint8 * 64)()
             
-            result = self.qvortex.lib.qvortex_final(
+            result = self.qvortex.lib.qvortex_ctx_final(
                 self.ctx,
                 out_buf
             )
@@ -262,13 +1238,42 @@ class QvortexHash:
     
     def new(self, key=None):
         """Create a new hash context for incremental updates"""
-        return self.HashContext(self, key or self.key)
+        if key is None:
+            return self.HashContext(self, self.key, self._key)
+        return self.HashContext(self, key)
+    
+    def resume(self, checkpoint: bytes, key=None):
+        """Recreate a hash context from HashContext.export(), under the key it was made with"""
+        if key is None:
+            return self.HashContext(self, self.key, self._key, checkpoint=checkpoint)
+        return self.HashContext(self, key, checkpoint=checkpoint)
     
     @property
     def version(self) -> str:
         """Get the version of the Qvortex library"""
         version_bytes = self.lib.qvortex_version()
         return version_bytes.decode('utf-8')
+    
+    @property
+    def backend(self) -> str:
+        """Get the name of the SIMD backend selected at load time"""
+        return self.lib.qvortex_backend_name().decode('utf-8')
+    
+    def stats(self) -> Optional[dict]:
+        """
+        Process-wide performance counters, or None if the library was built
+        without them (QVORTEX_STATS=1 ./build_qvortex.sh enables them)
+        """
+        s = _Stats()
+        if self.lib.qvortex_stats_snapshot(ctypes.byref(s)) != 0:
+            return None
+        return {
+            "bytes": s.bytes,
+            "blocks": s.blocks,
+            "shake128_calls": s.shake128_calls,
+            "tail_copies": s.tail_copies,
+            "backend": s.backend.decode('utf-8')
+        }
 
 # Create a global instance with default settings
 try:
@@ -294,6 +1299,24 @@ def hash(data, key=None):
         raise QvortexError("Qvortex library not available")
     return qvortex.hash(data, key)
 
+def hash64(data, key=None):
+    """
+    Convenience function to compute the 64-bit Qvortex table hash
+    
+    Args:
+        data: Input data to hash
+        key: Optional key for keyed hashing
+    
+    Returns:
+        int: Unsigned 64-bit hash
+    
+    Raises:
+        QvortexError: If the library is not available
+    """
+    if qvortex is None:
+        raise QvortexError("Qvortex library not available")
+    return qvortex.hash64(data, key)
+
 # Example usage
 if __name__ == "__main__":
     # Simple test to verify the wrapper works
@@ -319,6 +1342,7 @@ if __name__ == "__main__":
         print(f"h1 == h3: {h1 == h3}")
         
         print(f"Qvortex version: {qvortex.version}")
+        print(f"Qvortex backend: {qvortex.backend}")
         
     except QvortexError as e:
         print(f"Error: {e}")
@@ -0,0 +1,393 @@
+/**
+ * qvortex_bench - throughput and latency benchmark
+ *
+ * Sweeps message sizes (8 B to 1 GiB by default) over every backend this
+ * CPU supports, in three modes:
+ *
+ *   unkeyed   qvortex_hash with no key
+ *   keyed     qvortex_hash with a key, so each call pays the shake128 S-box
+ *   template  qvortex_hash_with_template, with the key schedule done once
+ *   hash64    qvortex_hash64, the 64-bit table hash, with the same template
+ *
+ * plus the wide variant, qvortex-1024, in template mode only, and the
+ * same sizes over SHA-256, SHA-512, BLAKE2b and BLAKE3 where the build
+ * found OpenSSL, CommonCrypto or libblake3. Each point reports the p50 and
+ * p99 time per call, the throughput at p50 and, when the clock rate is
+ * known, cycles per byte. --json writes the results as one JSON object
+ * for tracking regressions between releases.
+ *
+ * Built by "build_qvortex.sh bench"; arguments after "bench" are passed on.
+ */
+ 
+ #include <getopt.h>
+ #include <time.h>
+ #include "qvortex_lib.c"
+ 
+ #if defined(__x86_64__) || defined(__i386__)
+ #include <x86intrin.h>
+ #endif
+ #if defined(QVORTEX_BENCH_OPENSSL)
+ #include <openssl/evp.h>
+ #endif
+ #if defined(__APPLE__)
+ #include <CommonCrypto/CommonDigest.h>
+ #endif
+ #if defined(QVORTEX_BENCH_BLAKE3)
+ #include <blake3.h>
+ #endif
+ 
+ #define QVORTEX_BENCH_MAX_SAMPLES 10000
+ #define QVORTEX_BENCH_MIN_SAMPLES 3
+ #define QVORTEX_BENCH_SAMPLE_NS 2000.0     /* batch tiny calls up to this per sample */
+ #define QVORTEX_BENCH_MAX_CASES 40
+ 
+ typedef void (*qvortex_bench_fn)(void *arg, const uint8_t *data, size_t len, uint8_t *out);
+ 
+ typedef struct {
+   const char *algorithm;
+   const char *backend;                 /* NULL for other libraries */
+   const char *mode;
+   qvortex_bench_fn fn;
+   void *arg;
+ } qvortex_bench_case;
+ 
+ typedef struct {
+   double p50_ns;
+   double p99_ns;
+   size_t samples;
+   size_t batch;
+ } qvortex_bench_result;
+ 
+ static const char *qvortex_bench_prog = "qvortex_bench";
+ static const uint8_t qvortex_bench_key[] = "qvortex benchmark key";
+ static volatile uint8_t qvortex_bench_sink;
+ 
+ static double qvortex_bench_now_ns(void) {
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+ }
+ 
+ /* Estimate the core clock from the TSC; 0 where there is no cycle counter to read */
+ static double qvortex_bench_estimate_ghz(void) {
+ #if defined(__x86_64__) || defined(__i386__)
+   double t0 = qvortex_bench_now_ns();
+   uint64_t c0 = __rdtsc();
+   while (qvortex_bench_now_ns() - t0 < 50e6) {
+   }
+   uint64_t c1 = __rdtsc();
+   double t1 = qvortex_bench_now_ns();
+   return (double)(c1 - c0) / (t1 - t0);
+ #else
+   return 0.0;
+ #endif
+ }
+ 
+ /* ---- Hash functions under test ---- */
+ 
+ static void qvortex_bench_unkeyed(void *arg, const uint8_t *data, size_t len, uint8_t *out) {
+   (void)arg;
+   qvortex_hash(data, len, 0, 0, NULL, 0, out);
+ }
+ 
+ static void qvortex_bench_keyed(void *arg, const uint8_t *data, size_t len, uint8_t *out) {
+   (void)arg;
+   qvortex_hash(data, len, 0, 0, qvortex_bench_key, sizeof(qvortex_bench_key) - 1, out);
+ }
+ 
+ static void qvortex_bench_template(void *arg, const uint8_t *data, size_t len, uint8_t *out) {
+   qvortex_hash_with_template((const qvortex_template *)arg, data, len, out);
+ }
+ 
+ static void qvortex_bench_wide(void *arg, const uint8_t *data, size_t len, uint8_t *out) {
+   qvortex_wide_hash_with_template((const qvortex_template *)arg, data, len, out);
+ }
+ 
+ static void qvortex_bench_hash64(void *arg, const uint8_t *data, size_t len, uint8_t *out) {
+   uint64_t h = qvortex_hash64(data, len, (const qvortex_template *)arg);
+   memcpy(out, &h, sizeof(h));
+ }
+ 
+ #if defined(QVORTEX_BENCH_OPENSSL)
+ static EVP_MD_CTX *qvortex_bench_evp_ctx;
+ 
+ static void qvortex_bench_openssl(void *arg, const uint8_t *data, size_t len, uint8_t *out) {
+   EVP_DigestInit_ex(qvortex_bench_evp_ctx, (const EVP_MD *)arg, NULL);
+   EVP_DigestUpdate(qvortex_bench_evp_ctx, data, len);
+   EVP_DigestFinal_ex(qvortex_bench_evp_ctx, out, NULL);
+ }
+ #endif
+ 
+ #if defined(__APPLE__)
+ /* CommonCrypto takes a 32-bit length; larger inputs go through the streaming API */
+ static void qvortex_bench_cc_sha256(void *arg, const uint8_t *data, size_t len, uint8_t *out) {
+   CC_SHA256_CTX c;
+   (void)arg;
+   CC_SHA256_Init(&c);
+   for (size_t n; len > 0; data += n, len -= n) {
+     n = len < (1u << 30) ? len : (1u << 30);
+     CC_SHA256_Update(&c, data, (CC_LONG)n);
+   }
+   CC_SHA256_Final(out, &c);
+ }
+ 
+ static void qvortex_bench_cc_sha512(void *arg, const uint8_t *data, size_t len, uint8_t *out) {
+   CC_SHA512_CTX c;
+   (void)arg;
+   CC_SHA512_Init(&c);
+   for (size_t n; len > 0; data += n, len -= n) {
+     n = len < (1u << 30) ? len : (1u << 30);
+     CC_SHA512_Update(&c, data, (CC_LONG)n);
+   }
+   CC_SHA512_Final(out, &c);
+ }
+ #endif
+ 
+ #if defined(QVORTEX_BENCH_BLAKE3)
+ static void qvortex_bench_blake3(void *arg, const uint8_t *data, size_t len, uint8_t *out) {
+   blake3_hasher h;
+   (void)arg;
+   blake3_hasher_init(&h);
+   blake3_hasher_update(&h, data, len);
+   blake3_hasher_finalize(&h, out, 64);
+ }
+ #endif
+ 
+ /* ---- Measurement ---- */
+ 
+ static int qvortex_bench_cmp_double(const void *a, const void *b) {
+   double x = *(const double *)a, y = *(const double *)b;
+   return (x > y) - (x < y);
+ }
+ 
+ /*
+  * Time one case at one size. Calls are batched so a sample lasts at least
+  * QVORTEX_BENCH_SAMPLE_NS, which keeps clock overhead out of small-message
+  * latencies; sampling stops when the time budget is spent.
+  */
+ static void qvortex_bench_measure(const qvortex_bench_case *c, const uint8_t *data, size_t len,
+                                   double budget_ns, double *samples, qvortex_bench_result *res) {
+   uint8_t out[QVORTEX_WIDE_DIGEST_BYTES];
+   size_t calls = 0;
+ 
+   /* Warm up caches and estimate the cost of one call */
+   double start = qvortex_bench_now_ns(), elapsed;
+   do {
+     c->fn(c->arg, data, len, out);
+     calls++;
+     elapsed = qvortex_bench_now_ns() - start;
+   } while (elapsed < budget_ns / 20 && calls < 1000000);
+ 
+   double per_call = elapsed / (double)calls;
+   size_t batch = per_call >= QVORTEX_BENCH_SAMPLE_NS
+                  ? 1 : (size_t)(QVORTEX_BENCH_SAMPLE_NS / per_call) + 1;
+   size_t n = 0;
+ 
+   start = qvortex_bench_now_ns();
+   while (n < QVORTEX_BENCH_MAX_SAMPLES &&
+          (n < QVORTEX_BENCH_MIN_SAMPLES || qvortex_bench_now_ns() - start < budget_ns)) {
+     double t0 = qvortex_bench_now_ns();
+     for (size_t i = 0; i < batch; i++) c->fn(c->arg, data, len, out);
+     samples[n++] = (qvortex_bench_now_ns() - t0) / (double)batch;
+   }
+   qvortex_bench_sink ^= out[0];
+ 
+   qsort(samples, n, sizeof(*samples), qvortex_bench_cmp_double);
+   res->p50_ns = samples[n / 2];
+   res->p99_ns = samples[(n * 99) / 100 < n ? (n * 99) / 100 : n - 1];
+   res->samples = n;
+   res->batch = batch;
+ }
+ 
+ /* ---- Output ---- */
+ 
+ static void qvortex_bench_format_size(size_t len, char *buf, size_t cap) {
+   if (len >= (1u << 30) && len % (1u << 30) == 0) snprintf(buf, cap, "%zu GiB", len >> 30);
+   else if (len >= (1u << 20) && len % (1u << 20) == 0) snprintf(buf, cap, "%zu MiB", len >> 20);
+   else if (len >= (1u << 10) && len % (1u << 10) == 0) snprintf(buf, cap, "%zu KiB", len >> 10);
+   else snprintf(buf, cap, "%zu B", len);
+ }
+ 
+ static void qvortex_bench_print_text(const qvortex_bench_case *c, size_t len,
+                                      const qvortex_bench_result *res, double ghz) {
+   char size[32];
+   qvortex_bench_format_size(len, size, sizeof(size));
+   printf("%-12s %-12s %-9s %9s  p50 %12.1f ns  p99 %12.1f ns  %10.1f MB/s",
+          c->algorithm, c->backend ? c->backend : "-", c->mode, size,
+          res->p50_ns, res->p99_ns, (double)len / res->p50_ns * 1e3);
+   if (ghz > 0) printf("  %8.2f cpb", res->p50_ns * ghz / (double)len);
+   printf("\n");
+   fflush(stdout);
+ }
+ 
+ static void qvortex_bench_print_json(const qvortex_bench_case *c, size_t len,
+                                      const qvortex_bench_result *res, double ghz, int first) {
+   printf("%s\n    {\"algorithm\": \"%s\", ", first ? "" : ",", c->algorithm);
+   if (c->backend) printf("\"backend\": \"%s\", ", c->backend);
+   else printf("\"backend\": null, ");
+   printf("\"mode\": \"%s\", \"bytes\": %zu, \"p50_ns\": %.1f, \"p99_ns\": %.1f, "
+          "\"mb_per_s\": %.1f, ",
+          c->mode, len, res->p50_ns, res->p99_ns, (double)len / res->p50_ns * 1e3);
+   if (ghz > 0) printf("\"cycles_per_byte\": %.3f, ", res->p50_ns * ghz / (double)len);
+   else printf("\"cycles_per_byte\": null, ");
+   printf("\"samples\": %zu, \"calls_per_sample\": %zu}", res->samples, res->batch);
+   fflush(stdout);
+ }
+ 
+ /* ---- Driver ---- */
+ 
+ /* Parse a size with an optional K, M or G (binary) suffix; 0 on error */
+ static size_t qvortex_bench_parse_size(const char *s) {
+   char *end;
+   unsigned long long v = strtoull(s, &end, 10);
+   if (end == s) return 0;
+   switch (*end) {
+   case 'k': case 'K': v <<= 10; end++; break;
+   case 'm': case 'M': v <<= 20; end++; break;
+   case 'g': case 'G': v <<= 30; end++; break;
+   default: break;
+   }
+   if (*end == 'i') end++;
+   if (*end == 'B') end++;
+   return *end == '\0' ? (size_t)v : 0;
+ }
+ 
+ static void qvortex_bench_usage(FILE *f) {
+   fprintf(f,
+           "Usage: %s [OPTION]...\n"
+           "Benchmark Qvortex on every supported backend against other hashes.\n"
+           "\n"
+           "  -b, --backend=NAME   only benchmark this Qvortex backend\n"
+           "  -s, --min-size=N     smallest message (default 8; K, M, G suffixes)\n"
+           "  -m, --max-size=N     largest message (default 1G)\n"
+           "  -t, --time=SECONDS   sampling budget per point (default 0.2)\n"
+           "      --ghz=F          core clock for cycles/byte (default: TSC estimate)\n"
+           "      --no-compare     skip SHA-2, BLAKE2b and BLAKE3\n"
+           "      --json           write results as JSON to standard output\n"
+           "  -h, --help           display this help and exit\n",
+           qvortex_bench_prog);
+ }
+ 
+ int main(int argc, char *argv[]) {
+   enum { OPT_GHZ = 256, OPT_NO_COMPARE, OPT_JSON };
+   static const struct option long_options[] = {
+     { "backend", required_argument, NULL, 'b' },
+     { "min-size", required_argument, NULL, 's' },
+     { "max-size", required_argument, NULL, 'm' },
+     { "time", required_argument, NULL, 't' },
+     { "ghz", required_argument, NULL, OPT_GHZ },
+     { "no-compare", no_argument, NULL, OPT_NO_COMPARE },
+     { "json", no_argument, NULL, OPT_JSON },
+     { "help", no_argument, NULL, 'h' },
+     { NULL, 0, NULL, 0 }
+   };
+   const char *only_backend = NULL;
+   size_t min_size = 8, max_size = (size_t)1 << 30;
+   double budget_s = 0.2, ghz = -1.0;
+   int compare = 1, json = 0, opt;
+ 
+   while ((opt = getopt_long(argc, argv, "b:s:m:t:h", long_options, NULL)) != -1) {
+     switch (opt) {
+     case 'b': only_backend = optarg; break;
+     case 's': min_size = qvortex_bench_parse_size(optarg); break;
+     case 'm': max_size = qvortex_bench_parse_size(optarg); break;
+     case 't': budget_s = atof(optarg); break;
+     case OPT_GHZ: ghz = atof(optarg); break;
+     case OPT_NO_COMPARE: compare = 0; break;
+     case OPT_JSON: json = 1; break;
+     case 'h': qvortex_bench_usage(stdout); return 0;
+     default: qvortex_bench_usage(stderr); return 1;
+     }
+   }
+   if (min_size == 0 || max_size < min_size || budget_s <= 0) {
+     fprintf(stderr, "%s: invalid size range or time budget\n", qvortex_bench_prog);
+     return 1;
+   }
+   if (only_backend && !qvortex_find_backend(only_backend)) {
+     fprintf(stderr, "%s: backend '%s' is unknown or unsupported here\n",
+             qvortex_bench_prog, only_backend);
+     return 1;
+   }
+   if (ghz < 0) ghz = qvortex_bench_estimate_ghz();
+ 
+   uint8_t *data = (uint8_t *)malloc(max_size);
+   double *samples = (double *)malloc(QVORTEX_BENCH_MAX_SAMPLES * sizeof(double));
+   if (!data || !samples) {
+     fprintf(stderr, "%s: cannot allocate %zu bytes; try a smaller --max-size\n",
+             qvortex_bench_prog, max_size);
+     return 1;
+   }
+   uint64_t x = 0x9E3779B97F4A7C15ULL;
+   for (size_t i = 0; i < max_size; i++) {
+     x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+     data[i] = (uint8_t)x;
+   }
+ 
+   /* Qvortex cases are tagged with a backend and run with it selected */
+   qvortex_bench_case cases[QVORTEX_BENCH_MAX_CASES];
+   size_t ncases = 0;
+   qvortex_template tpl;
+   qvortex_template_init(&tpl, qvortex_bench_key, sizeof(qvortex_bench_key) - 1);
+ 
+   for (size_t i = 0; i < QVORTEX_NUM_BACKENDS; i++) {
+     const qvortex_backend *b = qvortex_backends[i];
+     if (!b->supported() || (only_backend && strcmp(only_backend, b->name) != 0)) continue;
+     cases[ncases++] = (qvortex_bench_case){ "qvortex", b->name, "unkeyed", qvortex_bench_unkeyed, NULL };
+     cases[ncases++] = (qvortex_bench_case){ "qvortex", b->name, "keyed", qvortex_bench_keyed, NULL };
+     cases[ncases++] = (qvortex_bench_case){ "qvortex", b->name, "template", qvortex_bench_template, &tpl };
+     cases[ncases++] = (qvortex_bench_case){ "qvortex", b->name, "hash64", qvortex_bench_hash64, &tpl };
+     cases[ncases++] = (qvortex_bench_case){ "qvortex-1024", b->name, "template", qvortex_bench_wide, &tpl };
+   }
+ 
+   if (compare) {
+ #if defined(QVORTEX_BENCH_OPENSSL)
+     qvortex_bench_evp_ctx = EVP_MD_CTX_new();
+     cases[ncases++] = (qvortex_bench_case){ "sha256", NULL, "openssl", qvortex_bench_openssl, (void *)EVP_sha256() };
+     cases[ncases++] = (qvortex_bench_case){ "sha512", NULL, "openssl", qvortex_bench_openssl, (void *)EVP_sha512() };
+     cases[ncases++] = (qvortex_bench_case){ "blake2b", NULL, "openssl", qvortex_bench_openssl, (void *)EVP_blake2b512() };
+ #elif defined(__APPLE__)
+     cases[ncases++] = (qvortex_bench_case){ "sha256", NULL, "commoncrypto", qvortex_bench_cc_sha256, NULL };
+     cases[ncases++] = (qvortex_bench_case){ "sha512", NULL, "commoncrypto", qvortex_bench_cc_sha512, NULL };
+ #endif
+ #if defined(QVORTEX_BENCH_BLAKE3)
+     cases[ncases++] = (qvortex_bench_case){ "blake3", NULL, "blake3", qvortex_bench_blake3, NULL };
+ #endif
+   }
+ 
+   if (json) {
+     printf("{\n  \"qvortex_version\": \"%s\",\n  \"default_backend\": \"%s\",\n",
+            qvortex_version(), qvortex_backend_name());
+     if (ghz > 0) printf("  \"ghz\": %.3f,\n", ghz);
+     else printf("  \"ghz\": null,\n");
+     printf("  \"budget_s\": %.3f,\n  \"results\": [", budget_s);
+   } else {
+     printf("Qvortex %s, default backend %s", qvortex_version(), qvortex_backend_name());
+     if (ghz > 0) printf(", %.2f GHz", ghz);
+     printf("\n\n");
+   }
+ 
+   /* Sizes grow by 4x from min_size, and max_size is always included */
+   int first = 1;
+   for (size_t c = 0; c < ncases; c++) {
+     if (cases[c].backend) qvortex_set_backend(cases[c].backend);
+     for (size_t len = min_size;; len = len > max_size / 4 ? max_size : len * 4) {
+       qvortex_bench_result res;
+       qvortex_bench_measure(&cases[c], data, len, budget_s * 1e9, samples, &res);
+       if (json) qvortex_bench_print_json(&cases[c], len, &res, ghz, first);
+       else qvortex_bench_print_text(&cases[c], len, &res, ghz);
+       first = 0;
+       if (len == max_size) break;
+     }
+     if (!json) printf("\n");
+   }
+   qvortex_set_backend(NULL);
+ 
+   if (json) printf("\n  ]\n}\n");
+ 
+ #if defined(QVORTEX_BENCH_OPENSSL)
+   EVP_MD_CTX_free(qvortex_bench_evp_ctx);
+ #endif
+   free(samples);
+   free(data);
+   return 0;
+ }
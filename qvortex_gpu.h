@@ -0,0 +1,55 @@
+/**
+ * Device side of the optional GPU batch backend
+ *
+ * qvortex_lib.c calls these when built with QVORTEX_GPU=1; one of
+ * qvortex_gpu_cuda.cu (Linux, CUDA) or qvortex_gpu_metal.m (Apple, Metal)
+ * implements them. Each thread hashes one record with the kernels of
+ * qvortex_compress_scalar, the S-box held in shared (CUDA) or threadgroup
+ * (Metal) memory. Status codes are the QVORTEX_ERROR_* values of
+ * qvortex_lib.c.
+ */
+ 
+ #ifndef QVORTEX_GPU_H
+ #define QVORTEX_GPU_H
+ 
+ #include <stddef.h>
+ #include <stdint.h>
+ 
+ #ifdef __cplusplus
+ extern "C" {
+ #endif
+ 
+ /* One record of the batch buffer: same layout as qvortex_range */
+ typedef struct {
+   uint64_t offset;
+   uint64_t length;
+ } qvortex_gpu_record;
+ 
+ typedef struct qvortex_gpu_device qvortex_gpu_device;
+ 
+ /* "cuda" or "metal" */
+ const char *qvortex_gpu_device_api(void);
+ 
+ /*
+  * Open the default device and upload a template's S-box and initial
+  * state, once for every batch hashed through the handle. Returns
+  * QVORTEX_ERROR_UNSUPPORTED (-3) if there is no usable device.
+  */
+ int qvortex_gpu_device_open(const uint8_t sbox[256], const uint64_t state[8],
+                             qvortex_gpu_device **out);
+ 
+ /*
+  * Hash n records of data (len bytes) into out (n * 64 bytes). The caller
+  * has checked every record lies within data; device buffers grow to the
+  * largest batch seen and are reused.
+  */
+ int qvortex_gpu_device_hash(qvortex_gpu_device *dev, const uint8_t *data, size_t len,
+                             const qvortex_gpu_record *records, size_t n, uint8_t *out);
+ 
+ void qvortex_gpu_device_close(qvortex_gpu_device *dev);
+ 
+ #ifdef __cplusplus
+ }
+ #endif
+ 
+ #endif /* QVORTEX_GPU_H */
@@ -0,0 +1,198 @@
+/**
+ * Qvortex GPU batch backend - CUDA
+ *
+ * One thread per record: each runs the scalar compression over the
+ * record's full blocks, then pads the tail as qvortex_lite_compress_tail
+ * does, so digests equal qvortex_hash of each record. Each thread block
+ * first copies the template's S-box into shared memory; with every lookup
+ * data-dependent, that keeps them off global memory and the S-box is
+ * uploaded once per handle, not per launch.
+ *
+ * Built into libqvortex by QVORTEX_GPU=1 ./build_qvortex.sh when nvcc is
+ * found; see qvortex_gpu.h for the interface.
+ */
+ 
+ #include <cuda_runtime.h>
+ #include <string.h>
+ #include <stdlib.h>
+ #include "qvortex_gpu.h"
+ 
+ #define QVORTEX_GPU_SUCCESS 0
+ #define QVORTEX_GPU_ERROR_MEMORY_ALLOCATION -2
+ #define QVORTEX_GPU_ERROR_UNSUPPORTED -3
+ 
+ #define QVORTEX_GPU_THREADS 128
+ #define QVORTEX_GPU_BLOCK_BYTES 64
+ #define QVORTEX_GPU_SHORT_MAX (QVORTEX_GPU_BLOCK_BYTES - 9)
+ 
+ /* Template as uploaded: the initial state, then the S-box */
+ typedef struct {
+   uint64_t state[8];
+   uint8_t sbox[256];
+ } qvortex_gpu_template;
+ 
+ struct qvortex_gpu_device {
+   qvortex_gpu_template *tpl;                   /* device copies */
+   uint8_t *data;
+   size_t data_cap;
+   qvortex_gpu_record *records;
+   size_t records_cap;
+   uint8_t *out;
+   size_t out_cap;
+   cudaStream_t stream;
+ };
+ 
+ /* ---- Kernel ---- */
+ 
+ __device__ __forceinline__ uint64_t qvortex_gpu_rotl(uint64_t x, unsigned n) {
+   return (x << n) | (x >> ((64 - n) & 63));
+ }
+ 
+ __device__ __forceinline__ uint64_t qvortex_gpu_rotr(uint64_t x, unsigned n) {
+   return (x >> n) | (x << ((64 - n) & 63));
+ }
+ 
+ __device__ __forceinline__ void qvortex_gpu_mix(uint64_t *s, int a, int b, int c, int d) {
+   s[a] += s[b]; s[d] = qvortex_gpu_rotr(s[d] ^ s[a], 32);
+   s[c] += s[d]; s[b] = qvortex_gpu_rotr(s[b] ^ s[c], 24);
+   s[a] += s[b]; s[d] = qvortex_gpu_rotr(s[d] ^ s[a], 16);
+   s[c] += s[d]; s[b] = qvortex_gpu_rotr(s[b] ^ s[c], 63);
+ }
+ 
+ /*
+  * One 64-byte block. Fully unrolled, so the two-word state rotation of
+  * each round is register renaming and s[] never leaves registers.
+  */
+ __device__ __forceinline__ void qvortex_gpu_compress(uint64_t h[8], const uint8_t *sbox,
+                                                      const uint8_t *block) {
+   uint64_t s[8];
+ #pragma unroll
+   for (int i = 0; i < 8; i++) {
+     uint64_t m = 0;
+ #pragma unroll
+     for (int b = 0; b < 8; b++) m |= (uint64_t)sbox[block[8 * i + b]] << (8 * b);
+     s[i] = h[i] ^ qvortex_gpu_rotl(m, (unsigned)(m >> 56) & 63);
+   }
+ 
+ #pragma unroll
+   for (int r = 0; r < 2; r++) {
+     int o = 2 * r;
+     qvortex_gpu_mix(s, o & 7, (o + 2) & 7, (o + 4) & 7, (o + 6) & 7);
+     qvortex_gpu_mix(s, (o + 1) & 7, (o + 3) & 7, (o + 5) & 7, (o + 7) & 7);
+   }
+ 
+ #pragma unroll
+   for (int i = 0; i < 8; i++) h[i] ^= s[(i + 4) & 7];
+ }
+ 
+ __global__ void qvortex_gpu_hash_kernel(const qvortex_gpu_template *tpl, const uint8_t *data,
+                                         const qvortex_gpu_record *records, size_t n,
+                                         uint8_t *out) {
+   __shared__ uint8_t sbox[256];
+   for (int i = threadIdx.x; i < 256; i += blockDim.x) sbox[i] = tpl->sbox[i];
+   __syncthreads();
+ 
+   size_t idx = (size_t)blockIdx.x * blockDim.x + threadIdx.x;
+   if (idx >= n) return;
+ 
+   const uint8_t *msg = data + records[idx].offset;
+   const uint64_t len = records[idx].length;
+   uint64_t h[8];
+ #pragma unroll
+   for (int i = 0; i < 8; i++) h[i] = tpl->state[i];
+ 
+   uint64_t full = len / QVORTEX_GPU_BLOCK_BYTES;
+   for (uint64_t b = 0; b < full; b++) qvortex_gpu_compress(h, sbox, msg + b * QVORTEX_GPU_BLOCK_BYTES);
+ 
+   /* Tail, 0x80 and the 64-bit bit length: one block, or two past SHORT_MAX */
+   uint8_t pad[2 * QVORTEX_GPU_BLOCK_BYTES];
+   unsigned tail = (unsigned)(len % QVORTEX_GPU_BLOCK_BYTES);
+   unsigned nblocks = tail <= QVORTEX_GPU_SHORT_MAX ? 1 : 2;
+   const uint8_t *src = msg + full * QVORTEX_GPU_BLOCK_BYTES;
+   for (unsigned i = 0; i < 2 * QVORTEX_GPU_BLOCK_BYTES; i++) pad[i] = i < tail ? src[i] : 0;
+   pad[tail] = 0x80;
+   uint64_t bits = len * 8;
+   for (int i = 0; i < 8; i++) pad[nblocks * QVORTEX_GPU_BLOCK_BYTES - 8 + i] = (uint8_t)(bits >> (8 * i));
+   for (unsigned b = 0; b < nblocks; b++) qvortex_gpu_compress(h, sbox, pad + b * QVORTEX_GPU_BLOCK_BYTES);
+ 
+   uint8_t *dst = out + idx * 64;
+   for (int i = 0; i < 64; i++) dst[i] = (uint8_t)(h[i >> 3] >> (8 * (i & 7)));
+ }
+ 
+ /* ---- Host ---- */
+ 
+ /* Grow a device buffer to at least need bytes; contents are not kept */
+ static int qvortex_gpu_reserve(void **buf, size_t *cap, size_t need) {
+   if (need <= *cap) return QVORTEX_GPU_SUCCESS;
+   cudaFree(*buf);
+   *buf = NULL;
+   *cap = 0;
+   if (cudaMalloc(buf, need) != cudaSuccess) return QVORTEX_GPU_ERROR_MEMORY_ALLOCATION;
+   *cap = need;
+   return QVORTEX_GPU_SUCCESS;
+ }
+ 
+ extern "C" const char *qvortex_gpu_device_api(void) {
+   return "cuda";
+ }
+ 
+ extern "C" int qvortex_gpu_device_open(const uint8_t sbox[256], const uint64_t state[8],
+                                        qvortex_gpu_device **out) {
+   int count = 0;
+   if (cudaGetDeviceCount(&count) != cudaSuccess || count == 0) return QVORTEX_GPU_ERROR_UNSUPPORTED;
+ 
+   qvortex_gpu_device *dev = (qvortex_gpu_device *)calloc(1, sizeof(*dev));
+   if (!dev) return QVORTEX_GPU_ERROR_MEMORY_ALLOCATION;
+ 
+   qvortex_gpu_template host;
+   memcpy(host.state, state, sizeof(host.state));
+   memcpy(host.sbox, sbox, sizeof(host.sbox));
+   if (cudaStreamCreate(&dev->stream) != cudaSuccess) {
+     free(dev);
+     return QVORTEX_GPU_ERROR_UNSUPPORTED;
+   }
+   if (cudaMalloc((void **)&dev->tpl, sizeof(host)) != cudaSuccess ||
+       cudaMemcpy(dev->tpl, &host, sizeof(host), cudaMemcpyHostToDevice) != cudaSuccess) {
+     memset(&host, 0, sizeof(host));
+     qvortex_gpu_device_close(dev);
+     return QVORTEX_GPU_ERROR_MEMORY_ALLOCATION;
+   }
+   memset(&host, 0, sizeof(host));
+   *out = dev;
+   return QVORTEX_GPU_SUCCESS;
+ }
+ 
+ extern "C" int qvortex_gpu_device_hash(qvortex_gpu_device *dev, const uint8_t *data, size_t len,
+                                        const qvortex_gpu_record *records, size_t n, uint8_t *out) {
+   if (qvortex_gpu_reserve((void **)&dev->data, &dev->data_cap, len ? len : 1) != 0 ||
+       qvortex_gpu_reserve((void **)&dev->records, &dev->records_cap, n * sizeof(*records)) != 0 ||
+       qvortex_gpu_reserve((void **)&dev->out, &dev->out_cap, n * 64) != 0) {
+     return QVORTEX_GPU_ERROR_MEMORY_ALLOCATION;
+   }
+ 
+   /* Copies, kernel and readback are queued on one stream, then awaited once */
+   size_t grid = (n + QVORTEX_GPU_THREADS - 1) / QVORTEX_GPU_THREADS;
+   if (len) cudaMemcpyAsync(dev->data, data, len, cudaMemcpyHostToDevice, dev->stream);
+   cudaMemcpyAsync(dev->records, records, n * sizeof(*records), cudaMemcpyHostToDevice, dev->stream);
+   qvortex_gpu_hash_kernel<<<(unsigned)grid, QVORTEX_GPU_THREADS, 0, dev->stream>>>(
+       dev->tpl, dev->data, dev->records, n, dev->out);
+   cudaMemcpyAsync(out, dev->out, n * 64, cudaMemcpyDeviceToHost, dev->stream);
+   if (cudaStreamSynchronize(dev->stream) != cudaSuccess || cudaGetLastError() != cudaSuccess) {
+     return QVORTEX_GPU_ERROR_UNSUPPORTED;
+   }
+   return QVORTEX_GPU_SUCCESS;
+ }
+ 
+ extern "C" void qvortex_gpu_device_close(qvortex_gpu_device *dev) {
+   if (!dev) return;
+ 
+   if (dev->tpl) {
+     cudaMemset(dev->tpl, 0, sizeof(*dev->tpl));
+     cudaFree(dev->tpl);
+   }
+   cudaFree(dev->data);
+   cudaFree(dev->records);
+   cudaFree(dev->out);
+   if (dev->stream) cudaStreamDestroy(dev->stream);
+   free(dev);
+ }
@@ -0,0 +1,210 @@
+/**
+ * Qvortex GPU batch backend - Metal
+ *
+ * The kernel is that of qvortex_gpu_cuda.cu in Metal Shading Language:
+ * one thread per record, the template's S-box copied into threadgroup
+ * memory by each threadgroup, and the S-box and initial state uploaded
+ * once per handle. It is compiled from source when the handle is opened,
+ * so building needs no offline Metal toolchain.
+ *
+ * Apple GPUs share memory with the CPU: a page-aligned batch buffer is
+ * wrapped in place, anything else is copied once into a shared buffer.
+ *
+ * Built into libqvortex by QVORTEX_GPU=1 ./build_qvortex.sh on macOS
+ * (manual retain/release); see qvortex_gpu.h for the interface.
+ */
+ 
+ #import <Foundation/Foundation.h>
+ #import <Metal/Metal.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <unistd.h>
+ #include "qvortex_gpu.h"
+ 
+ #define QVORTEX_GPU_SUCCESS 0
+ #define QVORTEX_GPU_ERROR_MEMORY_ALLOCATION -2
+ #define QVORTEX_GPU_ERROR_UNSUPPORTED -3
+ 
+ /* Records per dispatch, so thread_position_in_grid fits in 32 bits */
+ #define QVORTEX_GPU_MAX_DISPATCH (1u << 30)
+ 
+ struct qvortex_gpu_device {
+   id<MTLDevice> device;
+   id<MTLCommandQueue> queue;
+   id<MTLComputePipelineState> pipeline;
+   id<MTLBuffer> tpl;                           /* state[8], then sbox[256] */
+ };
+ 
+ static const char qvortex_gpu_source[] =
+   "#include <metal_stdlib>\n"
+   "using namespace metal;\n"
+   "\n"
+   "struct qvortex_gpu_record { ulong offset; ulong length; };\n"
+   "struct qvortex_gpu_template { ulong state[8]; uchar sbox[256]; };\n"
+   "\n"
+   "static inline ulong qvortex_gpu_rotr(ulong x, ulong n) { return rotate(x, 64 - n); }\n"
+   "\n"
+   "static inline void qvortex_gpu_mix(thread ulong *s, int a, int b, int c, int d) {\n"
+   "  s[a] += s[b]; s[d] = qvortex_gpu_rotr(s[d] ^ s[a], 32);\n"
+   "  s[c] += s[d]; s[b] = qvortex_gpu_rotr(s[b] ^ s[c], 24);\n"
+   "  s[a] += s[b]; s[d] = qvortex_gpu_rotr(s[d] ^ s[a], 16);\n"
+   "  s[c] += s[d]; s[b] = qvortex_gpu_rotr(s[b] ^ s[c], 63);\n"
+   "}\n"
+   "\n"
+   "template <typename P>\n"
+   "static inline void qvortex_gpu_compress(thread ulong *h, threadgroup const uchar *sbox, P block) {\n"
+   "  ulong s[8];\n"
+   "  for (int i = 0; i < 8; i++) {\n"
+   "    ulong m = 0;\n"
+   "    for (int b = 0; b < 8; b++) m |= (ulong)sbox[block[8 * i + b]] << (8 * b);\n"
+   "    s[i] = h[i] ^ rotate(m, (m >> 56) & 63);\n"
+   "  }\n"
+   "  for (int r = 0; r < 2; r++) {\n"
+   "    int o = 2 * r;\n"
+   "    qvortex_gpu_mix(s, o & 7, (o + 2) & 7, (o + 4) & 7, (o + 6) & 7);\n"
+   "    qvortex_gpu_mix(s, (o + 1) & 7, (o + 3) & 7, (o + 5) & 7, (o + 7) & 7);\n"
+   "  }\n"
+   "  for (int i = 0; i < 8; i++) h[i] ^= s[(i + 4) & 7];\n"
+   "}\n"
+   "\n"
+   "kernel void qvortex_gpu_hash_kernel(device const qvortex_gpu_template *tpl [[buffer(0)]],\n"
+   "                                    device const uchar *data [[buffer(1)]],\n"
+   "                                    device const qvortex_gpu_record *records [[buffer(2)]],\n"
+   "                                    device uchar *out [[buffer(3)]],\n"
+   "                                    constant uint &n [[buffer(4)]],\n"
+   "                                    uint idx [[thread_position_in_grid]],\n"
+   "                                    uint lid [[thread_position_in_threadgroup]],\n"
+   "                                    uint width [[threads_per_threadgroup]]) {\n"
+   "  threadgroup uchar sbox[256];\n"
+   "  for (uint i = lid; i < 256; i += width) sbox[i] = tpl->sbox[i];\n"
+   "  threadgroup_barrier(mem_flags::mem_threadgroup);\n"
+   "  if (idx >= n) return;\n"
+   "\n"
+   "  device const uchar *msg = data + records[idx].offset;\n"
+   "  ulong len = records[idx].length;\n"
+   "  ulong h[8];\n"
+   "  for (int i = 0; i < 8; i++) h[i] = tpl->state[i];\n"
+   "\n"
+   "  ulong full = len / 64;\n"
+   "  for (ulong b = 0; b < full; b++) qvortex_gpu_compress(h, sbox, msg + b * 64);\n"
+   "\n"
+   "  uchar pad[128];\n"
+   "  uint tail = (uint)(len % 64);\n"
+   "  uint nblocks = tail <= 55 ? 1 : 2;\n"
+   "  device const uchar *src = msg + full * 64;\n"
+   "  for (uint i = 0; i < 128; i++) pad[i] = i < tail ? src[i] : 0;\n"
+   "  pad[tail] = 0x80;\n"
+   "  ulong bits = len * 8;\n"
+   "  for (int i = 0; i < 8; i++) pad[nblocks * 64 - 8 + i] = (uchar)(bits >> (8 * i));\n"
+   "  for (uint b = 0; b < nblocks; b++) qvortex_gpu_compress(h, sbox, (thread const uchar *)pad + b * 64);\n"
+   "\n"
+   "  device uchar *dst = out + (ulong)idx * 64;\n"
+   "  for (int i = 0; i < 64; i++) dst[i] = (uchar)(h[i >> 3] >> (8 * (i & 7)));\n"
+   "}\n";
+ 
+ const char *qvortex_gpu_device_api(void) {
+   return "metal";
+ }
+ 
+ int qvortex_gpu_device_open(const uint8_t sbox[256], const uint64_t state[8],
+                             qvortex_gpu_device **out) {
+   @autoreleasepool {
+     id<MTLDevice> device = MTLCreateSystemDefaultDevice();
+     if (!device) return QVORTEX_GPU_ERROR_UNSUPPORTED;
+ 
+     NSError *err = nil;
+     id<MTLLibrary> lib = [device newLibraryWithSource:@(qvortex_gpu_source) options:nil error:&err];
+     id<MTLFunction> fn = [lib newFunctionWithName:@"qvortex_gpu_hash_kernel"];
+     id<MTLComputePipelineState> pipeline = fn ? [device newComputePipelineStateWithFunction:fn error:&err] : nil;
+     [fn release];
+     [lib release];
+     if (!pipeline) {
+       [device release];
+       return QVORTEX_GPU_ERROR_UNSUPPORTED;
+     }
+ 
+     qvortex_gpu_device *dev = (qvortex_gpu_device *)calloc(1, sizeof(*dev));
+     id<MTLBuffer> tpl = [device newBufferWithLength:8 * sizeof(uint64_t) + 256
+                                             options:MTLResourceStorageModeShared];
+     id<MTLCommandQueue> queue = [device newCommandQueue];
+     if (!dev || !tpl || !queue) {
+       free(dev);
+       [tpl release];
+       [queue release];
+       [pipeline release];
+       [device release];
+       return QVORTEX_GPU_ERROR_MEMORY_ALLOCATION;
+     }
+     memcpy(tpl.contents, state, 8 * sizeof(uint64_t));
+     memcpy((uint8_t *)tpl.contents + 8 * sizeof(uint64_t), sbox, 256);
+ 
+     dev->device = device;
+     dev->queue = queue;
+     dev->pipeline = pipeline;
+     dev->tpl = tpl;
+     *out = dev;
+     return QVORTEX_GPU_SUCCESS;
+   }
+ }
+ 
+ int qvortex_gpu_device_hash(qvortex_gpu_device *dev, const uint8_t *data, size_t len,
+                             const qvortex_gpu_record *records, size_t n, uint8_t *out) {
+   @autoreleasepool {
+     const size_t page = (size_t)getpagesize();
+     id<MTLBuffer> buf;
+     if (len > 0 && (uintptr_t)data % page == 0 && len % page == 0) {
+       buf = [dev->device newBufferWithBytesNoCopy:(void *)data length:len
+                                           options:MTLResourceStorageModeShared deallocator:nil];
+     } else {
+       buf = [dev->device newBufferWithBytes:len ? (const void *)data : (const void *)"" length:len ? len : 1
+                                     options:MTLResourceStorageModeShared];
+     }
+     id<MTLBuffer> rec = [dev->device newBufferWithBytes:records length:n * sizeof(*records)
+                                                 options:MTLResourceStorageModeShared];
+     id<MTLBuffer> dig = [dev->device newBufferWithLength:n * 64 options:MTLResourceStorageModeShared];
+     if (!buf || !rec || !dig) {
+       [buf release];
+       [rec release];
+       [dig release];
+       return QVORTEX_GPU_ERROR_MEMORY_ALLOCATION;
+     }
+ 
+     /* Every dispatch goes into one command buffer, committed and awaited once */
+     id<MTLCommandBuffer> cmd = [dev->queue commandBuffer];
+     id<MTLComputeCommandEncoder> enc = [cmd computeCommandEncoder];
+     NSUInteger width = dev->pipeline.maxTotalThreadsPerThreadgroup;
+     if (width > 256) width = 256;
+     [enc setComputePipelineState:dev->pipeline];
+     [enc setBuffer:dev->tpl offset:0 atIndex:0];
+     [enc setBuffer:buf offset:0 atIndex:1];
+     for (size_t base = 0; base < n; base += QVORTEX_GPU_MAX_DISPATCH) {
+       uint32_t count = (uint32_t)(n - base < QVORTEX_GPU_MAX_DISPATCH ? n - base : QVORTEX_GPU_MAX_DISPATCH);
+       [enc setBuffer:rec offset:base * sizeof(*records) atIndex:2];
+       [enc setBuffer:dig offset:base * 64 atIndex:3];
+       [enc setBytes:&count length:sizeof(count) atIndex:4];
+       [enc dispatchThreads:MTLSizeMake(count, 1, 1) threadsPerThreadgroup:MTLSizeMake(width, 1, 1)];
+     }
+     [enc endEncoding];
+     [cmd commit];
+     [cmd waitUntilCompleted];
+ 
+     int rc = cmd.status == MTLCommandBufferStatusCompleted ? QVORTEX_GPU_SUCCESS
+                                                            : QVORTEX_GPU_ERROR_UNSUPPORTED;
+     if (rc == QVORTEX_GPU_SUCCESS) memcpy(out, dig.contents, n * 64);
+     [buf release];
+     [rec release];
+     [dig release];
+     return rc;
+   }
+ }
+ 
+ void qvortex_gpu_device_close(qvortex_gpu_device *dev) {
+   if (!dev) return;
+ 
+   memset(dev->tpl.contents, 0, dev->tpl.length);
+   [dev->tpl release];
+   [dev->pipeline release];
+   [dev->queue release];
+   [dev->device release];
+   free(dev);
+ }
@@ -10,8 +10,78 @@
  #include <stdio.h>
  #include <stdlib.h>
  #include <string.h>
+ #if defined(_WIN32)
+ #include <malloc.h>
+ #endif
+ 
+ /* Platform detection for threads (tree mode runs single-threaded without) */
+ #if !defined(_WIN32)
+ #include <pthread.h>
+ #include <unistd.h>
+ #define HAVE_PTHREADS 1
+ #else
+ #define HAVE_PTHREADS 0
+ #endif
+ 
+ /* Platform detection for file hashing (mmap, with read() as the fallback) */
+ #if !defined(_WIN32)
+ #include <errno.h>
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <sys/uio.h>
+ #define HAVE_POSIX_IO 1
+ #else
+ #define HAVE_POSIX_IO 0
+ /* Same layout as POSIX, for qvortex_updatev and qvortex_hashv */
+ struct iovec {
+   void *iov_base;
+   size_t iov_len;
+ };
+ #endif
+ 
+ /*
+  * Instrumentation. USDT probes are built in wherever <sys/sdt.h> exists
+  * (each is a single nop until a tracer attaches; -DQVORTEX_PROBES=0 drops
+  * them). Per-thread counters cost an add per call and are opt-in with
+  * -DQVORTEX_STATS=1. Both compile to nothing when off.
+  */
+ #ifndef QVORTEX_PROBES
+ #if defined(__has_include)
+ #if __has_include(<sys/sdt.h>)
+ #define QVORTEX_PROBES 1
+ #endif
+ #endif
+ #endif
+ #ifndef QVORTEX_PROBES
+ #define QVORTEX_PROBES 0
+ #endif
+ #ifndef QVORTEX_STATS
+ #define QVORTEX_STATS 0
+ #endif
+ 
+ /*
+  * Optional GPU batch hashing (qvortex_gpu_*), linked in from
+  * qvortex_gpu_cuda.cu or qvortex_gpu_metal.m by QVORTEX_GPU=1
+  * ./build_qvortex.sh. Without it the calls report QVORTEX_ERROR_UNSUPPORTED.
+  */
+ #ifndef QVORTEX_GPU
+ #define QVORTEX_GPU 0
+ #endif
+ #if QVORTEX_GPU
+ #include "qvortex_gpu.h"
+ #endif
+ 
+ #if QVORTEX_PROBES
+ #include <sys/sdt.h>
+ #define QVORTEX_PROBE1(name, a) DTRACE_PROBE1(qvortex, name, a)
+ #define QVORTEX_PROBE2(name, a, b) DTRACE_PROBE2(qvortex, name, a, b)
+ #else
+ #define QVORTEX_PROBE1(name, a) ((void)0)
+ #define QVORTEX_PROBE2(name, a, b) ((void)0)
+ #endif
  
- /* Platform detection for NEON support */
+ /* Platform detection for NEON support (baseline wherever it is defined) */
  #if defined(__ARM_NEON) || defined(__ARM_NEON__)
  #include <arm_neon.h>
  #define USE_NEON 1
@@ -19,6 +89,74 @@
  #define USE_NEON 0
  #endif
  
+ /*
+  * ARMv8.2 SHA3 instructions (EOR3/RAX1/XAR/BCAX) for Keccak. Like the x86
+  * kernels they are built with a target attribute and only used when the
+  * CPU reports FEAT_SHA3 at load time.
+  */
+ #if USE_NEON && defined(__aarch64__) && \
+     (defined(__ARM_FEATURE_SHA3) || \
+      (defined(__clang__) && __clang_major__ >= 16) || \
+      (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 10))
+ #define USE_NEON_SHA3 1
+ #if defined(__ARM_FEATURE_SHA3)
+ #define QVORTEX_TARGET_SHA3
+ #elif defined(__clang__)
+ #define QVORTEX_TARGET_SHA3 __attribute__((target("sha3")))
+ #else
+ #define QVORTEX_TARGET_SHA3 __attribute__((target("+sha3")))
+ #endif
+ #if defined(__APPLE__)
+ #include <sys/sysctl.h>
+ #elif defined(__linux__)
+ #include <sys/auxv.h>
+ #endif
+ #else
+ #define USE_NEON_SHA3 0
+ #endif
+ 
+ /*
+  * SVE for the multi-buffer and wide kernels, written vector-length
+  * agnostic. Built with a target attribute like SHA3 and used only when the
+  * CPU reports SVE with vectors of 256 bits or more: at 128 bits NEON is as
+  * wide, and its 64-byte TBL beats SVE's single-vector one for the S-box.
+  */
+ #if USE_NEON && defined(__aarch64__) && defined(__linux__) && \
+     (defined(__ARM_FEATURE_SVE) || \
+      (defined(__clang__) && __clang_major__ >= 16) || \
+      (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 14))
+ #include <arm_sve.h>
+ #include <sys/auxv.h>
+ #define USE_SVE 1
+ #if defined(__ARM_FEATURE_SVE)
+ #define QVORTEX_TARGET_SVE
+ #elif defined(__clang__)
+ #define QVORTEX_TARGET_SVE __attribute__((target("sve")))
+ #else
+ #define QVORTEX_TARGET_SVE __attribute__((target("+sve")))
+ #endif
+ #else
+ #define USE_SVE 0
+ #endif
+ 
+ /*
+  * x86 SIMD kernels are compiled with per-function target attributes and
+  * selected at load time (see "Backend Dispatch"), so the library itself
+  * needs no -mavx2 or -march=native and runs on any x86-64 host.
+  */
+ #if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+ #include <immintrin.h>
+ #define USE_AVX2 1
+ #define USE_AVX512 1
+ #define QVORTEX_TARGET_AVX2 __attribute__((target("avx2")))
+ #define QVORTEX_TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512vl")))
+ #define QVORTEX_TARGET_VBMI \
+   __attribute__((target("avx2,avx512f,avx512vl,avx512bw,avx512vbmi")))
+ #else
+ #define USE_AVX2 0
+ #define USE_AVX512 0
+ #endif
+ 
  /* Platform detection for crypto libraries */
  #if defined(__APPLE__)
  #include <CommonCrypto/CommonDigest.h>
@@ -39,6 +177,42 @@
  #define QVORTEX_LITE_ROUNDS 2
  #define QVORTEX_LITE_DIGEST_BYTES 64
  
+ /* Wide variant (Qvortex-1024): twice the state and block, same construction */
+ #define QVORTEX_WIDE_STATE_WORDS 16
+ #define QVORTEX_WIDE_BLOCK_BYTES 128
+ #define QVORTEX_WIDE_DIGEST_BYTES 128
+ 
+ /* Bulk kernels prefetch this far ahead of the block being compressed */
+ #define QVORTEX_PREFETCH_BYTES 512
+ #define QVORTEX_PREFETCH(p) __builtin_prefetch((const char *)(p) + QVORTEX_PREFETCH_BYTES, 0, 3)
+ 
+ /* Alignment of qvortex_ctx: its state and buffer share one cache-line pair */
+ #define QVORTEX_CTX_ALIGN 64
+ 
+ /* Longest input whose 0x80 byte and 64-bit length still fit in one block */
+ #define QVORTEX_LITE_SHORT_MAX (QVORTEX_LITE_BLOCK_BYTES - 9)
+ 
+ /* Widest multi-buffer batch (8 x 64-bit lanes in an AVX-512 register) */
+ #define QVORTEX_MAX_LANES 8
+ 
+ /* Tree mode: leaf chunk size and chunks per worker task (a 512 KiB subtree) */
+ #define QVORTEX_TREE_CHUNK_BYTES 8192
+ #define QVORTEX_TREE_TASK_CHUNKS 64
+ #define QVORTEX_TREE_MAX_DEPTH 64
+ 
+ /* File hashing: regular files this large are mapped, the rest are read */
+ #define QVORTEX_MMAP_MIN_BYTES (1 << 20)
+ #define QVORTEX_IO_BUFFER_BYTES (1 << 20)
+ #define QVORTEX_IO_ALIGN 4096
+ 
+ /* Streaming reader: default buffer per stream (two each) and reads in flight */
+ #define QVORTEX_READER_BUFFER_BYTES (256 << 10)
+ #define QVORTEX_READER_DEPTH 64
+ #define QVORTEX_READER_MAX_THREADS 16
+ 
+ /* qvortex_reader_new flag: use blocking I/O threads even where io_uring works */
+ #define QVORTEX_READER_THREADS 1
+ 
  /* Fixed rotation constants */
  #define QL_R1 32
  #define QL_R2 24
@@ -49,13 +223,148 @@
  #define QVORTEX_SUCCESS 0
  #define QVORTEX_ERROR_NULL_POINTER -1
  #define QVORTEX_ERROR_MEMORY_ALLOCATION -2
+ #define QVORTEX_ERROR_UNSUPPORTED -3
+ #define QVORTEX_ERROR_IO -4
+ #define QVORTEX_ERROR_FORMAT -5
+ #define QVORTEX_ERROR_VERIFY -6
+ 
+ /* ------------------------------------------------------------------------
+    Performance Counters
+    ------------------------------------------------------------------------ */
+ 
+ /* Snapshot from qvortex_stats_snapshot: totals since load, all threads */
+ typedef struct {
+   uint64_t bytes;           /* Message bytes hashed */
+   uint64_t blocks;          /* 64-byte blocks compressed (multi-buffer: per lane) */
+   uint64_t shake128_calls;  /* SHAKE-128 runs (two per key schedule) */
+   uint64_t tail_copies;     /* Partial blocks copied into a context buffer */
+   const char *backend;      /* Selected compression backend */
+ } qvortex_stats;
+ 
+ #if QVORTEX_STATS
+ typedef struct qvortex_stats_slot {
+   uint64_t bytes;
+   uint64_t blocks;
+   uint64_t shake128_calls;
+   uint64_t tail_copies;
+   int registered;
+   struct qvortex_stats_slot *next;
+ } qvortex_stats_slot;
+ 
+ static __thread qvortex_stats_slot qvortex_stats_tls;
+ 
+ #if HAVE_PTHREADS
+ /*
+  * Each thread owns its slot, so counting is a plain load and store with no
+  * lock prefix. Live slots are linked into a list for snapshots; a thread
+  * that exits folds its counts into qvortex_stats_retired.
+  */
+ static pthread_mutex_t qvortex_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+ static pthread_once_t qvortex_stats_once = PTHREAD_ONCE_INIT;
+ static pthread_key_t qvortex_stats_key;
+ static qvortex_stats_slot *qvortex_stats_live;
+ static qvortex_stats_slot qvortex_stats_retired;
+ 
+ static void qvortex_stats_accumulate(qvortex_stats_slot *dst, const qvortex_stats_slot *src) {
+   dst->bytes += __atomic_load_n(&src->bytes, __ATOMIC_RELAXED);
+   dst->blocks += __atomic_load_n(&src->blocks, __ATOMIC_RELAXED);
+   dst->shake128_calls += __atomic_load_n(&src->shake128_calls, __ATOMIC_RELAXED);
+   dst->tail_copies += __atomic_load_n(&src->tail_copies, __ATOMIC_RELAXED);
+ }
+ 
+ static void qvortex_stats_thread_exit(void *arg) {
+   qvortex_stats_slot *slot = (qvortex_stats_slot *)arg;
+   pthread_mutex_lock(&qvortex_stats_lock);
+   for (qvortex_stats_slot **p = &qvortex_stats_live; *p; p = &(*p)->next) {
+     if (*p == slot) {
+       *p = slot->next;
+       break;
+     }
+   }
+   qvortex_stats_accumulate(&qvortex_stats_retired, slot);
+   pthread_mutex_unlock(&qvortex_stats_lock);
+ 
+   /* Hashing later in this thread (another TLS destructor) registers afresh */
+   slot->bytes = slot->blocks = slot->shake128_calls = slot->tail_copies = 0;
+   slot->next = NULL;
+   slot->registered = 0;
+ }
+ 
+ static void qvortex_stats_key_init(void) {
+   (void)pthread_key_create(&qvortex_stats_key, qvortex_stats_thread_exit);
+ }
+ 
+ static void qvortex_stats_register(qvortex_stats_slot *slot) {
+   pthread_once(&qvortex_stats_once, qvortex_stats_key_init);
+   pthread_mutex_lock(&qvortex_stats_lock);
+   slot->next = qvortex_stats_live;
+   qvortex_stats_live = slot;
+   pthread_mutex_unlock(&qvortex_stats_lock);
+   (void)pthread_setspecific(qvortex_stats_key, slot);
+   slot->registered = 1;
+ }
+ #else
+ static void qvortex_stats_register(qvortex_stats_slot *slot) {
+   slot->registered = 1;
+ }
+ #endif /* HAVE_PTHREADS */
+ 
+ static inline qvortex_stats_slot *qvortex_stats_self(void) {
+   qvortex_stats_slot *slot = &qvortex_stats_tls;
+   if (__builtin_expect(!slot->registered, 0)) qvortex_stats_register(slot);
+   return slot;
+ }
+ 
+ #define QVORTEX_STAT_ADD(field, n) do { \
+     qvortex_stats_slot *qs_ = qvortex_stats_self(); \
+     __atomic_store_n(&qs_->field, qs_->field + (uint64_t)(n), __ATOMIC_RELAXED); \
+   } while (0)
+ #else
+ #define QVORTEX_STAT_ADD(field, n) ((void)0)
+ #endif /* QVORTEX_STATS */
+ 
+ /* ------------------------------------------------------------------------
+    Backend Dispatch Table
+    ------------------------------------------------------------------------ */
+ 
+ /* Compress nblocks consecutive 64-byte blocks into state */
+ typedef void (*qvortex_compress_fn)(uint64_t state[QVORTEX_LITE_STATE_WORDS],
+                                     const uint8_t sbox[256],
+                                     const uint8_t *blocks, size_t nblocks);
+ 
+ /*
+  * Compress one block for each of `lanes` independent messages. States are
+  * word-sliced: state[w][lane] is word w of that lane's message.
+  */
+ typedef void (*qvortex_compress_multi_fn)(uint64_t state[QVORTEX_LITE_STATE_WORDS][QVORTEX_MAX_LANES],
+                                           const uint8_t sbox[256],
+                                           const uint8_t *const blocks[QVORTEX_MAX_LANES]);
+ 
+ typedef struct {
+   const char *name;
+   int (*supported)(void);
+   qvortex_compress_fn compress;
+   void (*keccak_f1600)(uint64_t st[25]);
+   size_t lanes;                            /* messages per compress_multi call */
+   qvortex_compress_multi_fn compress_multi;
+   size_t keccak_lanes;                     /* states per keccak_f1600_multi call */
+   void (*keccak_f1600_multi)(uint64_t st[25][QVORTEX_MAX_LANES]);
+   void (*compress_wide)(uint64_t state[QVORTEX_WIDE_STATE_WORDS], const uint8_t sbox[256],
+                         const uint8_t *blocks, size_t nblocks);
+ } qvortex_backend;
+ 
+ static const qvortex_backend *qvortex_backend_get(void);
  
  /* ------------------------------------------------------------------------
     SHAKE-128 Implementation (Minimal)
     ------------------------------------------------------------------------ */
  
  static inline uint64_t rotl64(uint64_t x, unsigned n) {
-   return (x << n) | (x >> (64 - n));
+   return (x << n) | (x >> ((64 - n) & 63));  /* n == 0 must not shift by 64 */
+ }
+ 
+ static inline uint64_t rotr64(uint64_t x, unsigned n) {
+   return (x >> n) | (x << ((64 - n) & 63));
  }
  
  #if USE_NEON
@@ -129,139 +438,326 @@
  }
  
  #if USE_NEON
- /* NEON-optimized Keccak implementation */
+ /*
+  * Register-resident NEON Keccak: each of the 25 lanes stays in its own
+  * uint64x2_t for all 24 rounds, with no per-round extract/insert. Only the
+  * low half is used for a single permutation, which leaves the high half
+  * free to carry a second, independent state at no extra cost.
+  *
+  * The round is written once against four primitives so the same body
+  * serves plain NEON and the ARMv8.2 SHA3 instructions:
+  *   EOR3(a, b, c)   a ^ b ^ c
+  *   RAX1(a, b)      a ^ rotl(b, 1)
+  *   XAR(a, b, n)    rotr(a ^ b, n), n an immediate
+  *   BCAX(a, b, c)   a ^ (b & ~c)
+  *
+  * Rho+Pi is the keccak_pi/keccak_rho walk of keccak_f1600_scalar unrolled
+  * into (destination, source, rotation) form, so every rotate has an
+  * immediate count; it matches the scalar code exactly, including lane 1
+  * being used twice and lane 10 being dropped.
+  */
+ #define QVORTEX_KECCAK_NEON_ROUND(A, rc, EOR3, RAX1, XAR, BCAX) do {           \
+     uint64x2_t C0, C1, C2, C3, C4, D0, D1, D2, D3, D4, B[25];                \
+     C0 = EOR3(EOR3(A[0], A[5], A[10]), A[15], A[20]);                         \
+     C1 = EOR3(EOR3(A[1], A[6], A[11]), A[16], A[21]);                         \
+     C2 = EOR3(EOR3(A[2], A[7], A[12]), A[17], A[22]);                         \
+     C3 = EOR3(EOR3(A[3], A[8], A[13]), A[18], A[23]);                         \
+     C4 = EOR3(EOR3(A[4], A[9], A[14]), A[19], A[24]);                         \
+     D0 = RAX1(C4, C1);                                                        \
+     D1 = RAX1(C0, C2);                                                        \
+     D2 = RAX1(C1, C3);                                                        \
+     D3 = RAX1(C2, C4);                                                        \
+     D4 = RAX1(C3, C0);                                                        \
+     B[0]  = veorq_u64(A[0], D0);                                              \
+     B[1]  = XAR(A[1],  D1, 63);  B[2]  = XAR(A[20], D0, 36);                  \
+     B[3]  = XAR(A[5],  D0, 2);   B[4]  = XAR(A[15], D0, 37);                  \
+     B[5]  = XAR(A[16], D1, 21);  B[6]  = XAR(A[1],  D1, 61);                  \
+     B[7]  = XAR(A[11], D1, 44);  B[8]  = XAR(A[21], D1, 56);                  \
+     B[9]  = XAR(A[6],  D1, 58);  B[10] = XAR(A[7],  D2, 20);                  \
+     B[11] = XAR(A[17], D2, 3);   B[12] = XAR(A[2],  D2, 28);                  \
+     B[13] = XAR(A[12], D2, 19);  B[14] = XAR(A[22], D2, 49);                  \
+     B[15] = XAR(A[23], D3, 50);  B[16] = XAR(A[8],  D3, 39);                  \
+     B[17] = XAR(A[18], D3, 25);  B[18] = XAR(A[3],  D3, 46);                  \
+     B[19] = XAR(A[13], D3, 9);   B[20] = XAR(A[14], D4, 43);                  \
+     B[21] = XAR(A[24], D4, 8);   B[22] = XAR(A[9],  D4, 54);                  \
+     B[23] = XAR(A[19], D4, 62);  B[24] = XAR(A[4],  D4, 23);                  \
+     for (int y = 0; y < 25; y += 5) {                                         \
+       A[y + 0] = BCAX(B[y + 0], B[y + 2], B[y + 1]);                          \
+       A[y + 1] = BCAX(B[y + 1], B[y + 3], B[y + 2]);                          \
+       A[y + 2] = BCAX(B[y + 2], B[y + 4], B[y + 3]);                          \
+       A[y + 3] = BCAX(B[y + 3], B[y + 0], B[y + 4]);                          \
+       A[y + 4] = BCAX(B[y + 4], B[y + 1], B[y + 0]);                          \
+     }                                                                         \
+     A[0] = veorq_u64(A[0], (rc));                                             \
+   } while (0)
+ 
+ #define QVORTEX_NEON_EOR3(a, b, c) veorq_u64(veorq_u64((a), (b)), (c))
+ #define QVORTEX_NEON_RAX1(a, b) \
+   veorq_u64((a), vsriq_n_u64(vshlq_n_u64((b), 1), (b), 63))
+ #define QVORTEX_NEON_XAR(a, b, n) \
+   vsriq_n_u64(vshlq_n_u64(veorq_u64((a), (b)), 64 - (n)), veorq_u64((a), (b)), (n))
+ #define QVORTEX_NEON_BCAX(a, b, c) veorq_u64((a), vbicq_u64((b), (c)))
+ 
+ /* Permute two independent states held in the low and high halves of A */
+ static inline void keccak_f1600_neon_x2(uint64x2_t A[25]) {
+   for (int round = 0; round < 24; round++) {
+     QVORTEX_KECCAK_NEON_ROUND(A, vdupq_n_u64(KECCAK_RC[round]), QVORTEX_NEON_EOR3,
+                               QVORTEX_NEON_RAX1, QVORTEX_NEON_XAR, QVORTEX_NEON_BCAX);
+   }
+ }
+ 
  static void keccak_f1600_neon(uint64_t st[25]) {
-   /* Helper macros for NEON registers */
-   #define GET_LANE(reg, idx) (vgetq_lane_u64((reg), (idx)))
-   #define SET_LANE(reg, idx, val) do { (reg) = vsetq_lane_u64((val), (reg), (idx)); } while (0)
- 
-   /* Map 25 lanes to 13 NEON registers */
-   uint64x2_t r0 = vld1q_u64(&st[0]);
-   uint64x2_t r1 = vld1q_u64(&st[2]);
-   uint64x2_t r2 = vld1q_u64(&st[4]);
-   uint64x2_t r3 = vld1q_u64(&st[6]);
-   uint64x2_t r4 = vld1q_u64(&st[8]);
-   uint64x2_t r5 = vld1q_u64(&st[10]);
-   uint64x2_t r6 = vld1q_u64(&st[12]);
-   uint64x2_t r7 = vld1q_u64(&st[14]);
-   uint64x2_t r8 = vld1q_u64(&st[16]);
-   uint64x2_t r9 = vld1q_u64(&st[18]);
-   uint64x2_t r10 = vld1q_u64(&st[20]);
-   uint64x2_t r11 = vld1q_u64(&st[22]);
-   
-   /* Handle the last element separately */
-   uint64_t lane24 = st[24];
-   uint64x2_t r12 = vcombine_u64(vcreate_u64(lane24), vdup_n_u64(0ULL));
+   uint64x2_t A[25];
+   for (int i = 0; i < 25; i++) A[i] = vdupq_n_u64(st[i]);
+   keccak_f1600_neon_x2(A);
+   for (int i = 0; i < 25; i++) st[i] = vgetq_lane_u64(A[i], 0);
+ }
  
-   static const uint8_t keccak_rho[24] = {1, 3, 6, 10, 15, 21, 28, 36,
-                                          45, 55, 2, 14, 27, 41, 56, 8,
-                                          25, 43, 62, 18, 39, 61, 20, 44};
-   static const uint8_t keccak_pi[24] = {1, 6, 9, 22, 14, 20, 2, 12,
-                                         13, 19, 23, 15, 4, 24, 21, 8,
-                                         16, 5, 3, 18, 17, 11, 7, 10};
+ #if USE_NEON_SHA3
+ /* FEAT_SHA3 fuses each primitive into one instruction */
+ #define QVORTEX_SHA3_EOR3(a, b, c) veor3q_u64((a), (b), (c))
+ #define QVORTEX_SHA3_RAX1(a, b) vrax1q_u64((a), (b))
+ #define QVORTEX_SHA3_XAR(a, b, n) vxarq_u64((a), (b), (n))
+ #define QVORTEX_SHA3_BCAX(a, b, c) vbcaxq_u64((a), (b), (c))
  
+ QVORTEX_TARGET_SHA3
+ static inline void keccak_f1600_sha3_x2(uint64x2_t A[25]) {
    for (int round = 0; round < 24; round++) {
-     /* Extract all 25 lanes as 64-bit variables */
-     uint64_t v[25];
-     v[0] = GET_LANE(r0, 0);   v[1] = GET_LANE(r0, 1);
-     v[2] = GET_LANE(r1, 0);   v[3] = GET_LANE(r1, 1);
-     v[4] = GET_LANE(r2, 0);   v[5] = GET_LANE(r2, 1);
-     v[6] = GET_LANE(r3, 0);   v[7] = GET_LANE(r3, 1);
-     v[8] = GET_LANE(r4, 0);   v[9] = GET_LANE(r4, 1);
-     v[10] = GET_LANE(r5, 0);  v[11] = GET_LANE(r5, 1);
-     v[12] = GET_LANE(r6, 0);  v[13] = GET_LANE(r6, 1);
-     v[14] = GET_LANE(r7, 0);  v[15] = GET_LANE(r7, 1);
-     v[16] = GET_LANE(r8, 0);  v[17] = GET_LANE(r8, 1);
-     v[18] = GET_LANE(r9, 0);  v[19] = GET_LANE(r9, 1);
-     v[20] = GET_LANE(r10, 0); v[21] = GET_LANE(r10, 1);
-     v[22] = GET_LANE(r11, 0); v[23] = GET_LANE(r11, 1);
-     v[24] = GET_LANE(r12, 0);
- 
-     /* Theta step */
-     uint64_t bc[5];
-     for (int i = 0; i < 5; i++) {
-       bc[i] = v[i + 0] ^ v[i + 5] ^ v[i + 10] ^ v[i + 15] ^ v[i + 20];
+     QVORTEX_KECCAK_NEON_ROUND(A, vdupq_n_u64(KECCAK_RC[round]), QVORTEX_SHA3_EOR3,
+                               QVORTEX_SHA3_RAX1, QVORTEX_SHA3_XAR, QVORTEX_SHA3_BCAX);
+   }
+ }
+ 
+ QVORTEX_TARGET_SHA3
+ static void keccak_f1600_sha3(uint64_t st[25]) {
+   uint64x2_t A[25];
+   for (int i = 0; i < 25; i++) A[i] = vdupq_n_u64(st[i]);
+   keccak_f1600_sha3_x2(A);
+   for (int i = 0; i < 25; i++) st[i] = vgetq_lane_u64(A[i], 0);
+ }
+ #endif /* USE_NEON_SHA3 */
+ #endif /* USE_NEON */
+ 
+ #if USE_AVX512
+ /*
+  * AVX-512 Keccak: one 5-lane row per zmm register (lanes 5..7 unused).
+  *
+  * Rho+Pi is done as a gather: lane X of output row Y takes whichever lane
+  * the keccak_pi/keccak_rho walk in keccak_f1600_scalar moves into position
+  * X + 5Y, assembled from rows 0/1 and 2/3 with two-source permutes plus a
+  * single-source permute of row 4, then rotated by that position's rho.
+  * The walk reads lane 1 twice and never reads lane 10; the tables below
+  * reproduce that exactly so digests stay bit-identical.
+  */
+ QVORTEX_TARGET_AVX512
+ static void keccak_f1600_avx512(uint64_t st[25]) {
+   static const uint64_t PI_IDX01[5][8] = {
+     {0, 1, 0, 8, 0}, {0, 1, 0, 0, 9}, {10, 0, 2, 0, 0}, {0, 11, 0, 3, 0}, {0, 0, 12, 0, 4}
+   };
+   static const uint64_t PI_IDX23[5][8] = {
+     {0, 0, 0, 0, 8}, {9, 0, 1, 0, 0}, {0, 10, 0, 2, 0}, {0, 0, 11, 0, 3}, {4, 0, 0, 12, 0}
+   };
+   static const uint64_t PI_IDX4[5][8] = {
+     {0, 0, 0, 0, 0}, {0, 0, 0, 1, 0}, {0, 0, 0, 0, 2}, {3, 0, 0, 0, 0}, {0, 4, 0, 0, 0}
+   };
+   static const __mmask8 PI_MASK23[5] = {0x10, 0x05, 0x0A, 0x14, 0x09};
+   static const __mmask8 PI_MASK4[5] = {0x04, 0x08, 0x10, 0x01, 0x02};
+   static const uint64_t PI_ROT[5][8] = {
+     {0, 1, 28, 62, 27}, {43, 3, 20, 8, 6}, {44, 61, 36, 45, 15},
+     {14, 25, 39, 18, 55}, {21, 56, 10, 2, 41}
+   };
+   const __mmask8 row_mask = 0x1F;
+   const __m512i next1 = _mm512_setr_epi64(1, 2, 3, 4, 0, 5, 6, 7);
+   const __m512i next2 = _mm512_setr_epi64(2, 3, 4, 0, 1, 5, 6, 7);
+   const __m512i prev1 = _mm512_setr_epi64(4, 0, 1, 2, 3, 5, 6, 7);
+   __m512i r[5], b[5];
+   int y;
+ 
+   for (y = 0; y < 5; y++) {
+     r[y] = _mm512_maskz_loadu_epi64(row_mask, &st[5 * y]);
+   }
+ 
+   for (int round = 0; round < 24; round++) {
+     /* Theta */
+     __m512i c = _mm512_ternarylogic_epi64(r[0], r[1], r[2], 0x96);
+     c = _mm512_ternarylogic_epi64(c, r[3], r[4], 0x96);
+     __m512i d = _mm512_xor_si512(_mm512_permutexvar_epi64(prev1, c),
+                                  _mm512_rol_epi64(_mm512_permutexvar_epi64(next1, c), 1));
+     for (y = 0; y < 5; y++) {
+       r[y] = _mm512_xor_si512(r[y], d);
      }
-     for (int i = 0; i < 5; i++) {
-       uint64_t t = ((bc[(i + 1) % 5] << 1) | (bc[(i + 1) % 5] >> 63)) ^ bc[(i + 4) % 5];
-       v[i + 0] ^= t;
-       v[i + 5] ^= t;
-       v[i + 10] ^= t;
-       v[i + 15] ^= t;
-       v[i + 20] ^= t;
+ 
+     /* Rho + Pi */
+     for (y = 0; y < 5; y++) {
+       __m512i lo = _mm512_permutex2var_epi64(r[0], _mm512_loadu_si512(PI_IDX01[y]), r[1]);
+       __m512i hi = _mm512_permutex2var_epi64(r[2], _mm512_loadu_si512(PI_IDX23[y]), r[3]);
+       __m512i t = _mm512_mask_blend_epi64(PI_MASK23[y], lo, hi);
+       t = _mm512_mask_permutexvar_epi64(t, PI_MASK4[y], _mm512_loadu_si512(PI_IDX4[y]), r[4]);
+       b[y] = _mm512_rolv_epi64(t, _mm512_loadu_si512(PI_ROT[y]));
      }
  
-     /* Rho and Pi steps */
-     {
-       uint64_t t = v[1];
-       for (int i = 0; i < 24; i++) {
-         int j = keccak_pi[i];
-         uint64_t temp = v[j];
-         uint8_t r = keccak_rho[i];
-         uint64_t rot = (t << r) | (t >> (64 - r));
-         v[j] = rot;
-         t = temp;
-       }
+     /* Chi: a ^ (~a[x+1] & a[x+2]) */
+     for (y = 0; y < 5; y++) {
+       r[y] = _mm512_ternarylogic_epi64(b[y], _mm512_permutexvar_epi64(next1, b[y]),
+                                        _mm512_permutexvar_epi64(next2, b[y]), 0xD2);
      }
  
-     /* Chi step */
-     for (int j = 0; j < 25; j += 5) {
-       uint64_t a0 = v[j + 0], a1 = v[j + 1];
-       uint64_t a2 = v[j + 2], a3 = v[j + 3];
-       uint64_t a4 = v[j + 4];
-       v[j + 0] ^= (~a1) & a2;
-       v[j + 1] ^= (~a2) & a3;
-       v[j + 2] ^= (~a3) & a4;
-       v[j + 3] ^= (~a4) & a0;
-       v[j + 4] ^= (~a0) & a1;
-     }
- 
-     /* Iota step */
-     v[0] ^= KECCAK_RC[round];
- 
-     /* Store values back to NEON registers */
-     SET_LANE(r0, 0, v[0]);   SET_LANE(r0, 1, v[1]);
-     SET_LANE(r1, 0, v[2]);   SET_LANE(r1, 1, v[3]);
-     SET_LANE(r2, 0, v[4]);   SET_LANE(r2, 1, v[5]);
-     SET_LANE(r3, 0, v[6]);   SET_LANE(r3, 1, v[7]);
-     SET_LANE(r4, 0, v[8]);   SET_LANE(r4, 1, v[9]);
-     SET_LANE(r5, 0, v[10]);  SET_LANE(r5, 1, v[11]);
-     SET_LANE(r6, 0, v[12]);  SET_LANE(r6, 1, v[13]);
-     SET_LANE(r7, 0, v[14]);  SET_LANE(r7, 1, v[15]);
-     SET_LANE(r8, 0, v[16]);  SET_LANE(r8, 1, v[17]);
-     SET_LANE(r9, 0, v[18]);  SET_LANE(r9, 1, v[19]);
-     SET_LANE(r10, 0, v[20]); SET_LANE(r10, 1, v[21]);
-     SET_LANE(r11, 0, v[22]); SET_LANE(r11, 1, v[23]);
-     SET_LANE(r12, 0, v[24]);
-   }
- 
-   /* Store back to state array */
-   vst1q_u64(&st[0], r0);
-   vst1q_u64(&st[2], r1);
-   vst1q_u64(&st[4], r2);
-   vst1q_u64(&st[6], r3);
-   vst1q_u64(&st[8], r4);
-   vst1q_u64(&st[10], r5);
-   vst1q_u64(&st[12], r6);
-   vst1q_u64(&st[14], r7);
-   vst1q_u64(&st[16], r8);
-   vst1q_u64(&st[18], r9);
-   vst1q_u64(&st[20], r10);
-   vst1q_u64(&st[22], r11);
-   st[24] = GET_LANE(r12, 0);
-   
-   #undef GET_LANE
-   #undef SET_LANE
+     /* Iota */
+     r[0] = _mm512_mask_xor_epi64(r[0], 1, r[0], _mm512_set1_epi64((long long)KECCAK_RC[round]));
+   }
+ 
+   for (y = 0; y < 5; y++) {
+     _mm512_mask_storeu_epi64(&st[5 * y], row_mask, r[y]);
+   }
  }
- #endif /* USE_NEON */
+ #endif /* USE_AVX512 */
  
- /* Use optimized implementation if available */
- static void keccak_f1600(uint64_t st[25]) {
- #if USE_NEON
-   keccak_f1600_neon(st);
+ /* ------------------------------------------------------------------------
+    Multi-Lane Keccak
+    ------------------------------------------------------------------------ */
+ 
+ /*
+  * Permute several independent Keccak states at once for batched key
+  * schedules. States are lane-sliced like compress_multi: st[i][lane] is
+  * Keccak lane i of that state. Each backend permutes its keccak_lanes
+  * states per call and leaves the rest of the array untouched.
+  */
+ 
+ /* Rho+Pi of keccak_f1600_scalar in gather form: B[i] = rotl(A[src], rot) */
+ static const uint8_t KECCAK_GATHER_SRC[25] = {
+   0, 1, 20, 5, 15, 16, 1, 11, 21, 6, 7, 17, 2, 12, 22, 23, 8, 18, 3, 13, 14, 24, 9, 19, 4
+ };
+ static const uint8_t KECCAK_GATHER_ROT[25] = {
+   0, 1, 28, 62, 27, 43, 3, 20, 8, 6, 44, 61, 36, 45, 15, 14, 25, 39, 18, 55, 21, 56, 10, 2, 41
+ };
+ 
+ #if defined(__clang__)
+ #define QVORTEX_UNROLL_25 _Pragma("unroll 25")
+ #elif defined(__GNUC__) && __GNUC__ >= 8
+ #define QVORTEX_UNROLL_25 _Pragma("GCC unroll 25")
  #else
-   keccak_f1600_scalar(st);
+ #define QVORTEX_UNROLL_25
+ #endif
+ 
+ static void keccak_f1600_multi_scalar(uint64_t st[25][QVORTEX_MAX_LANES]) {
+   uint64_t lane[25];
+   for (int i = 0; i < 25; i++) lane[i] = st[i][0];
+   keccak_f1600_scalar(lane);
+   for (int i = 0; i < 25; i++) st[i][0] = lane[i];
+ }
+ 
+ #if USE_NEON
+ /* The x2 kernels already take one state per 64-bit half */
+ static void keccak_f1600_multi_neon(uint64_t st[25][QVORTEX_MAX_LANES]) {
+   uint64x2_t A[25];
+   for (int i = 0; i < 25; i++) A[i] = vld1q_u64(st[i]);
+   keccak_f1600_neon_x2(A);
+   for (int i = 0; i < 25; i++) vst1q_u64(st[i], A[i]);
+ }
+ 
+ #if USE_NEON_SHA3
+ QVORTEX_TARGET_SHA3
+ static void keccak_f1600_multi_sha3(uint64_t st[25][QVORTEX_MAX_LANES]) {
+   uint64x2_t A[25];
+   for (int i = 0; i < 25; i++) A[i] = vld1q_u64(st[i]);
+   keccak_f1600_sha3_x2(A);
+   for (int i = 0; i < 25; i++) vst1q_u64(st[i], A[i]);
+ }
  #endif
+ #endif /* USE_NEON */
+ 
+ #if USE_AVX2
+ QVORTEX_TARGET_AVX2
+ static inline __m256i qvortex_keccak_rotl_256(__m256i x, int n) {
+   /* Out-of-range shift counts give 0, so n == 0 needs no special case */
+   return _mm256_or_si256(_mm256_slli_epi64(x, n), _mm256_srli_epi64(x, 64 - n));
+ }
+ 
+ QVORTEX_TARGET_AVX2
+ static void keccak_f1600_multi_avx2(uint64_t st[25][QVORTEX_MAX_LANES]) {
+   __m256i A[25], B[25], C[5], D[5];
+   int i, x, y;
+ 
+   for (i = 0; i < 25; i++) A[i] = _mm256_loadu_si256((const __m256i *)st[i]);
+ 
+   for (int round = 0; round < 24; round++) {
+     /* Theta */
+     for (x = 0; x < 5; x++) {
+       C[x] = _mm256_xor_si256(_mm256_xor_si256(A[x], A[x + 5]),
+                               _mm256_xor_si256(A[x + 10], _mm256_xor_si256(A[x + 15], A[x + 20])));
+     }
+     for (x = 0; x < 5; x++) {
+       D[x] = _mm256_xor_si256(C[(x + 4) % 5], qvortex_keccak_rotl_256(C[(x + 1) % 5], 1));
+     }
+ 
+     /* Rho + Pi, unrolled so A and B stay in registers */
+     QVORTEX_UNROLL_25
+     for (i = 0; i < 25; i++) {
+       int src = KECCAK_GATHER_SRC[i];
+       B[i] = qvortex_keccak_rotl_256(_mm256_xor_si256(A[src], D[src % 5]), KECCAK_GATHER_ROT[i]);
+     }
+ 
+     /* Chi */
+     for (y = 0; y < 25; y += 5) {
+       for (x = 0; x < 5; x++) {
+         A[y + x] = _mm256_xor_si256(B[y + x], _mm256_andnot_si256(B[y + (x + 1) % 5],
+                                                                   B[y + (x + 2) % 5]));
+       }
+     }
+ 
+     /* Iota */
+     A[0] = _mm256_xor_si256(A[0], _mm256_set1_epi64x((long long)KECCAK_RC[round]));
+   }
+ 
+   for (i = 0; i < 25; i++) _mm256_storeu_si256((__m256i *)st[i], A[i]);
+ }
+ #endif /* USE_AVX2 */
+ 
+ #if USE_AVX512
+ QVORTEX_TARGET_AVX512
+ static void keccak_f1600_multi_avx512(uint64_t st[25][QVORTEX_MAX_LANES]) {
+   __m512i A[25], B[25], C[5], D[5];
+   int i, x, y;
+ 
+   for (i = 0; i < 25; i++) A[i] = _mm512_loadu_si512(st[i]);
+ 
+   for (int round = 0; round < 24; round++) {
+     /* Theta */
+     for (x = 0; x < 5; x++) {
+       C[x] = _mm512_ternarylogic_epi64(A[x], A[x + 5], A[x + 10], 0x96);
+       C[x] = _mm512_ternarylogic_epi64(C[x], A[x + 15], A[x + 20], 0x96);
+     }
+     for (x = 0; x < 5; x++) {
+       D[x] = _mm512_xor_si512(C[(x + 4) % 5], _mm512_rol_epi64(C[(x + 1) % 5], 1));
+     }
+ 
+     /* Rho + Pi, unrolled so A and B stay in registers */
+     QVORTEX_UNROLL_25
+     for (i = 0; i < 25; i++) {
+       int src = KECCAK_GATHER_SRC[i];
+       B[i] = _mm512_rolv_epi64(_mm512_xor_si512(A[src], D[src % 5]),
+                                _mm512_set1_epi64(KECCAK_GATHER_ROT[i]));
+     }
+ 
+     /* Chi: a ^ (~b & c) */
+     for (y = 0; y < 25; y += 5) {
+       for (x = 0; x < 5; x++) {
+         A[y + x] = _mm512_ternarylogic_epi64(B[y + x], B[y + (x + 1) % 5],
+                                              B[y + (x + 2) % 5], 0xD2);
+       }
+     }
+ 
+     /* Iota */
+     A[0] = _mm512_xor_si512(A[0], _mm512_set1_epi64((long long)KECCAK_RC[round]));
+   }
+ 
+   for (i = 0; i < 25; i++) _mm512_storeu_si512(st[i], A[i]);
+ }
+ #endif /* USE_AVX512 */
+ 
+ /* Use the implementation of the selected backend */
+ static inline void keccak_f1600(uint64_t st[25]) {
+   qvortex_backend_get()->keccak_f1600(st);
  }
  
  typedef struct {
@@ -274,10 +770,27 @@
    ctx->rate_used = 0;
  }
  
+ /* XOR one full rate block into the state, a 64-bit lane at a time */
+ static inline void shake128_absorb_block(uint64_t st[25], const uint8_t *in) {
+   for (int i = 0; i < 21; i++) {
+     uint64_t w;
+     memcpy(&w, in + 8 * i, 8);
+     st[i] ^= w;
+   }
+ }
+ 
  static inline void shake128_absorb(shake128_ctx *ctx, const uint8_t *in, size_t inlen) {
    const int rate = 168;  /* SHAKE-128 rate in bytes */
    uint8_t *st_bytes = (uint8_t *)ctx->state;
    
+   /* Whole blocks at a block boundary skip the byte loop */
+   if (ctx->rate_used == 0) {
+     for (; inlen >= (size_t)rate; in += rate, inlen -= rate) {
+       shake128_absorb_block(ctx->state, in);
+       keccak_f1600(ctx->state);
+     }
+   }
+ 
    while (inlen > 0) {
      int can_absorb = rate - ctx->rate_used;
      int to_absorb = (inlen < (size_t)can_absorb) ? (int)inlen : can_absorb;
@@ -293,6 +806,11 @@
      if (ctx->rate_used == rate) {
        keccak_f1600(ctx->state);
        ctx->rate_used = 0;
+       /* Back on a boundary: take the remaining whole blocks word-wise */
+       for (; inlen >= (size_t)rate; in += rate, inlen -= rate) {
+         shake128_absorb_block(ctx->state, in);
+         keccak_f1600(ctx->state);
+       }
      }
    }
  }
@@ -311,6 +829,14 @@
    
    while (outlen > 0) {
      if (ctx->rate_used == rate) {
+       /* Whole blocks go straight from the state to the output */
+       while (outlen >= (size_t)rate) {
+         keccak_f1600(ctx->state);
+         memcpy(out, st_bytes, rate);
+         out += rate;
+         outlen -= rate;
+       }
+       if (outlen == 0) break;
        keccak_f1600(ctx->state);
        ctx->rate_used = 0;
      }
@@ -326,6 +852,7 @@
  }
  
  static inline void shake128(const uint8_t *in, size_t inlen, uint8_t *out, size_t outlen) {
+   QVORTEX_STAT_ADD(shake128_calls, 1);
    shake128_ctx ctx;
    shake128_init(&ctx);
    shake128_absorb(&ctx, in, inlen);
@@ -333,6 +860,21 @@
    shake128_squeeze(&ctx, out, outlen);
  }
  
+ /*
+  * Public incremental XOF: the sponge plus which phase it is in.
+  *
+  * NOT FIPS 202 SHAKE128. The qvortex_shake128* functions use the same
+  * rate, padding and domain byte, but Qvortex's Keccak-f[1600] has its own
+  * pi step, so every output differs from standard SHAKE128 (the empty
+  * input gives 665d6a34..., not 7f9c2ba4...) and will not interoperate
+  * with OpenSSL, hashlib or any other implementation. Use it only for
+  * derivations that stay within Qvortex.
+  */
+ typedef struct {
+   shake128_ctx sponge;
+   int squeezing;
+ } qvortex_shake128_ctx;
+ 
  /* ------------------------------------------------------------------------
     Qvortex Hash Implementation
     ------------------------------------------------------------------------ */
@@ -345,6 +887,21 @@
    uint64_t total_len;
  } qvortex_lite_ctx;
  
+ /* Pre-keyed template: the IV and keyed S-box, derived once per key */
+ typedef struct {
+   uint64_t state[QVORTEX_LITE_STATE_WORDS];
+   uint8_t sbox[256];
+ } qvortex_template;
+ 
+ /* Wide (Qvortex-1024) streaming context; keyed by the same templates */
+ typedef struct {
+   uint64_t state[QVORTEX_WIDE_STATE_WORDS];
+   uint8_t sbox[256];
+   uint8_t buffer[QVORTEX_WIDE_BLOCK_BYTES];
+   size_t buffer_len;
+   uint64_t total_len;
+ } qvortex_wide_ctx;
+ 
  #if USE_NEON
  static inline void qvortex_lite_mix_neon(uint64x2_t *v0, uint64x2_t *v1, 
                                          uint64x2_t *v2, uint64x2_t *v3) {
@@ -366,288 +923,5900 @@
    *v1 = veorq_u64(*v1, *v2);
    *v1 = vorrq_u64(vshlq_n_u64(*v1, 64 - QL_R4), vshrq_n_u64(*v1, QL_R4));
  }
- #else
+ #endif
+ 
+ #if USE_AVX2
+ /*
+  * x86 mirror of qvortex_lite_mix_neon: the same four 2-lane vectors, held
+  * in xmm registers. The ARX chain v0 -> v3 -> v2 -> v1 is serial, so wider
+  * registers would not add parallelism for a single message.
+  */
+ QVORTEX_TARGET_AVX2
+ static inline __m128i qvortex_rotr_128(__m128i x, int n) {
+   switch (n) {
+   case 32: return _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+   case 24: return _mm_shuffle_epi8(x, _mm_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2,
+                                                     11, 12, 13, 14, 15, 8, 9, 10));
+   case 16: return _mm_shuffle_epi8(x, _mm_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1,
+                                                     10, 11, 12, 13, 14, 15, 8, 9));
+   case 63: return _mm_or_si128(_mm_add_epi64(x, x), _mm_srli_epi64(x, 63));
+   default: return _mm_or_si128(_mm_srli_epi64(x, n), _mm_slli_epi64(x, 64 - n));
+   }
+ }
+ 
+ QVORTEX_TARGET_AVX2
+ static inline void qvortex_lite_mix_avx2(__m128i *v0, __m128i *v1,
+                                         __m128i *v2, __m128i *v3) {
+   /* Round 1 (Diagonal) */
+   *v0 = _mm_add_epi64(*v0, *v1);
+   *v3 = qvortex_rotr_128(_mm_xor_si128(*v3, *v0), QL_R1);
+ 
+   *v2 = _mm_add_epi64(*v2, *v3);
+   *v1 = qvortex_rotr_128(_mm_xor_si128(*v1, *v2), QL_R2);
+ 
+   /* Round 2 (Diagonal, different shift) */
+   *v0 = _mm_add_epi64(*v0, *v1);
+   *v3 = qvortex_rotr_128(_mm_xor_si128(*v3, *v0), QL_R3);
+ 
+   *v2 = _mm_add_epi64(*v2, *v3);
+   *v1 = qvortex_rotr_128(_mm_xor_si128(*v1, *v2), QL_R4);
+ }
+ #endif
+ 
+ #if USE_AVX512
+ /* Same as qvortex_lite_mix_avx2 with native vprorq rotates */
+ QVORTEX_TARGET_AVX512
+ static inline void qvortex_lite_mix_avx512(__m128i *v0, __m128i *v1,
+                                           __m128i *v2, __m128i *v3) {
+   /* Round 1 (Diagonal) */
+   *v0 = _mm_add_epi64(*v0, *v1);
+   *v3 = _mm_ror_epi64(_mm_xor_si128(*v3, *v0), QL_R1);
+ 
+   *v2 = _mm_add_epi64(*v2, *v3);
+   *v1 = _mm_ror_epi64(_mm_xor_si128(*v1, *v2), QL_R2);
+ 
+   /* Round 2 (Diagonal, different shift) */
+   *v0 = _mm_add_epi64(*v0, *v1);
+   *v3 = _mm_ror_epi64(_mm_xor_si128(*v3, *v0), QL_R3);
+ 
+   *v2 = _mm_add_epi64(*v2, *v3);
+   *v1 = _mm_ror_epi64(_mm_xor_si128(*v1, *v2), QL_R4);
+ }
+ #endif
+ 
+ /*
+  * Portable version of qvortex_lite_mix_neon for one lane: a, b, c, d index
+  * the words that sit in lane (a & 1) of v0, v1, v2 and v3.
+  */
  static inline void qvortex_lite_mix_scalar(uint64_t *s, int a, int b, int c, int d) {
    s[a] = s[a] + s[b];
-   s[d] = rotl64(s[d] ^ s[a], QL_R1);
+   s[d] = rotr64(s[d] ^ s[a], QL_R1);
    s[c] = s[c] + s[d];
-   s[b] = rotl64(s[b] ^ s[c], QL_R2);
+   s[b] = rotr64(s[b] ^ s[c], QL_R2);
    s[a] = s[a] + s[b];
-   s[d] = rotl64(s[d] ^ s[a], QL_R3);
+   s[d] = rotr64(s[d] ^ s[a], QL_R3);
    s[c] = s[c] + s[d];
-   s[b] = rotl64(s[b] ^ s[c], QL_R4);
+   s[b] = rotr64(s[b] ^ s[c], QL_R4);
  }
- #endif
- 
- static inline void qvortex_lite_process_block(qvortex_lite_ctx *ctx, 
-                                              const uint8_t block[QVORTEX_LITE_BLOCK_BYTES]) {
-   uint64_t m[QVORTEX_LITE_STATE_WORDS];
-   uint8_t temp_block[QVORTEX_LITE_BLOCK_BYTES];
-   int i;
  
-   /* Substitution step */
-   for (i = 0; i < QVORTEX_LITE_BLOCK_BYTES; i++) {
-     temp_block[i] = ctx->sbox[block[i]];
+ /* Substitution step: S-box the block and load it as little-endian words */
+ static inline void qvortex_lite_load_block(uint64_t m[QVORTEX_LITE_STATE_WORDS],
+                                           const uint8_t sbox[256],
+                                           const uint8_t block[QVORTEX_LITE_BLOCK_BYTES]) {
+   /* Substitute straight into the message words (native byte order) */
+   uint8_t *mb = (uint8_t *)m;
+   for (int i = 0; i < QVORTEX_LITE_BLOCK_BYTES; i++) {
+     mb[i] = sbox[block[i]];
    }
-   
-   /* Load substituted block into message words (little-endian) */
-   for (i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
-     memcpy(&m[i], &temp_block[i * 8], 8);
+ }
+ 
+ #if USE_NEON
+ /* The 256-byte S-box as four 64-byte vqtbl4q tables */
+ static inline void qvortex_sbox_load_neon(uint8x16x4_t tbl[4], const uint8_t sbox[256]) {
+   for (int t = 0; t < 4; t++) tbl[t] = vld1q_u8_x4(&sbox[64 * t]);
+ }
+ 
+ /*
+  * Substitute 16 bytes. vqtbx4q leaves a byte alone when its index is out
+  * of range, so after rebasing the indices by 64 for each table only the
+  * bytes belonging to that quarter of the S-box are replaced.
+  */
+ static inline uint8x16_t qvortex_sbox_neon(const uint8x16x4_t tbl[4], uint8x16_t x) {
+   const uint8x16_t k64 = vdupq_n_u8(64);
+   uint8x16_t r = vqtbl4q_u8(tbl[0], x);
+   x = vsubq_u8(x, k64);
+   r = vqtbx4q_u8(r, tbl[1], x);
+   x = vsubq_u8(x, k64);
+   r = vqtbx4q_u8(r, tbl[2], x);
+   x = vsubq_u8(x, k64);
+   return vqtbx4q_u8(r, tbl[3], x);
+ }
+ 
+ /* S-box one block into the word pairs (m0,m1), (m2,m3), (m4,m5), (m6,m7) */
+ static inline void qvortex_lite_load_block_neon(uint64x2_t m[4], const uint8x16x4_t tbl[4],
+                                                const uint8_t block[QVORTEX_LITE_BLOCK_BYTES]) {
+   for (int i = 0; i < 4; i++) {
+     m[i] = vreinterpretq_u64_u8(qvortex_sbox_neon(tbl, vld1q_u8(block + 16 * i)));
    }
+ }
  
-   /* Input-Driven Rotation Mixer (working on a copy of state) */
-   uint64_t s_copy[QVORTEX_LITE_STATE_WORDS];
-   memcpy(s_copy, ctx->state, sizeof(s_copy));
+ /* Rotation mixer s ^ rotl(m, r): (m << r) | (m << (r - 64)), negative = right */
+ static inline uint64x2_t qvortex_lite_rotmix_neon(uint64x2_t s, uint64x2_t m) {
+   int64x2_t rot = vreinterpretq_s64_u64(vandq_u64(vshrq_n_u64(m, 56), vdupq_n_u64(63)));
+   uint64x2_t rotated = vorrq_u64(vshlq_u64(m, rot), vshlq_u64(m, vsubq_s64(rot, vdupq_n_s64(64))));
+   return veorq_u64(s, rotated);
+ }
+ #endif /* USE_NEON */
  
-   for (i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
-     uint8_t rot = (uint8_t)(m[i] >> 56) & 63;  /* Use high 6 bits of m[i] */
-     s_copy[i] ^= rotl64(m[i], rot);
+ #if USE_SVE
+ /*
+  * S-box any number of bytes with TBL, one vector of the table at a time:
+  * TBL yields zero for an index past the vector, so each segment fills in
+  * just the bytes that fall inside it (8 segments at 256 bits, 1 at 2048).
+  * The vector length must divide 256 bytes, which qvortex_cpu_has_sve checks:
+  * otherwise the last load runs past the table and x - k wraps into it.
+  */
+ QVORTEX_TARGET_SVE
+ static inline svuint8_t qvortex_sbox_sve(const uint8_t sbox[256], svuint8_t x) {
+   const svbool_t all = svptrue_b8();
+   svuint8_t r = svtbl_u8(svld1_u8(all, sbox), x);
+   for (uint64_t k = svcntb(); k < 256; k += svcntb()) {
+     r = svorr_u8_x(all, r, svtbl_u8(svld1_u8(all, sbox + k), svsub_n_u8_x(all, x, (uint8_t)k)));
    }
+   return r;
+ }
  
-   /* ARX Mixing Rounds */
- #if USE_NEON
-   /* Load state into NEON registers (4 pairs) */
-   uint64x2_t v0 = vld1q_u64(&s_copy[0]);
-   uint64x2_t v1 = vld1q_u64(&s_copy[2]);
-   uint64x2_t v2 = vld1q_u64(&s_copy[4]);
-   uint64x2_t v3 = vld1q_u64(&s_copy[6]);
+ /* rotr64(x ^ y, n); one XAR where SVE2 is enabled for the whole build */
+ QVORTEX_TARGET_SVE
+ static inline svuint64_t qvortex_xor_rotr_sve(svbool_t pg, svuint64_t x, svuint64_t y, int n) {
+ #if defined(__ARM_FEATURE_SVE2)
+   switch (n) {
+   case 32: return svxar_n_u64(x, y, 32);
+   case 24: return svxar_n_u64(x, y, 24);
+   case 16: return svxar_n_u64(x, y, 16);
+   case 63: return svxar_n_u64(x, y, 63);
+   default: break;
+   }
+ #endif
+   svuint64_t t = sveor_u64_x(pg, x, y);
+   if (n == 32) return svrevw_u64_x(pg, t);
+   return svorr_u64_x(pg, svlsr_n_u64_x(pg, t, (uint64_t)n), svlsl_n_u64_x(pg, t, (uint64_t)(64 - n)));
+ }
+ 
+ QVORTEX_TARGET_SVE
+ static inline void qvortex_lite_mix_sve(svbool_t pg, svuint64_t *a, svuint64_t *b,
+                                         svuint64_t *c, svuint64_t *d) {
+   *a = svadd_u64_x(pg, *a, *b);
+   *d = qvortex_xor_rotr_sve(pg, *d, *a, QL_R1);
+   *c = svadd_u64_x(pg, *c, *d);
+   *b = qvortex_xor_rotr_sve(pg, *b, *c, QL_R2);
+   *a = svadd_u64_x(pg, *a, *b);
+   *d = qvortex_xor_rotr_sve(pg, *d, *a, QL_R3);
+   *c = svadd_u64_x(pg, *c, *d);
+   *b = qvortex_xor_rotr_sve(pg, *b, *c, QL_R4);
+ }
+ 
+ /* h ^ rotl64(m, (m >> 56) & 63); LSR by 64 gives zero, so rot == 0 is exact */
+ QVORTEX_TARGET_SVE
+ static inline svuint64_t qvortex_lite_rotmix_sve(svbool_t pg, svuint64_t h, svuint64_t m) {
+   svuint64_t rot = svand_n_u64_x(pg, svlsr_n_u64_x(pg, m, 56), 63);
+   svuint64_t inv = svsubr_n_u64_x(pg, rot, 64);
+   return sveor_u64_x(pg, h, svorr_u64_x(pg, svlsl_u64_x(pg, m, rot), svlsr_u64_x(pg, m, inv)));
+ }
+ #endif /* USE_SVE */
+ 
+ #if USE_AVX512
+ /*
+  * AVX-512 VBMI S-box: vpermi2b looks up 64 bytes at once in one 128-byte
+  * half of the table, and the top bit of each index picks the half.
+  */
+ QVORTEX_TARGET_VBMI
+ static inline __m512i qvortex_sbox_vbmi(const __m512i tbl[4], __m512i x) {
+   __m512i lo = _mm512_permutex2var_epi8(tbl[0], x, tbl[1]);
+   __m512i hi = _mm512_permutex2var_epi8(tbl[2], x, tbl[3]);
+   return _mm512_mask_blend_epi8(_mm512_movepi8_mask(x), lo, hi);
+ }
+ 
+ QVORTEX_TARGET_VBMI
+ static inline void qvortex_sbox_load_vbmi(__m512i tbl[4], const uint8_t sbox[256]) {
+   for (int t = 0; t < 4; t++) tbl[t] = _mm512_loadu_si512(&sbox[64 * t]);
+ }
+ #endif /* USE_AVX512 */
+ 
+ /*
+  * The bulk kernels below keep the chaining state in locals (registers)
+  * for the whole span and store it once at the end: stores through the
+  * uint64_t pointer could alias the uint8_t input, so writing it back per
+  * block would force a reload on every iteration.
+  */
+ static void qvortex_compress_scalar(uint64_t state[QVORTEX_LITE_STATE_WORDS],
+                                     const uint8_t sbox[256],
+                                     const uint8_t *blocks, size_t nblocks) {
+   QVORTEX_STAT_ADD(blocks, nblocks);
+   uint64_t h[QVORTEX_LITE_STATE_WORDS];
+   memcpy(h, state, sizeof(h));
+ 
+   for (; nblocks > 0; nblocks--, blocks += QVORTEX_LITE_BLOCK_BYTES) {
+     uint64_t m[QVORTEX_LITE_STATE_WORDS];
+     int i;
+     QVORTEX_PREFETCH(blocks);
+     qvortex_lite_load_block(m, sbox, blocks);
+ 
+     /* Input-Driven Rotation Mixer (working on a copy of state) */
+     uint64_t s[QVORTEX_LITE_STATE_WORDS];
+     memcpy(s, h, sizeof(s));
+ 
+     for (i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
+       uint8_t rot = (uint8_t)(m[i] >> 56) & 63;  /* Use high 6 bits of m[i] */
+       s[i] ^= rotl64(m[i], rot);
+     }
+ 
+     /* Scalar ARX mixing, one NEON lane at a time */
+     for (int r = 0; r < QVORTEX_LITE_ROUNDS; r++) {
+       qvortex_lite_mix_scalar(s, 0, 2, 4, 6);
+       qvortex_lite_mix_scalar(s, 1, 3, 5, 7);
+ 
+       /* Rotate state left by one vector (two words) for next round */
+       uint64_t t0 = s[0], t1 = s[1];
+       memmove(&s[0], &s[2], 6 * sizeof(uint64_t));
+       s[6] = t0;
+       s[7] = t1;
+     }
+ 
+     /* Feed-forward: Add mixed state back to original state */
+     for (i = 0; i < QVORTEX_LITE_STATE_WORDS; ++i) {
+       h[i] ^= s[i];
+     }
+   }
+ 
+   memcpy(state, h, sizeof(h));
+ }
+ 
+ #if USE_NEON
+ static void qvortex_compress_neon(uint64_t state[QVORTEX_LITE_STATE_WORDS],
+                                   const uint8_t sbox[256],
+                                   const uint8_t *blocks, size_t nblocks) {
+   QVORTEX_STAT_ADD(blocks, nblocks);
+   uint8x16x4_t tbl[4];
+   qvortex_sbox_load_neon(tbl, sbox);
+   uint64x2_t h0 = vld1q_u64(&state[0]), h1 = vld1q_u64(&state[2]);
+   uint64x2_t h2 = vld1q_u64(&state[4]), h3 = vld1q_u64(&state[6]);
+ 
+   for (; nblocks > 0; nblocks--, blocks += QVORTEX_LITE_BLOCK_BYTES) {
+     uint64x2_t m[4];
+     QVORTEX_PREFETCH(blocks);
+     qvortex_lite_load_block_neon(m, tbl, blocks);
+ 
+     /* Input-Driven Rotation Mixer, straight into the 4 state pairs */
+     uint64x2_t v0 = qvortex_lite_rotmix_neon(h0, m[0]);
+     uint64x2_t v1 = qvortex_lite_rotmix_neon(h1, m[1]);
+     uint64x2_t v2 = qvortex_lite_rotmix_neon(h2, m[2]);
+     uint64x2_t v3 = qvortex_lite_rotmix_neon(h3, m[3]);
+ 
+     for (int r = 0; r < QVORTEX_LITE_ROUNDS; r++) {
+       qvortex_lite_mix_neon(&v0, &v1, &v2, &v3);
+ 
+       /* Simple permutation: rotate state vector */
+       uint64x2_t tmp = v0;
+       v0 = v1;
+       v1 = v2;
+       v2 = v3;
+       v3 = tmp;
+     }
+ 
+     /* Feed-forward: Add mixed state back to original state */
+     h0 = veorq_u64(h0, v0);
+     h1 = veorq_u64(h1, v1);
+     h2 = veorq_u64(h2, v2);
+     h3 = veorq_u64(h3, v3);
+   }
+ 
+   vst1q_u64(&state[0], h0);
+   vst1q_u64(&state[2], h1);
+   vst1q_u64(&state[4], h2);
+   vst1q_u64(&state[6], h3);
+ }
+ #endif /* USE_NEON */
+ 
+ #if USE_AVX2
+ QVORTEX_TARGET_AVX2
+ static void qvortex_compress_avx2(uint64_t state[QVORTEX_LITE_STATE_WORDS],
+                                   const uint8_t sbox[256],
+                                   const uint8_t *blocks, size_t nblocks) {
+   QVORTEX_STAT_ADD(blocks, nblocks);
+   const __m256i mask63 = _mm256_set1_epi64x(63);
+   const __m256i sixty4 = _mm256_set1_epi64x(64);
+   __m256i sw_lo = _mm256_loadu_si256((const __m256i *)&state[0]);
+   __m256i sw_hi = _mm256_loadu_si256((const __m256i *)&state[4]);
+ 
+   for (; nblocks > 0; nblocks--, blocks += QVORTEX_LITE_BLOCK_BYTES) {
+     uint64_t m[QVORTEX_LITE_STATE_WORDS];
+     QVORTEX_PREFETCH(blocks);
+     qvortex_lite_load_block(m, sbox, blocks);
+ 
+     /* Rotation mixer, four words per ymm (shift counts of 64 yield zero) */
+     __m256i mw_lo = _mm256_loadu_si256((const __m256i *)&m[0]);
+     __m256i mw_hi = _mm256_loadu_si256((const __m256i *)&m[4]);
+     __m256i rot_lo = _mm256_and_si256(_mm256_srli_epi64(mw_lo, 56), mask63);
+     __m256i rot_hi = _mm256_and_si256(_mm256_srli_epi64(mw_hi, 56), mask63);
+     __m256i mixed_lo = _mm256_xor_si256(sw_lo, _mm256_or_si256(
+         _mm256_sllv_epi64(mw_lo, rot_lo), _mm256_srlv_epi64(mw_lo, _mm256_sub_epi64(sixty4, rot_lo))));
+     __m256i mixed_hi = _mm256_xor_si256(sw_hi, _mm256_or_si256(
+         _mm256_sllv_epi64(mw_hi, rot_hi), _mm256_srlv_epi64(mw_hi, _mm256_sub_epi64(sixty4, rot_hi))));
+ 
+     __m128i v0 = _mm256_castsi256_si128(mixed_lo);
+     __m128i v1 = _mm256_extracti128_si256(mixed_lo, 1);
+     __m128i v2 = _mm256_castsi256_si128(mixed_hi);
+     __m128i v3 = _mm256_extracti128_si256(mixed_hi, 1);
+ 
+     for (int r = 0; r < QVORTEX_LITE_ROUNDS; r++) {
+       qvortex_lite_mix_avx2(&v0, &v1, &v2, &v3);
+ 
+       /* Simple permutation: rotate state vector */
+       __m128i tmp = v0;
+       v0 = v1;
+       v1 = v2;
+       v2 = v3;
+       v3 = tmp;
+     }
+ 
+     /* Feed-forward: Add mixed state back to original state */
+     sw_lo = _mm256_xor_si256(sw_lo, _mm256_set_m128i(v1, v0));
+     sw_hi = _mm256_xor_si256(sw_hi, _mm256_set_m128i(v3, v2));
+   }
+ 
+   _mm256_storeu_si256((__m256i *)&state[0], sw_lo);
+   _mm256_storeu_si256((__m256i *)&state[4], sw_hi);
+ }
+ #endif /* USE_AVX2 */
+ 
+ #if USE_AVX512
+ /*
+  * S-box a block without VBMI. The words are assembled in general registers
+  * and moved into the vector directly: byte stores to memory followed by
+  * a 64-byte load would stall on store forwarding every block.
+  */
+ QVORTEX_TARGET_AVX512
+ static inline __m512i qvortex_sbox_gather_avx512(const uint8_t sbox[256],
+                                                  const uint8_t block[QVORTEX_LITE_BLOCK_BYTES]) {
+   uint64_t w[QVORTEX_LITE_STATE_WORDS];
+   for (int i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
+     const uint8_t *b = block + 8 * i;
+     w[i] = (uint64_t)sbox[b[0]] | (uint64_t)sbox[b[1]] << 8 |
+            (uint64_t)sbox[b[2]] << 16 | (uint64_t)sbox[b[3]] << 24 |
+            (uint64_t)sbox[b[4]] << 32 | (uint64_t)sbox[b[5]] << 40 |
+            (uint64_t)sbox[b[6]] << 48 | (uint64_t)sbox[b[7]] << 56;
+   }
+   return _mm512_set_epi64((long long)w[7], (long long)w[6], (long long)w[5], (long long)w[4],
+                           (long long)w[3], (long long)w[2], (long long)w[1], (long long)w[0]);
+ }
+ 
+ /* One block whose substituted words are already in mw; returns the new state */
+ QVORTEX_TARGET_AVX512
+ static inline __m512i qvortex_lite_compress1_avx512(__m512i sw, __m512i mw) {
+   /* Rotation mixer on all 8 words at once with vprolvq */
+   __m512i rot = _mm512_and_si512(_mm512_srli_epi64(mw, 56), _mm512_set1_epi64(63));
+   __m512i mixed = _mm512_xor_si512(sw, _mm512_rolv_epi64(mw, rot));
+ 
+   __m128i v0 = _mm512_castsi512_si128(mixed);
+   __m128i v1 = _mm512_extracti32x4_epi32(mixed, 1);
+   __m128i v2 = _mm512_extracti32x4_epi32(mixed, 2);
+   __m128i v3 = _mm512_extracti32x4_epi32(mixed, 3);
+ 
+   for (int r = 0; r < QVORTEX_LITE_ROUNDS; r++) {
+     qvortex_lite_mix_avx512(&v0, &v1, &v2, &v3);
  
-   for (int r = 0; r < QVORTEX_LITE_ROUNDS; r++) {
-     qvortex_lite_mix_neon(&v0, &v1, &v2, &v3);
-     
      /* Simple permutation: rotate state vector */
-     uint64x2_t tmp = v0;
+     __m128i tmp = v0;
      v0 = v1;
      v1 = v2;
      v2 = v3;
      v3 = tmp;
    }
-   
-   /* Store back to state copy */
-   vst1q_u64(&s_copy[0], v0);
-   vst1q_u64(&s_copy[2], v1);
-   vst1q_u64(&s_copy[4], v2);
-   vst1q_u64(&s_copy[6], v3);
- #else
-   /* Scalar ARX mixing */
-   uint64_t *s = s_copy;
+ 
+   /* Feed-forward: Add mixed state back to original state */
+   __m512i out = _mm512_castsi128_si512(v0);
+   out = _mm512_inserti32x4(out, v1, 1);
+   out = _mm512_inserti32x4(out, v2, 2);
+   out = _mm512_inserti32x4(out, v3, 3);
+   return _mm512_xor_si512(sw, out);
+ }
+ 
+ QVORTEX_TARGET_AVX512
+ static void qvortex_compress_avx512(uint64_t state[QVORTEX_LITE_STATE_WORDS],
+                                     const uint8_t sbox[256],
+                                     const uint8_t *blocks, size_t nblocks) {
+   QVORTEX_STAT_ADD(blocks, nblocks);
+   __m512i sw = _mm512_loadu_si512(state);
+ 
+   for (; nblocks > 0; nblocks--, blocks += QVORTEX_LITE_BLOCK_BYTES) {
+     QVORTEX_PREFETCH(blocks);
+     sw = qvortex_lite_compress1_avx512(sw, qvortex_sbox_gather_avx512(sbox, blocks));
+   }
+   _mm512_storeu_si512(state, sw);
+ }
+ 
+ QVORTEX_TARGET_VBMI
+ static void qvortex_compress_avx512_vbmi(uint64_t state[QVORTEX_LITE_STATE_WORDS],
+                                          const uint8_t sbox[256],
+                                          const uint8_t *blocks, size_t nblocks) {
+   QVORTEX_STAT_ADD(blocks, nblocks);
+   __m512i tbl[4];
+   qvortex_sbox_load_vbmi(tbl, sbox);
+ 
+   __m512i sw = _mm512_loadu_si512(state);
+ 
+   for (; nblocks > 0; nblocks--, blocks += QVORTEX_LITE_BLOCK_BYTES) {
+     QVORTEX_PREFETCH(blocks);
+     sw = qvortex_lite_compress1_avx512(sw, qvortex_sbox_vbmi(tbl, _mm512_loadu_si512(blocks)));
+   }
+   _mm512_storeu_si512(state, sw);
+ }
+ #endif /* USE_AVX512 */
+ 
+ /* ------------------------------------------------------------------------
+    Multi-Buffer Kernels
+    ------------------------------------------------------------------------ */
+ 
+ /*
+  * These run the same compression as above on several messages at once,
+  * one message per 64-bit lane: register w holds state word w of every
+  * lane, so the two independent ARX chains of each message, (0,2,4,6) and
+  * (1,3,5,7), become whole-register operations and the vector rotation
+  * between rounds is just a renaming of registers.
+  */
+ 
+ /* S-box each lane's block and store it word-sliced */
+ static inline void qvortex_lite_load_lanes(uint64_t m[QVORTEX_LITE_STATE_WORDS][QVORTEX_MAX_LANES],
+                                           const uint8_t sbox[256],
+                                           const uint8_t *const blocks[QVORTEX_MAX_LANES],
+                                           size_t lanes) {
+   for (size_t l = 0; l < lanes; l++) {
+     uint64_t w[QVORTEX_LITE_STATE_WORDS];
+     qvortex_lite_load_block(w, sbox, blocks[l]);
+     for (int i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
+       m[i][l] = w[i];
+     }
+   }
+ }
+ 
+ /* Scalar: four lanes of plain C so independent chains overlap in the pipeline */
+ #define QVORTEX_SCALAR_LANES 4
+ 
+ static void qvortex_compress_multi_scalar(uint64_t state[QVORTEX_LITE_STATE_WORDS][QVORTEX_MAX_LANES],
+                                           const uint8_t sbox[256],
+                                           const uint8_t *const blocks[QVORTEX_MAX_LANES]) {
+   uint64_t m[QVORTEX_LITE_STATE_WORDS][QVORTEX_MAX_LANES];
+   uint64_t s[QVORTEX_LITE_STATE_WORDS][QVORTEX_SCALAR_LANES];
+   int i, l;
+ 
+   qvortex_lite_load_lanes(m, sbox, blocks, QVORTEX_SCALAR_LANES);
+ 
+   for (i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
+     for (l = 0; l < QVORTEX_SCALAR_LANES; l++) {
+       uint8_t rot = (uint8_t)(m[i][l] >> 56) & 63;
+       s[i][l] = state[i][l] ^ rotl64(m[i][l], rot);
+     }
+   }
+ 
    for (int r = 0; r < QVORTEX_LITE_ROUNDS; r++) {
-     /* Apply mixing functions */
-     qvortex_lite_mix_scalar(s, 0, 1, 2, 3);
-     qvortex_lite_mix_scalar(s, 4, 5, 6, 7);
-     
-     /* Apply permutation between rounds */
-     qvortex_lite_mix_scalar(s, 0, 5, 2, 7);
-     qvortex_lite_mix_scalar(s, 4, 1, 6, 3);
-     
-     /* Rotate state left for next round */
-     uint64_t t = s[0];
-     memmove(&s[0], &s[1], 7 * sizeof(uint64_t));
-     s[7] = t;
+     /* Word offset of v0 after r vector rotations */
+     int o = 2 * r;
+     for (int chain = 0; chain < 2; chain++) {
+       uint64_t *a = s[(o + chain) & 7], *b = s[(o + chain + 2) & 7];
+       uint64_t *c = s[(o + chain + 4) & 7], *d = s[(o + chain + 6) & 7];
+       for (l = 0; l < QVORTEX_SCALAR_LANES; l++) {
+         a[l] += b[l]; d[l] = rotr64(d[l] ^ a[l], QL_R1);
+         c[l] += d[l]; b[l] = rotr64(b[l] ^ c[l], QL_R2);
+         a[l] += b[l]; d[l] = rotr64(d[l] ^ a[l], QL_R3);
+         c[l] += d[l]; b[l] = rotr64(b[l] ^ c[l], QL_R4);
+       }
+     }
    }
- #endif
  
-   /* Feed-forward: Add mixed state back to original state */
-   for (i = 0; i < QVORTEX_LITE_STATE_WORDS; ++i) {
-     ctx->state[i] ^= s_copy[i];
+   /* Feed-forward, undoing the QVORTEX_LITE_ROUNDS vector rotations */
+   for (i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
+     const uint64_t *src = s[(i + 2 * QVORTEX_LITE_ROUNDS) & 7];
+     for (l = 0; l < QVORTEX_SCALAR_LANES; l++) {
+       state[i][l] ^= src[l];
+     }
+   }
+ }
+ 
+ #if USE_NEON
+ static void qvortex_compress_multi_neon(uint64_t state[QVORTEX_LITE_STATE_WORDS][QVORTEX_MAX_LANES],
+                                         const uint8_t sbox[256],
+                                         const uint8_t *const blocks[QVORTEX_MAX_LANES]) {
+   uint8x16x4_t tbl[4];
+   uint64x2_t a[4], b[4], w[QVORTEX_LITE_STATE_WORDS];
+   int i;
+ 
+   qvortex_sbox_load_neon(tbl, sbox);
+   qvortex_lite_load_block_neon(a, tbl, blocks[0]);
+   qvortex_lite_load_block_neon(b, tbl, blocks[1]);
+ 
+   /* Word-slice the two lanes with zips, then run the rotation mixer */
+   for (i = 0; i < 4; i++) {
+     w[2 * i] = qvortex_lite_rotmix_neon(vld1q_u64(state[2 * i]), vzip1q_u64(a[i], b[i]));
+     w[2 * i + 1] = qvortex_lite_rotmix_neon(vld1q_u64(state[2 * i + 1]), vzip2q_u64(a[i], b[i]));
+   }
+ 
+   for (int r = 0; r < QVORTEX_LITE_ROUNDS; r++) {
+     int o = 2 * r;
+     qvortex_lite_mix_neon(&w[o & 7], &w[(o + 2) & 7], &w[(o + 4) & 7], &w[(o + 6) & 7]);
+     qvortex_lite_mix_neon(&w[(o + 1) & 7], &w[(o + 3) & 7], &w[(o + 5) & 7], &w[(o + 7) & 7]);
+   }
+ 
+   for (i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
+     vst1q_u64(state[i], veorq_u64(vld1q_u64(state[i]), w[(i + 2 * QVORTEX_LITE_ROUNDS) & 7]));
+   }
+ }
+ #endif /* USE_NEON */
+ 
+ #if USE_SVE
+ /* Word i of every lane's block in one gather, substituted and mixed into row h */
+ QVORTEX_TARGET_SVE
+ static inline svuint64_t qvortex_lite_load_word_sve(svbool_t pg, const uint64_t *h,
+                                                     const uint8_t sbox[256], svuint64_t bases, int i) {
+   svuint64_t w = svld1_gather_u64base_offset_u64(pg, bases, (int64_t)(8 * i));
+   w = svreinterpret_u64_u8(qvortex_sbox_sve(sbox, svreinterpret_u8_u64(w)));
+   return qvortex_lite_rotmix_sve(pg, svld1_u64(pg, h), w);
+ }
+ 
+ QVORTEX_TARGET_SVE
+ static inline void qvortex_lite_feed_word_sve(svbool_t pg, uint64_t *h, svuint64_t w) {
+   svst1_u64(pg, h, sveor_u64_x(pg, svld1_u64(pg, h), w));
+ }
+ 
+ /*
+  * All QVORTEX_MAX_LANES lanes, svcntd() per pass (4 at 256 bits, 8 in one
+  * pass from 512). SVE vectors cannot be array elements, so the eight
+  * state words are separate variables, renamed after each round in place
+  * of the index rotation of the other kernels.
+  */
+ QVORTEX_TARGET_SVE
+ static void qvortex_compress_multi_sve(uint64_t state[QVORTEX_LITE_STATE_WORDS][QVORTEX_MAX_LANES],
+                                        const uint8_t sbox[256],
+                                        const uint8_t *const blocks[QVORTEX_MAX_LANES]) {
+   uint64_t base[QVORTEX_MAX_LANES];
+   for (int l = 0; l < QVORTEX_MAX_LANES; l++) base[l] = (uint64_t)(uintptr_t)blocks[l];
+ 
+   for (uint64_t l = 0; l < QVORTEX_MAX_LANES; l += svcntd()) {
+     const svbool_t pg = svwhilelt_b64_u64(l, QVORTEX_MAX_LANES);
+     const svuint64_t bases = svld1_u64(pg, base + l);
+     svuint64_t w0 = qvortex_lite_load_word_sve(pg, state[0] + l, sbox, bases, 0);
+     svuint64_t w1 = qvortex_lite_load_word_sve(pg, state[1] + l, sbox, bases, 1);
+     svuint64_t w2 = qvortex_lite_load_word_sve(pg, state[2] + l, sbox, bases, 2);
+     svuint64_t w3 = qvortex_lite_load_word_sve(pg, state[3] + l, sbox, bases, 3);
+     svuint64_t w4 = qvortex_lite_load_word_sve(pg, state[4] + l, sbox, bases, 4);
+     svuint64_t w5 = qvortex_lite_load_word_sve(pg, state[5] + l, sbox, bases, 5);
+     svuint64_t w6 = qvortex_lite_load_word_sve(pg, state[6] + l, sbox, bases, 6);
+     svuint64_t w7 = qvortex_lite_load_word_sve(pg, state[7] + l, sbox, bases, 7);
+ 
+     for (int r = 0; r < QVORTEX_LITE_ROUNDS; r++) {
+       qvortex_lite_mix_sve(pg, &w0, &w2, &w4, &w6);
+       qvortex_lite_mix_sve(pg, &w1, &w3, &w5, &w7);
+ 
+       /* Rotate the state two words left: w[i] takes w[i + 2] */
+       svuint64_t t0 = w0, t1 = w1;
+       w0 = w2; w1 = w3; w2 = w4; w3 = w5; w4 = w6; w5 = w7; w6 = t0; w7 = t1;
+     }
+ 
+     qvortex_lite_feed_word_sve(pg, state[0] + l, w0);
+     qvortex_lite_feed_word_sve(pg, state[1] + l, w1);
+     qvortex_lite_feed_word_sve(pg, state[2] + l, w2);
+     qvortex_lite_feed_word_sve(pg, state[3] + l, w3);
+     qvortex_lite_feed_word_sve(pg, state[4] + l, w4);
+     qvortex_lite_feed_word_sve(pg, state[5] + l, w5);
+     qvortex_lite_feed_word_sve(pg, state[6] + l, w6);
+     qvortex_lite_feed_word_sve(pg, state[7] + l, w7);
+   }
+ }
+ #endif /* USE_SVE */
+ 
+ #if USE_AVX2
+ QVORTEX_TARGET_AVX2
+ static inline __m256i qvortex_rotr_256(__m256i x, int n) {
+   switch (n) {
+   case 32: return _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+   case 24: return _mm256_shuffle_epi8(x, _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2,
+                                                           11, 12, 13, 14, 15, 8, 9, 10,
+                                                           3, 4, 5, 6, 7, 0, 1, 2,
+                                                           11, 12, 13, 14, 15, 8, 9, 10));
+   case 16: return _mm256_shuffle_epi8(x, _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1,
+                                                           10, 11, 12, 13, 14, 15, 8, 9,
+                                                           2, 3, 4, 5, 6, 7, 0, 1,
+                                                           10, 11, 12, 13, 14, 15, 8, 9));
+   case 63: return _mm256_or_si256(_mm256_add_epi64(x, x), _mm256_srli_epi64(x, 63));
+   default: return _mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - n));
+   }
+ }
+ 
+ QVORTEX_TARGET_AVX2
+ static inline void qvortex_lite_mix4_avx2(__m256i *a, __m256i *b, __m256i *c, __m256i *d) {
+   *a = _mm256_add_epi64(*a, *b);
+   *d = qvortex_rotr_256(_mm256_xor_si256(*d, *a), QL_R1);
+   *c = _mm256_add_epi64(*c, *d);
+   *b = qvortex_rotr_256(_mm256_xor_si256(*b, *c), QL_R2);
+   *a = _mm256_add_epi64(*a, *b);
+   *d = qvortex_rotr_256(_mm256_xor_si256(*d, *a), QL_R3);
+   *c = _mm256_add_epi64(*c, *d);
+   *b = qvortex_rotr_256(_mm256_xor_si256(*b, *c), QL_R4);
+ }
+ 
+ QVORTEX_TARGET_AVX2
+ static void qvortex_compress_multi_avx2(uint64_t state[QVORTEX_LITE_STATE_WORDS][QVORTEX_MAX_LANES],
+                                         const uint8_t sbox[256],
+                                         const uint8_t *const blocks[QVORTEX_MAX_LANES]) {
+   uint64_t m[QVORTEX_LITE_STATE_WORDS][QVORTEX_MAX_LANES];
+   const __m256i mask63 = _mm256_set1_epi64x(63);
+   const __m256i sixty4 = _mm256_set1_epi64x(64);
+   __m256i w[QVORTEX_LITE_STATE_WORDS];
+   int i;
+ 
+   qvortex_lite_load_lanes(m, sbox, blocks, 4);
+ 
+   for (i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
+     __m256i mw = _mm256_loadu_si256((const __m256i *)m[i]);
+     __m256i rot = _mm256_and_si256(_mm256_srli_epi64(mw, 56), mask63);
+     __m256i rotated = _mm256_or_si256(_mm256_sllv_epi64(mw, rot),
+                                       _mm256_srlv_epi64(mw, _mm256_sub_epi64(sixty4, rot)));
+     w[i] = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)state[i]), rotated);
+   }
+ 
+   for (int r = 0; r < QVORTEX_LITE_ROUNDS; r++) {
+     int o = 2 * r;
+     qvortex_lite_mix4_avx2(&w[o & 7], &w[(o + 2) & 7], &w[(o + 4) & 7], &w[(o + 6) & 7]);
+     qvortex_lite_mix4_avx2(&w[(o + 1) & 7], &w[(o + 3) & 7], &w[(o + 5) & 7], &w[(o + 7) & 7]);
+   }
+ 
+   for (i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
+     __m256i *dst = (__m256i *)state[i];
+     _mm256_storeu_si256(dst, _mm256_xor_si256(_mm256_loadu_si256(dst),
+                                               w[(i + 2 * QVORTEX_LITE_ROUNDS) & 7]));
+   }
+ }
+ #endif /* USE_AVX2 */
+ 
+ #if USE_AVX512
+ QVORTEX_TARGET_AVX512
+ static inline void qvortex_lite_mix8_avx512(__m512i *a, __m512i *b, __m512i *c, __m512i *d) {
+   *a = _mm512_add_epi64(*a, *b);
+   *d = _mm512_ror_epi64(_mm512_xor_si512(*d, *a), QL_R1);
+   *c = _mm512_add_epi64(*c, *d);
+   *b = _mm512_ror_epi64(_mm512_xor_si512(*b, *c), QL_R2);
+   *a = _mm512_add_epi64(*a, *b);
+   *d = _mm512_ror_epi64(_mm512_xor_si512(*d, *a), QL_R3);
+   *c = _mm512_add_epi64(*c, *d);
+   *b = _mm512_ror_epi64(_mm512_xor_si512(*b, *c), QL_R4);
+ }
+ 
+ QVORTEX_TARGET_AVX512
+ static inline void qvortex_lite_compress8_avx512(uint64_t state[QVORTEX_LITE_STATE_WORDS][QVORTEX_MAX_LANES],
+                                                  const __m512i m[QVORTEX_LITE_STATE_WORDS]) {
+   const __m512i mask63 = _mm512_set1_epi64(63);
+   __m512i w[QVORTEX_LITE_STATE_WORDS];
+   int i;
+ 
+   for (i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
+     __m512i rot = _mm512_and_si512(_mm512_srli_epi64(m[i], 56), mask63);
+     w[i] = _mm512_xor_si512(_mm512_loadu_si512(state[i]), _mm512_rolv_epi64(m[i], rot));
+   }
+ 
+   for (int r = 0; r < QVORTEX_LITE_ROUNDS; r++) {
+     int o = 2 * r;
+     qvortex_lite_mix8_avx512(&w[o & 7], &w[(o + 2) & 7], &w[(o + 4) & 7], &w[(o + 6) & 7]);
+     qvortex_lite_mix8_avx512(&w[(o + 1) & 7], &w[(o + 3) & 7], &w[(o + 5) & 7], &w[(o + 7) & 7]);
+   }
+ 
+   for (i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
+     _mm512_storeu_si512(state[i], _mm512_xor_si512(_mm512_loadu_si512(state[i]),
+                                                    w[(i + 2 * QVORTEX_LITE_ROUNDS) & 7]));
+   }
+ }
+ 
+ QVORTEX_TARGET_AVX512
+ static void qvortex_compress_multi_avx512(uint64_t state[QVORTEX_LITE_STATE_WORDS][QVORTEX_MAX_LANES],
+                                           const uint8_t sbox[256],
+                                           const uint8_t *const blocks[QVORTEX_MAX_LANES]) {
+   uint64_t m[QVORTEX_LITE_STATE_WORDS][QVORTEX_MAX_LANES];
+   __m512i mw[QVORTEX_LITE_STATE_WORDS];
+ 
+   qvortex_lite_load_lanes(m, sbox, blocks, 8);
+   for (int i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) mw[i] = _mm512_loadu_si512(m[i]);
+   qvortex_lite_compress8_avx512(state, mw);
+ }
+ 
+ /*
+  * Transpose an 8x8 matrix of 64-bit words held one row per register by
+  * swapping the off-diagonal 1x1, 2x2 and 4x4 blocks in turn.
+  */
+ QVORTEX_TARGET_AVX512
+ static inline void qvortex_transpose8_avx512(__m512i r[8]) {
+   static const uint64_t idx[3][2][8] = {
+     {{0, 8, 2, 10, 4, 12, 6, 14}, {1, 9, 3, 11, 5, 13, 7, 15}},
+     {{0, 1, 8, 9, 4, 5, 12, 13}, {2, 3, 10, 11, 6, 7, 14, 15}},
+     {{0, 1, 2, 3, 8, 9, 10, 11}, {4, 5, 6, 7, 12, 13, 14, 15}}
+   };
+ 
+   for (int k = 0, s = 1; k < 3; k++, s <<= 1) {
+     __m512i lo = _mm512_loadu_si512(idx[k][0]);
+     __m512i hi = _mm512_loadu_si512(idx[k][1]);
+     for (int i = 0; i < 8; i++) {
+       if (i & s) continue;
+       __m512i a = r[i], b = r[i + s];
+       r[i] = _mm512_permutex2var_epi64(a, lo, b);
+       r[i + s] = _mm512_permutex2var_epi64(a, hi, b);
+     }
+   }
+ }
+ 
+ /* Substitute each lane's block in one register, then word-slice them */
+ QVORTEX_TARGET_VBMI
+ static void qvortex_compress_multi_avx512_vbmi(uint64_t state[QVORTEX_LITE_STATE_WORDS][QVORTEX_MAX_LANES],
+                                                const uint8_t sbox[256],
+                                                const uint8_t *const blocks[QVORTEX_MAX_LANES]) {
+   __m512i tbl[4], mw[QVORTEX_LITE_STATE_WORDS];
+ 
+   qvortex_sbox_load_vbmi(tbl, sbox);
+   for (int l = 0; l < 8; l++) mw[l] = qvortex_sbox_vbmi(tbl, _mm512_loadu_si512(blocks[l]));
+   qvortex_transpose8_avx512(mw);
+   qvortex_lite_compress8_avx512(state, mw);
+ }
+ #endif /* USE_AVX512 */
+ 
+ /* ------------------------------------------------------------------------
+    Wide Variant (Qvortex-1024)
+    ------------------------------------------------------------------------ */
+ 
+ /*
+  * 16-word state, 128-byte blocks. The S-box, rotation mixer, ARX mix and
+  * feed-forward are those of Qvortex with 4-word vectors instead of 2-word
+  * ones: each round mixes columns (i, i+4, i+8, i+12) and rotates the state
+  * one vector (four words) left. With four columns the chains would never
+  * meet, so the round also staggers the lanes, vector v moving v lanes
+  * down; the second round then mixes diagonals and every word of a block
+  * reaches every output word.
+  */
+ static void qvortex_compress_wide_scalar(uint64_t state[QVORTEX_WIDE_STATE_WORDS],
+                                          const uint8_t sbox[256],
+                                          const uint8_t *blocks, size_t nblocks) {
+   QVORTEX_STAT_ADD(blocks, 2 * nblocks);
+   uint64_t h[QVORTEX_WIDE_STATE_WORDS];
+   memcpy(h, state, sizeof(h));
+ 
+   for (; nblocks > 0; nblocks--, blocks += QVORTEX_WIDE_BLOCK_BYTES) {
+     uint64_t m[QVORTEX_WIDE_STATE_WORDS], s[QVORTEX_WIDE_STATE_WORDS];
+     int i;
+     QVORTEX_PREFETCH(blocks);
+     qvortex_lite_load_block(m, sbox, blocks);
+     qvortex_lite_load_block(m + 8, sbox, blocks + QVORTEX_LITE_BLOCK_BYTES);
+ 
+     for (i = 0; i < QVORTEX_WIDE_STATE_WORDS; i++) {
+       s[i] = h[i] ^ rotl64(m[i], (unsigned)(m[i] >> 56) & 63);
+     }
+ 
+     for (int r = 0; r < QVORTEX_LITE_ROUNDS; r++) {
+       for (i = 0; i < 4; i++) qvortex_lite_mix_scalar(s, i, i + 4, i + 8, i + 12);
+ 
+       uint64_t t[QVORTEX_WIDE_STATE_WORDS];
+       memcpy(t, s, sizeof(t));
+       for (i = 0; i < QVORTEX_WIDE_STATE_WORDS; i++) {
+         int v = i >> 2;
+         s[i] = t[(4 * (v + 1) + ((i + v) & 3)) & 15];
+       }
+     }
+ 
+     for (i = 0; i < QVORTEX_WIDE_STATE_WORDS; i++) h[i] ^= s[i];
+   }
+ 
+   memcpy(state, h, sizeof(h));
+ }
+ 
+ #if USE_AVX2
+ QVORTEX_TARGET_AVX2
+ static inline __m256i qvortex_wide_rotmix_avx2(__m256i h, __m256i m) {
+   __m256i rot = _mm256_and_si256(_mm256_srli_epi64(m, 56), _mm256_set1_epi64x(63));
+   __m256i inv = _mm256_sub_epi64(_mm256_set1_epi64x(64), rot);
+   return _mm256_xor_si256(h, _mm256_or_si256(_mm256_sllv_epi64(m, rot), _mm256_srlv_epi64(m, inv)));
+ }
+ 
+ /* S-box 32 bytes in general registers, then move the words in (no store forwarding) */
+ QVORTEX_TARGET_AVX2
+ static inline __m256i qvortex_wide_sbox_avx2(const uint8_t sbox[256], const uint8_t *b) {
+   uint64_t w[4];
+   for (int i = 0; i < 4; i++, b += 8) {
+     w[i] = (uint64_t)sbox[b[0]] | (uint64_t)sbox[b[1]] << 8 |
+            (uint64_t)sbox[b[2]] << 16 | (uint64_t)sbox[b[3]] << 24 |
+            (uint64_t)sbox[b[4]] << 32 | (uint64_t)sbox[b[5]] << 40 |
+            (uint64_t)sbox[b[6]] << 48 | (uint64_t)sbox[b[7]] << 56;
+   }
+   return _mm256_set_epi64x((long long)w[3], (long long)w[2], (long long)w[1], (long long)w[0]);
+ }
+ 
+ QVORTEX_TARGET_AVX2
+ static void qvortex_compress_wide_avx2(uint64_t state[QVORTEX_WIDE_STATE_WORDS],
+                                        const uint8_t sbox[256],
+                                        const uint8_t *blocks, size_t nblocks) {
+   QVORTEX_STAT_ADD(blocks, 2 * nblocks);
+   __m256i h0 = _mm256_loadu_si256((const __m256i *)&state[0]);
+   __m256i h1 = _mm256_loadu_si256((const __m256i *)&state[4]);
+   __m256i h2 = _mm256_loadu_si256((const __m256i *)&state[8]);
+   __m256i h3 = _mm256_loadu_si256((const __m256i *)&state[12]);
+ 
+   for (; nblocks > 0; nblocks--, blocks += QVORTEX_WIDE_BLOCK_BYTES) {
+     QVORTEX_PREFETCH(blocks);
+     __m256i v0 = qvortex_wide_rotmix_avx2(h0, qvortex_wide_sbox_avx2(sbox, blocks));
+     __m256i v1 = qvortex_wide_rotmix_avx2(h1, qvortex_wide_sbox_avx2(sbox, blocks + 32));
+     __m256i v2 = qvortex_wide_rotmix_avx2(h2, qvortex_wide_sbox_avx2(sbox, blocks + 64));
+     __m256i v3 = qvortex_wide_rotmix_avx2(h3, qvortex_wide_sbox_avx2(sbox, blocks + 96));
+ 
+     for (int r = 0; r < QVORTEX_LITE_ROUNDS; r++) {
+       v0 = _mm256_add_epi64(v0, v1);
+       v3 = qvortex_rotr_256(_mm256_xor_si256(v3, v0), QL_R1);
+       v2 = _mm256_add_epi64(v2, v3);
+       v1 = qvortex_rotr_256(_mm256_xor_si256(v1, v2), QL_R2);
+       v0 = _mm256_add_epi64(v0, v1);
+       v3 = qvortex_rotr_256(_mm256_xor_si256(v3, v0), QL_R3);
+       v2 = _mm256_add_epi64(v2, v3);
+       v1 = qvortex_rotr_256(_mm256_xor_si256(v1, v2), QL_R4);
+ 
+       __m256i tmp = v0;
+       v0 = v1;
+       v1 = _mm256_permute4x64_epi64(v2, _MM_SHUFFLE(0, 3, 2, 1));
+       v2 = _mm256_permute4x64_epi64(v3, _MM_SHUFFLE(1, 0, 3, 2));
+       v3 = _mm256_permute4x64_epi64(tmp, _MM_SHUFFLE(2, 1, 0, 3));
+     }
+ 
+     h0 = _mm256_xor_si256(h0, v0);
+     h1 = _mm256_xor_si256(h1, v1);
+     h2 = _mm256_xor_si256(h2, v2);
+     h3 = _mm256_xor_si256(h3, v3);
+   }
+ 
+   _mm256_storeu_si256((__m256i *)&state[0], h0);
+   _mm256_storeu_si256((__m256i *)&state[4], h1);
+   _mm256_storeu_si256((__m256i *)&state[8], h2);
+   _mm256_storeu_si256((__m256i *)&state[12], h3);
+ }
+ #endif /* USE_AVX2 */
+ 
+ #if USE_AVX512
+ /*
+  * One wide block on AVX-512: the state and the substituted block are two
+  * zmm each (words 0-7 and 8-15). The mixer uses vprolvq, whose count is
+  * taken mod 64, and the ARX rounds run on ymm halves with vprorq.
+  */
+ QVORTEX_TARGET_AVX512
+ static inline void qvortex_wide_compress1_avx512(__m512i *h_lo, __m512i *h_hi,
+                                                  __m512i m_lo, __m512i m_hi) {
+   __m512i s_lo = _mm512_xor_si512(*h_lo, _mm512_rolv_epi64(m_lo, _mm512_srli_epi64(m_lo, 56)));
+   __m512i s_hi = _mm512_xor_si512(*h_hi, _mm512_rolv_epi64(m_hi, _mm512_srli_epi64(m_hi, 56)));
+   __m256i v0 = _mm512_castsi512_si256(s_lo), v1 = _mm512_extracti64x4_epi64(s_lo, 1);
+   __m256i v2 = _mm512_castsi512_si256(s_hi), v3 = _mm512_extracti64x4_epi64(s_hi, 1);
+ 
+   for (int r = 0; r < QVORTEX_LITE_ROUNDS; r++) {
+     v0 = _mm256_add_epi64(v0, v1);
+     v3 = _mm256_ror_epi64(_mm256_xor_si256(v3, v0), QL_R1);
+     v2 = _mm256_add_epi64(v2, v3);
+     v1 = _mm256_ror_epi64(_mm256_xor_si256(v1, v2), QL_R2);
+     v0 = _mm256_add_epi64(v0, v1);
+     v3 = _mm256_ror_epi64(_mm256_xor_si256(v3, v0), QL_R3);
+     v2 = _mm256_add_epi64(v2, v3);
+     v1 = _mm256_ror_epi64(_mm256_xor_si256(v1, v2), QL_R4);
+ 
+     __m256i tmp = v0;
+     v0 = v1;
+     v1 = _mm256_permute4x64_epi64(v2, _MM_SHUFFLE(0, 3, 2, 1));
+     v2 = _mm256_permute4x64_epi64(v3, _MM_SHUFFLE(1, 0, 3, 2));
+     v3 = _mm256_permute4x64_epi64(tmp, _MM_SHUFFLE(2, 1, 0, 3));
+   }
+ 
+   *h_lo = _mm512_xor_si512(*h_lo, _mm512_inserti64x4(_mm512_castsi256_si512(v0), v1, 1));
+   *h_hi = _mm512_xor_si512(*h_hi, _mm512_inserti64x4(_mm512_castsi256_si512(v2), v3, 1));
+ }
+ 
+ QVORTEX_TARGET_AVX512
+ static void qvortex_compress_wide_avx512(uint64_t state[QVORTEX_WIDE_STATE_WORDS],
+                                          const uint8_t sbox[256],
+                                          const uint8_t *blocks, size_t nblocks) {
+   QVORTEX_STAT_ADD(blocks, 2 * nblocks);
+   __m512i h_lo = _mm512_loadu_si512(&state[0]);
+   __m512i h_hi = _mm512_loadu_si512(&state[8]);
+ 
+   for (; nblocks > 0; nblocks--, blocks += QVORTEX_WIDE_BLOCK_BYTES) {
+     QVORTEX_PREFETCH(blocks);
+     qvortex_wide_compress1_avx512(&h_lo, &h_hi, qvortex_sbox_gather_avx512(sbox, blocks),
+                                   qvortex_sbox_gather_avx512(sbox, blocks + QVORTEX_LITE_BLOCK_BYTES));
+   }
+ 
+   _mm512_storeu_si512(&state[0], h_lo);
+   _mm512_storeu_si512(&state[8], h_hi);
+ }
+ 
+ QVORTEX_TARGET_VBMI
+ static void qvortex_compress_wide_avx512_vbmi(uint64_t state[QVORTEX_WIDE_STATE_WORDS],
+                                               const uint8_t sbox[256],
+                                               const uint8_t *blocks, size_t nblocks) {
+   QVORTEX_STAT_ADD(blocks, 2 * nblocks);
+   __m512i tbl[4];
+   qvortex_sbox_load_vbmi(tbl, sbox);
+   __m512i h_lo = _mm512_loadu_si512(&state[0]);
+   __m512i h_hi = _mm512_loadu_si512(&state[8]);
+ 
+   for (; nblocks > 0; nblocks--, blocks += QVORTEX_WIDE_BLOCK_BYTES) {
+     QVORTEX_PREFETCH(blocks);
+     __m512i m_lo = qvortex_sbox_vbmi(tbl, _mm512_loadu_si512(blocks));
+     __m512i m_hi = qvortex_sbox_vbmi(tbl, _mm512_loadu_si512(blocks + QVORTEX_LITE_BLOCK_BYTES));
+     qvortex_wide_compress1_avx512(&h_lo, &h_hi, m_lo, m_hi);
+   }
+ 
+   _mm512_storeu_si512(&state[0], h_lo);
+   _mm512_storeu_si512(&state[8], h_hi);
+ }
+ #endif /* USE_AVX512 */
+ 
+ #if USE_SVE
+ /* 32 block bytes, substituted, as the four words of a wide-state vector */
+ QVORTEX_TARGET_SVE
+ static inline svuint64_t qvortex_wide_sbox_sve(const uint8_t sbox[256], const uint8_t *b) {
+   svuint8_t x = svld1_u8(svwhilelt_b8_u64(0, 32), b);
+   return svreinterpret_u64_u8(qvortex_sbox_sve(sbox, x));
+ }
+ 
+ /*
+  * The AVX2 layout in the low four lanes of each vector, so any vector
+  * length from 256 bits works; the lane stagger is a TBL per vector.
+  */
+ QVORTEX_TARGET_SVE
+ static void qvortex_compress_wide_sve(uint64_t state[QVORTEX_WIDE_STATE_WORDS],
+                                       const uint8_t sbox[256],
+                                       const uint8_t *blocks, size_t nblocks) {
+   static const uint64_t down1[4] = { 1, 2, 3, 0 }, down2[4] = { 2, 3, 0, 1 }, down3[4] = { 3, 0, 1, 2 };
+   QVORTEX_STAT_ADD(blocks, 2 * nblocks);
+   const svbool_t pg = svwhilelt_b64_u64(0, 4);
+   const svuint64_t p1 = svld1_u64(pg, down1), p2 = svld1_u64(pg, down2), p3 = svld1_u64(pg, down3);
+   svuint64_t h0 = svld1_u64(pg, &state[0]);
+   svuint64_t h1 = svld1_u64(pg, &state[4]);
+   svuint64_t h2 = svld1_u64(pg, &state[8]);
+   svuint64_t h3 = svld1_u64(pg, &state[12]);
+ 
+   for (; nblocks > 0; nblocks--, blocks += QVORTEX_WIDE_BLOCK_BYTES) {
+     QVORTEX_PREFETCH(blocks);
+     svuint64_t v0 = qvortex_lite_rotmix_sve(pg, h0, qvortex_wide_sbox_sve(sbox, blocks));
+     svuint64_t v1 = qvortex_lite_rotmix_sve(pg, h1, qvortex_wide_sbox_sve(sbox, blocks + 32));
+     svuint64_t v2 = qvortex_lite_rotmix_sve(pg, h2, qvortex_wide_sbox_sve(sbox, blocks + 64));
+     svuint64_t v3 = qvortex_lite_rotmix_sve(pg, h3, qvortex_wide_sbox_sve(sbox, blocks + 96));
+ 
+     for (int r = 0; r < QVORTEX_LITE_ROUNDS; r++) {
+       qvortex_lite_mix_sve(pg, &v0, &v1, &v2, &v3);
+ 
+       svuint64_t tmp = v0;
+       v0 = v1;
+       v1 = svtbl_u64(v2, p1);
+       v2 = svtbl_u64(v3, p2);
+       v3 = svtbl_u64(tmp, p3);
+     }
+ 
+     h0 = sveor_u64_x(pg, h0, v0);
+     h1 = sveor_u64_x(pg, h1, v1);
+     h2 = sveor_u64_x(pg, h2, v2);
+     h3 = sveor_u64_x(pg, h3, v3);
    }
+ 
+   svst1_u64(pg, &state[0], h0);
+   svst1_u64(pg, &state[4], h1);
+   svst1_u64(pg, &state[8], h2);
+   svst1_u64(pg, &state[12], h3);
+ }
+ #endif /* USE_SVE */
+ 
+ /* ------------------------------------------------------------------------
+    Backend Dispatch
+    ------------------------------------------------------------------------ */
+ 
+ static int qvortex_cpu_always(void) {
+   return 1;
+ }
+ 
+ static const qvortex_backend qvortex_backend_scalar = {
+   .name = "scalar",
+   .supported = qvortex_cpu_always,
+   .compress = qvortex_compress_scalar,
+   .keccak_f1600 = keccak_f1600_scalar,
+   .lanes = QVORTEX_SCALAR_LANES,
+   .compress_multi = qvortex_compress_multi_scalar,
+   .keccak_lanes = 1,
+   .keccak_f1600_multi = keccak_f1600_multi_scalar,
+   .compress_wide = qvortex_compress_wide_scalar
+ };
+ 
+ #if USE_NEON
+ static const qvortex_backend qvortex_backend_neon = {
+   .name = "neon",
+   .supported = qvortex_cpu_always,
+   .compress = qvortex_compress_neon,
+   .keccak_f1600 = keccak_f1600_neon,
+   .lanes = 2,
+   .compress_multi = qvortex_compress_multi_neon,
+   .keccak_lanes = 2,
+   .keccak_f1600_multi = keccak_f1600_multi_neon,
+   .compress_wide = qvortex_compress_wide_scalar
+ };
+ #endif
+ 
+ #if USE_NEON_SHA3
+ static int qvortex_cpu_has_sha3(void) {
+ #if defined(__ARM_FEATURE_SHA3)
+   return 1;
+ #elif defined(__APPLE__)
+   int has = 0;
+   size_t size = sizeof(has);
+   if (sysctlbyname("hw.optional.armv8_2_sha3", &has, &size, NULL, 0) != 0) return 0;
+   return has;
+ #elif defined(__linux__)
+ #ifndef HWCAP_SHA3
+ #define HWCAP_SHA3 (1UL << 17)
+ #endif
+   return (getauxval(AT_HWCAP) & HWCAP_SHA3) != 0;
+ #else
+   return 0;
+ #endif
+ }
+ 
+ /* Same block kernels as "neon"; only the Keccak permutation differs */
+ static const qvortex_backend qvortex_backend_neon_sha3 = {
+   .name = "neon-sha3",
+   .supported = qvortex_cpu_has_sha3,
+   .compress = qvortex_compress_neon,
+   .keccak_f1600 = keccak_f1600_sha3,
+   .lanes = 2,
+   .compress_multi = qvortex_compress_multi_neon,
+   .keccak_lanes = 2,
+   .keccak_f1600_multi = keccak_f1600_multi_sha3,
+   .compress_wide = qvortex_compress_wide_scalar
+ };
+ #endif
+ 
+ #if USE_SVE
+ QVORTEX_TARGET_SVE
+ static int qvortex_cpu_has_sve(void) {
+ #ifndef HWCAP_SVE
+ #define HWCAP_SVE (1UL << 22)
+ #endif
+   if ((getauxval(AT_HWCAP) & HWCAP_SVE) == 0) return 0;
+ 
+   /* qvortex_sbox_sve needs whole vectors of the table: 256, 512, ... 2048 bits */
+   const uint64_t vl = svcntb();
+   return vl >= 32 && (vl & (vl - 1)) == 0;
+ }
+ 
+ /* SVE lanes for batches and the wide variant; one message stays on NEON */
+ static const qvortex_backend qvortex_backend_sve = {
+   .name = "sve",
+   .supported = qvortex_cpu_has_sve,
+   .compress = qvortex_compress_neon,
+   .keccak_f1600 = keccak_f1600_neon,
+   .lanes = QVORTEX_MAX_LANES,
+   .compress_multi = qvortex_compress_multi_sve,
+   .keccak_lanes = 2,
+   .keccak_f1600_multi = keccak_f1600_multi_neon,
+   .compress_wide = qvortex_compress_wide_sve
+ };
+ #endif
+ 
+ #if USE_SVE && USE_NEON_SHA3
+ static int qvortex_cpu_has_sve_sha3(void) {
+   return qvortex_cpu_has_sve() && qvortex_cpu_has_sha3();
+ }
+ 
+ static const qvortex_backend qvortex_backend_sve_sha3 = {
+   .name = "sve-sha3",
+   .supported = qvortex_cpu_has_sve_sha3,
+   .compress = qvortex_compress_neon,
+   .keccak_f1600 = keccak_f1600_sha3,
+   .lanes = QVORTEX_MAX_LANES,
+   .compress_multi = qvortex_compress_multi_sve,
+   .keccak_lanes = 2,
+   .keccak_f1600_multi = keccak_f1600_multi_sha3,
+   .compress_wide = qvortex_compress_wide_sve
+ };
+ #endif
+ 
+ #if USE_AVX2
+ static int qvortex_cpu_has_avx2(void) {
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("avx2");
+ }
+ 
+ /* No 5-lane row layout fits a ymm, so AVX2 keeps the scalar Keccak for one state */
+ static const qvortex_backend qvortex_backend_avx2 = {
+   .name = "avx2",
+   .supported = qvortex_cpu_has_avx2,
+   .compress = qvortex_compress_avx2,
+   .keccak_f1600 = keccak_f1600_scalar,
+   .lanes = 4,
+   .compress_multi = qvortex_compress_multi_avx2,
+   .keccak_lanes = 4,
+   .keccak_f1600_multi = keccak_f1600_multi_avx2,
+   .compress_wide = qvortex_compress_wide_avx2
+ };
+ #endif
+ 
+ #if USE_AVX512
+ static int qvortex_cpu_has_avx512(void) {
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("avx2") &&
+          __builtin_cpu_supports("avx512f") &&
+          __builtin_cpu_supports("avx512vl");
+ }
+ 
+ static const qvortex_backend qvortex_backend_avx512 = {
+   .name = "avx512",
+   .supported = qvortex_cpu_has_avx512,
+   .compress = qvortex_compress_avx512,
+   .keccak_f1600 = keccak_f1600_avx512,
+   .lanes = 8,
+   .compress_multi = qvortex_compress_multi_avx512,
+   .keccak_lanes = 8,
+   .keccak_f1600_multi = keccak_f1600_multi_avx512,
+   .compress_wide = qvortex_compress_wide_avx512
+ };
+ #endif
+ 
+ #if USE_AVX512
+ static int qvortex_cpu_has_vbmi(void) {
+   return qvortex_cpu_has_avx512() &&
+          __builtin_cpu_supports("avx512bw") &&
+          __builtin_cpu_supports("avx512vbmi");
+ }
+ 
+ /* AVX-512 with the S-box done by vpermi2b instead of byte loads */
+ static const qvortex_backend qvortex_backend_avx512_vbmi = {
+   .name = "avx512-vbmi",
+   .supported = qvortex_cpu_has_vbmi,
+   .compress = qvortex_compress_avx512_vbmi,
+   .keccak_f1600 = keccak_f1600_avx512,
+   .lanes = 8,
+   .compress_multi = qvortex_compress_multi_avx512_vbmi,
+   .keccak_lanes = 8,
+   .keccak_f1600_multi = keccak_f1600_multi_avx512,
+   .compress_wide = qvortex_compress_wide_avx512_vbmi
+ };
+ #endif
+ 
+ /* Candidate backends, best first; scalar is always last */
+ static const qvortex_backend *const qvortex_backends[] = {
+ #if USE_AVX512
+   &qvortex_backend_avx512_vbmi,
+   &qvortex_backend_avx512,
+ #endif
+ #if USE_AVX2
+   &qvortex_backend_avx2,
+ #endif
+ #if USE_SVE && USE_NEON_SHA3
+   &qvortex_backend_sve_sha3,
+ #endif
+ #if USE_SVE
+   &qvortex_backend_sve,
+ #endif
+ #if USE_NEON_SHA3
+   &qvortex_backend_neon_sha3,
+ #endif
+ #if USE_NEON
+   &qvortex_backend_neon,
+ #endif
+   &qvortex_backend_scalar
+ };
+ 
+ #define QVORTEX_NUM_BACKENDS (sizeof(qvortex_backends) / sizeof(qvortex_backends[0]))
+ 
+ static const qvortex_backend *qvortex_active_backend = NULL;
+ 
+ /* Find a supported backend by name; NULL picks the best one */
+ static const qvortex_backend *qvortex_find_backend(const char *name) {
+   for (size_t i = 0; i < QVORTEX_NUM_BACKENDS; i++) {
+     const qvortex_backend *b = qvortex_backends[i];
+     if (name && strcmp(name, b->name) != 0) continue;
+     if (b->supported()) return b;
+   }
+   return NULL;
+ }
+ 
+ /* QVORTEX_BACKEND in the environment overrides the automatic choice */
+ static const qvortex_backend *qvortex_select_backend(void) {
+   const qvortex_backend *b = NULL;
+   const char *forced = getenv("QVORTEX_BACKEND");
+ 
+   if (forced && forced[0]) b = qvortex_find_backend(forced);
+   if (!b) b = qvortex_find_backend(NULL);
+   return b;
+ }
+ 
+ static const qvortex_backend *qvortex_backend_get(void) {
+   const qvortex_backend *b = __atomic_load_n(&qvortex_active_backend, __ATOMIC_ACQUIRE);
+   if (!b) {
+     b = qvortex_select_backend();
+     __atomic_store_n(&qvortex_active_backend, b, __ATOMIC_RELEASE);
+   }
+   return b;
+ }
+ 
+ /* Select at load time so the hot path never sees an unset pointer */
+ __attribute__((constructor))
+ static void qvortex_backend_init(void) {
+   (void)qvortex_backend_get();
+ }
+ 
+ static inline void qvortex_lite_process_block(qvortex_lite_ctx *ctx, 
+                                              const uint8_t block[QVORTEX_LITE_BLOCK_BYTES]) {
+   qvortex_backend_get()->compress(ctx->state, ctx->sbox, block, 1);
+ }
+ 
+ /* Initial state constants (SHA-512 IV) */
+ #define QL_IV_WORDS \
+   0x6A09E667F3BCC908ULL, 0xBB67AE8584CAA73BULL, 0x3C6EF372FE94F82BULL, \
+   0xA54FF53A5F1D36F1ULL, 0x510E527FADE682D1ULL, 0x9B05688C2B3E6C1FULL, \
+   0x1F83D9ABFB41BD6BULL, 0x5BE0CD19137E2179ULL
+ 
+ static const uint64_t QL_IV[QVORTEX_LITE_STATE_WORDS] = { QL_IV_WORDS };
+ 
+ /*
+  * The unkeyed template, baked in: its S-box is shake128 of the 32-byte
+  * 0xCC seed. qvortex_lite_default_sbox_ok() re-derives it, and the build
+  * script refuses to build the library if the two differ.
+  */
+ static const qvortex_template QL_DEFAULT_TEMPLATE = {
+   { QL_IV_WORDS },
+   {
+     0xc3, 0x48, 0x60, 0xd6, 0x4d, 0x6d, 0x3f, 0x9b, 0x07, 0xfe, 0x17, 0x50,
+     0xe4, 0xca, 0x63, 0xae, 0x0c, 0xa0, 0x70, 0xec, 0x7f, 0x4c, 0xa1, 0x4a,
+     0x67, 0xbf, 0xdf, 0x90, 0x1d, 0x52, 0x29, 0x3c, 0xb5, 0x41, 0x48, 0x5d,
+     0x11, 0xcf, 0xcb, 0x6f, 0xbf, 0x3b, 0x76, 0x07, 0x77, 0xfb, 0x6c, 0x2e,
+     0x8a, 0xa3, 0x65, 0x0a, 0xb2, 0xb3, 0xf6, 0x69, 0x8f, 0xf8, 0x48, 0x3c,
+     0xdc, 0x85, 0x30, 0xb7, 0x24, 0xc7, 0x02, 0x32, 0x7a, 0x98, 0x6d, 0x6c,
+     0x46, 0xb7, 0x7b, 0x31, 0xb2, 0x32, 0xb9, 0x66, 0x14, 0xa5, 0xce, 0xaa,
+     0x7c, 0x63, 0x97, 0x11, 0x2a, 0x78, 0xbb, 0xb9, 0x49, 0x19, 0xd5, 0x3b,
+     0x51, 0x19, 0x35, 0x84, 0x64, 0x70, 0x23, 0x6f, 0xa1, 0x76, 0x80, 0xdb,
+     0xfe, 0xf7, 0x08, 0x6d, 0xae, 0x51, 0xa3, 0x06, 0x16, 0xd7, 0x54, 0x75,
+     0x5a, 0x0f, 0xb8, 0x68, 0x2b, 0x2d, 0x1e, 0xa0, 0x8a, 0xc1, 0x72, 0x99,
+     0xbb, 0xc6, 0x17, 0x71, 0xc1, 0xcc, 0x98, 0xd4, 0xf5, 0x8a, 0xfa, 0x4f,
+     0x0b, 0x47, 0x72, 0x25, 0x4d, 0x83, 0xe8, 0x74, 0x6a, 0x1a, 0x47, 0xd8,
+     0xbf, 0xf1, 0xf0, 0x67, 0xb2, 0x9f, 0xfb, 0x2b, 0x2e, 0x5e, 0xd7, 0x89,
+     0xe9, 0xad, 0xe4, 0x1c, 0xf4, 0x9b, 0x44, 0xed, 0x99, 0x21, 0x2b, 0xd7,
+     0xa2, 0x14, 0x31, 0x74, 0x08, 0x10, 0x84, 0x53, 0x3c, 0x3a, 0xcc, 0x62,
+     0x7a, 0xfe, 0xd3, 0xf0, 0x89, 0xc4, 0xbb, 0x76, 0x57, 0x8e, 0x4a, 0x93,
+     0x44, 0x9e, 0xc7, 0x9b, 0xb2, 0x0f, 0xde, 0x62, 0x39, 0xfb, 0xa7, 0x2a,
+     0x43, 0xb9, 0x6a, 0xe9, 0x99, 0xc4, 0x2a, 0x19, 0x91, 0x85, 0xb6, 0xfb,
+     0xc1, 0x79, 0x56, 0x76, 0xce, 0x8d, 0x7f, 0xf4, 0x6d, 0x1a, 0xb1, 0xdd,
+     0xd2, 0xa6, 0x2b, 0xcb, 0x45, 0x03, 0x29, 0xb9, 0xf0, 0xa0, 0xe4, 0xde,
+     0xe1, 0x3c, 0xce, 0x22
+   }
+ };
+ 
+ static inline void qvortex_lite_template_init(qvortex_template *tpl,
+                                               const uint8_t *key, size_t key_len) {
+   /* Unkeyed: the precomputed template, no SHAKE-128 */
+   if (!key || key_len == 0) {
+     memcpy(tpl, &QL_DEFAULT_TEMPLATE, sizeof(*tpl));
+     return;
+   }
+ 
+   /* Initialize state with constants */
+   memcpy(tpl->state, QL_IV, sizeof(tpl->state));
+ 
+   /* Generate the S-box using SHAKE-128 */
+   uint8_t sbox_seed[32];
+   shake128(key, key_len, sbox_seed, 32);
+   shake128(sbox_seed, 32, tpl->sbox, 256);
+ }
+ 
+ /*
+  * The template for a key: the baked-in default when unkeyed, otherwise
+  * derived into scratch. Saves one-shot paths even the 320-byte copy.
+  */
+ static inline const qvortex_template *qvortex_lite_template_get(qvortex_template *scratch,
+                                                                 const uint8_t *key,
+                                                                 size_t key_len) {
+   if (!key || key_len == 0) return &QL_DEFAULT_TEMPLATE;
+   qvortex_lite_template_init(scratch, key, key_len);
+   return scratch;
+ }
+ 
+ /* Build-time self-check of QL_DEFAULT_TEMPLATE against the SHAKE derivation */
+ static inline int qvortex_lite_default_sbox_ok(void) {
+   uint8_t seed[32], sbox[256];
+   memset(seed, 0xCC, sizeof(seed));
+   shake128(seed, sizeof(seed), sbox, sizeof(sbox));
+   return memcmp(sbox, QL_DEFAULT_TEMPLATE.sbox, sizeof(sbox)) == 0 &&
+          memcmp(QL_IV, QL_DEFAULT_TEMPLATE.state, sizeof(QL_IV)) == 0;
+ }
+ 
+ static inline void qvortex_lite_init_from_template(qvortex_lite_ctx *ctx,
+                                                    const qvortex_template *tpl) {
+   memcpy(ctx->state, tpl->state, sizeof(ctx->state));
+   memcpy(ctx->sbox, tpl->sbox, sizeof(ctx->sbox));
+ 
+   /* Initialize buffer state */
+   ctx->buffer_len = 0;
+   ctx->total_len = 0;
+ }
+ 
+ static inline void qvortex_lite_init(qvortex_lite_ctx *ctx, const uint8_t *key, size_t key_len) {
+   qvortex_template scratch;
+   qvortex_lite_init_from_template(ctx, qvortex_lite_template_get(&scratch, key, key_len));
+ }
+ 
+ /* ------------------------------------------------------------------------
+    Batched Key Schedule
+    ------------------------------------------------------------------------ */
+ 
+ #define QVORTEX_SHAKE128_RATE 168
+ 
+ /*
+  * Load one state of a lane-sliced array with a message shorter than one
+  * block plus its SHAKE padding, in shake128's byte order.
+  */
+ static inline void qvortex_keccak_lane_absorb1(uint64_t st[25][QVORTEX_MAX_LANES], size_t lane,
+                                                const uint8_t *in, size_t len) {
+   uint64_t block[QVORTEX_SHAKE128_RATE / 8] = {0};
+   memcpy(block, in, len);
+   ((uint8_t *)block)[len] ^= 0x1F;
+   ((uint8_t *)block)[QVORTEX_SHAKE128_RATE - 1] ^= 0x80;
+   for (size_t w = 0; w < QVORTEX_SHAKE128_RATE / 8; w++) st[w][lane] = block[w];
+ }
+ 
+ /* Squeeze len bytes (a multiple of 8) from the start of one state */
+ static inline void qvortex_keccak_lane_read(uint64_t st[25][QVORTEX_MAX_LANES], size_t lane,
+                                             uint8_t *out, size_t len) {
+   for (size_t w = 0; w < len / 8; w++) memcpy(out + 8 * w, &st[w][lane], 8);
+ }
+ 
+ /*
+  * qvortex_lite_template_init for n keys, keccak_lanes keys at a time.
+  *
+  * A keyed template costs three permutations: one for the seed (keys
+  * shorter than a SHAKE-128 block) and two to squeeze the 256-byte S-box.
+  * Each step runs across the whole group with one keccak_f1600_multi call;
+  * longer keys derive their seed on their own first.
+  */
+ static void qvortex_lite_derive_templates(const uint8_t *const *keys, const size_t *key_lens,
+                                           size_t n, qvortex_template *out) {
+   const qvortex_backend *b = qvortex_backend_get();
+   const size_t lanes = b->keccak_lanes;
+   uint64_t st[25][QVORTEX_MAX_LANES];
+   uint8_t seeds[QVORTEX_MAX_LANES][32];
+ 
+   for (size_t base = 0; base < n; base += lanes) {
+     size_t group = (n - base < lanes) ? n - base : lanes;
+     int batched = 0;
+ 
+     /* Seeds */
+     memset(st, 0, sizeof(st));
+     for (size_t l = 0; l < group; l++) {
+       const uint8_t *key = keys[base + l];
+       size_t key_len = key_lens[base + l];
+ 
+       if (!key || key_len == 0) {
+         memset(seeds[l], 0xCC, 32);
+       } else if (key_len >= QVORTEX_SHAKE128_RATE) {
+         shake128(key, key_len, seeds[l], 32);
+       } else {
+         qvortex_keccak_lane_absorb1(st, l, key, key_len);
+         QVORTEX_STAT_ADD(shake128_calls, 1);
+         batched = 1;
+       }
+     }
+     if (batched) {
+       b->keccak_f1600_multi(st);
+       for (size_t l = 0; l < group; l++) {
+         size_t key_len = key_lens[base + l];
+         if (keys[base + l] && key_len > 0 && key_len < QVORTEX_SHAKE128_RATE) {
+           qvortex_keccak_lane_read(st, l, seeds[l], 32);
+         }
+       }
+     }
+ 
+     /* S-boxes: 168 bytes from the first squeeze, 88 from the second */
+     memset(st, 0, sizeof(st));
+     for (size_t l = 0; l < group; l++) {
+       qvortex_keccak_lane_absorb1(st, l, seeds[l], 32);
+     }
+     b->keccak_f1600_multi(st);
+     QVORTEX_STAT_ADD(shake128_calls, group);
+     for (size_t l = 0; l < group; l++) {
+       qvortex_keccak_lane_read(st, l, out[base + l].sbox, QVORTEX_SHAKE128_RATE);
+     }
+     b->keccak_f1600_multi(st);
+     for (size_t l = 0; l < group; l++) {
+       qvortex_keccak_lane_read(st, l, out[base + l].sbox + QVORTEX_SHAKE128_RATE,
+                                256 - QVORTEX_SHAKE128_RATE);
+       memcpy(out[base + l].state, QL_IV, sizeof(out[base + l].state));
+     }
+   }
+ 
+   /* Zeroize key material */
+   memset(st, 0, sizeof(st));
+   memset(seeds, 0, sizeof(seeds));
+ }
+ 
+ static inline void qvortex_lite_update(qvortex_lite_ctx *ctx, const uint8_t *data, size_t len) {
+   QVORTEX_STAT_ADD(bytes, len);
+   ctx->total_len += len;
+   size_t data_off = 0;
+ 
+   /* Process remaining buffer first */
+   if (ctx->buffer_len > 0) {
+     size_t needed = QVORTEX_LITE_BLOCK_BYTES - ctx->buffer_len;
+     size_t can_copy = (len < needed) ? len : needed;
+     
+     memcpy(&ctx->buffer[ctx->buffer_len], data, can_copy);
+     QVORTEX_STAT_ADD(tail_copies, 1);
+     ctx->buffer_len += can_copy;
+     data_off += can_copy;
+     len -= can_copy;
+ 
+     if (ctx->buffer_len == QVORTEX_LITE_BLOCK_BYTES) {
+       qvortex_lite_process_block(ctx, ctx->buffer);
+       ctx->buffer_len = 0;
+     }
+   }
+ 
+   /* Process full blocks */
+   if (len >= QVORTEX_LITE_BLOCK_BYTES) {
+     size_t nblocks = len / QVORTEX_LITE_BLOCK_BYTES;
+     qvortex_backend_get()->compress(ctx->state, ctx->sbox, data + data_off, nblocks);
+     data_off += nblocks * QVORTEX_LITE_BLOCK_BYTES;
+     len -= nblocks * QVORTEX_LITE_BLOCK_BYTES;
+   }
+ 
+   /* Copy remaining data to buffer */
+   if (len > 0) {
+     memcpy(ctx->buffer, data + data_off, len);
+     QVORTEX_STAT_ADD(tail_copies, 1);
+     ctx->buffer_len = len;
+   }
+ }
+ 
+ static inline void qvortex_lite_final(qvortex_lite_ctx *ctx, uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   /* Padding: Append 0x80, then zeros, then length */
+   size_t current_len = ctx->buffer_len;
+   ctx->buffer[current_len++] = 0x80;  /* Append 1 bit (0x80 byte) */
+ 
+   /* Zero pad until space for length encoding */
+   size_t pad_zeros = QVORTEX_LITE_BLOCK_BYTES - (current_len % QVORTEX_LITE_BLOCK_BYTES);
+   if (pad_zeros < 8) {  /* Need at least 8 bytes for length */
+     pad_zeros += QVORTEX_LITE_BLOCK_BYTES;
+   }
+   pad_zeros -= 8;  /* Reserve space for length */
+ 
+   if (current_len + pad_zeros > QVORTEX_LITE_BLOCK_BYTES) {
+     memset(&ctx->buffer[current_len], 0, QVORTEX_LITE_BLOCK_BYTES - current_len);
+     qvortex_lite_process_block(ctx, ctx->buffer);
+     current_len = 0;
+     memset(ctx->buffer, 0, QVORTEX_LITE_BLOCK_BYTES);
+   } else {
+     memset(&ctx->buffer[current_len], 0, pad_zeros);
+   }
+   current_len += pad_zeros;
+ 
+   /* Append total length in bits (little-endian 64-bit) */
+   uint64_t total_bits = ctx->total_len * 8;
+   memcpy(&ctx->buffer[QVORTEX_LITE_BLOCK_BYTES - 8], &total_bits, 8);
+ 
+   /* Process the final padded block */
+   qvortex_lite_process_block(ctx, ctx->buffer);
+ 
+   /* Output: First N bytes of the state (little-endian) */
+   uint8_t *state_bytes = (uint8_t *)ctx->state;
+   memcpy(out, state_bytes, QVORTEX_LITE_DIGEST_BYTES);
+ 
+   /* Zeroize context state for security */
+   memset(ctx, 0, sizeof(qvortex_lite_ctx));
+ }
+ 
+ /*
+  * One-shot hash of at most QVORTEX_LITE_SHORT_MAX bytes. The padded block
+  * is built in place and compressed once, with no context, buffering or
+  * zeroization; the digest is identical to init/update/final.
+  */
+ static inline void qvortex_lite_hash_short(const qvortex_template *tpl,
+                                            const uint8_t *data, size_t len,
+                                            uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   uint64_t block[QVORTEX_LITE_BLOCK_BYTES / 8] = {0};
+   uint64_t state[QVORTEX_LITE_STATE_WORDS];
+ 
+   QVORTEX_STAT_ADD(bytes, len);
+   if (len > 0) memcpy(block, data, len);
+   ((uint8_t *)block)[len] = 0x80;
+   block[QVORTEX_LITE_BLOCK_BYTES / 8 - 1] = (uint64_t)len * 8;
+ 
+   memcpy(state, tpl->state, sizeof(state));
+   qvortex_backend_get()->compress(state, tpl->sbox, (const uint8_t *)block, 1);
+   memcpy(out, state, QVORTEX_LITE_DIGEST_BYTES);
+ }
+ 
+ /*
+  * Pad and compress the final tail_len (< 64) bytes of a total_len-byte
+  * message: one block when the padding fits after the tail, else two.
+  */
+ static inline void qvortex_lite_compress_tail(uint64_t state[QVORTEX_LITE_STATE_WORDS],
+                                               const uint8_t sbox[256],
+                                               const uint8_t *tail, size_t tail_len,
+                                               uint64_t total_len) {
+   size_t nblocks = tail_len <= QVORTEX_LITE_SHORT_MAX ? 1 : 2;
+   uint64_t block[2 * QVORTEX_LITE_BLOCK_BYTES / 8] = {0};
+ 
+   if (tail_len > 0) memcpy(block, tail, tail_len);
+   ((uint8_t *)block)[tail_len] = 0x80;
+   block[nblocks * QVORTEX_LITE_BLOCK_BYTES / 8 - 1] = total_len * 8;
+   qvortex_backend_get()->compress(state, sbox, (const uint8_t *)block, nblocks);
+ }
+ 
+ /*
+  * Context-free one-shot of any length: whole blocks are compressed straight
+  * from the input and only the padded tail (one or two blocks) is built
+  * locally. Leaves the final state, i.e. the digest words, in state.
+  */
+ static inline void qvortex_lite_hash_state(const qvortex_template *tpl,
+                                            const uint8_t *data, size_t len,
+                                            uint64_t state[QVORTEX_LITE_STATE_WORDS]) {
+   size_t full = len / QVORTEX_LITE_BLOCK_BYTES;
+ 
+   QVORTEX_STAT_ADD(bytes, len);
+   memcpy(state, tpl->state, QVORTEX_LITE_STATE_WORDS * sizeof(uint64_t));
+   if (full > 0) qvortex_backend_get()->compress(state, tpl->sbox, data, full);
+   qvortex_lite_compress_tail(state, tpl->sbox, data + full * QVORTEX_LITE_BLOCK_BYTES,
+                              len % QVORTEX_LITE_BLOCK_BYTES, len);
+ }
+ 
+ /*
+  * Absorb a fragment list into state. used bytes are already staged in
+  * buffer; a block that straddles fragments is assembled there, and every
+  * whole block inside a fragment goes to the bulk kernel in place. Returns
+  * the bytes left staged. Message bytes are copied only for straddling
+  * blocks and the final partial block.
+  */
+ static size_t qvortex_lite_absorbv(uint64_t state[QVORTEX_LITE_STATE_WORDS], const uint8_t sbox[256],
+                                    uint8_t buffer[QVORTEX_LITE_BLOCK_BYTES], size_t used,
+                                    const struct iovec *iov, int iovcnt) {
+   const qvortex_backend *b = qvortex_backend_get();
+ 
+   for (int v = 0; v < iovcnt; v++) {
+     const uint8_t *p = (const uint8_t *)iov[v].iov_base;
+     size_t len = iov[v].iov_len;
+     if (len == 0) continue;
+     QVORTEX_STAT_ADD(bytes, len);
+ 
+     if (used > 0) {
+       size_t n = QVORTEX_LITE_BLOCK_BYTES - used;
+       if (n > len) n = len;
+       memcpy(buffer + used, p, n);
+       QVORTEX_STAT_ADD(tail_copies, 1);
+       used += n;
+       p += n;
+       len -= n;
+       if (used < QVORTEX_LITE_BLOCK_BYTES) continue;
+       b->compress(state, sbox, buffer, 1);
+       used = 0;
+     }
+ 
+     size_t nblocks = len / QVORTEX_LITE_BLOCK_BYTES;
+     if (nblocks > 0) {
+       b->compress(state, sbox, p, nblocks);
+       p += nblocks * QVORTEX_LITE_BLOCK_BYTES;
+       len -= nblocks * QVORTEX_LITE_BLOCK_BYTES;
+     }
+     if (len > 0) {
+       memcpy(buffer, p, len);
+       QVORTEX_STAT_ADD(tail_copies, 1);
+       used = len;
+     }
+   }
+   return used;
+ }
+ 
+ static inline uint64_t qvortex_iov_total(const struct iovec *iov, int iovcnt) {
+   uint64_t total = 0;
+   for (int v = 0; v < iovcnt; v++) total += iov[v].iov_len;
+   return total;
+ }
+ 
+ static inline void qvortex_lite_updatev(qvortex_lite_ctx *ctx, const struct iovec *iov, int iovcnt) {
+   ctx->total_len += qvortex_iov_total(iov, iovcnt);
+   ctx->buffer_len = qvortex_lite_absorbv(ctx->state, ctx->sbox, ctx->buffer, ctx->buffer_len,
+                                          iov, iovcnt);
+ }
+ 
+ static void qvortex_lite_hashv(const qvortex_template *tpl, const struct iovec *iov, int iovcnt,
+                                uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   uint64_t state[QVORTEX_LITE_STATE_WORDS];
+   uint8_t buffer[QVORTEX_LITE_BLOCK_BYTES];
+ 
+   memcpy(state, tpl->state, sizeof(state));
+   size_t used = qvortex_lite_absorbv(state, tpl->sbox, buffer, 0, iov, iovcnt);
+   qvortex_lite_compress_tail(state, tpl->sbox, buffer, used, qvortex_iov_total(iov, iovcnt));
+   memcpy(out, state, QVORTEX_LITE_DIGEST_BYTES);
+   memset(buffer, 0, sizeof(buffer));
+ }
+ 
+ /*
+  * 64-bit table hash: the XOR of the eight digest words. A plain prefix
+  * will not do, because the even and odd words come from the two separate
+  * ARX chains, each of which sees only half of the last block.
+  */
+ static inline uint64_t qvortex_lite_hash64(const qvortex_template *tpl,
+                                            const uint8_t *data, size_t len) {
+   uint64_t state[QVORTEX_LITE_STATE_WORDS];
+   qvortex_lite_hash_state(tpl, data, len, state);
+   return state[0] ^ state[1] ^ state[2] ^ state[3] ^
+          state[4] ^ state[5] ^ state[6] ^ state[7];
+ }
+ 
+ /* ---- Wide variant ---- */
+ 
+ /* Longest message that pads into a single wide block */
+ #define QVORTEX_WIDE_SHORT_MAX (QVORTEX_WIDE_BLOCK_BYTES - 9)
+ 
+ /* SHA-512 IV followed by the SHA-384 IV */
+ static const uint64_t QW_IV[QVORTEX_WIDE_STATE_WORDS] = {
+   0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+   0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL,
+   0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL, 0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+   0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL, 0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL
+ };
+ 
+ static inline void qvortex_lite_wide_init(qvortex_wide_ctx *ctx, const qvortex_template *tpl) {
+   memcpy(ctx->state, QW_IV, sizeof(ctx->state));
+   memcpy(ctx->sbox, tpl->sbox, sizeof(ctx->sbox));
+   ctx->buffer_len = 0;
+   ctx->total_len = 0;
+ }
+ 
+ static inline void qvortex_lite_wide_update(qvortex_wide_ctx *ctx, const uint8_t *data, size_t len) {
+   const qvortex_backend *b = qvortex_backend_get();
+   QVORTEX_STAT_ADD(bytes, len);
+   ctx->total_len += len;
+ 
+   if (ctx->buffer_len > 0) {
+     size_t n = QVORTEX_WIDE_BLOCK_BYTES - ctx->buffer_len;
+     if (n > len) n = len;
+     memcpy(ctx->buffer + ctx->buffer_len, data, n);
+     QVORTEX_STAT_ADD(tail_copies, 1);
+     ctx->buffer_len += n;
+     data += n;
+     len -= n;
+     if (ctx->buffer_len < QVORTEX_WIDE_BLOCK_BYTES) return;
+     b->compress_wide(ctx->state, ctx->sbox, ctx->buffer, 1);
+     ctx->buffer_len = 0;
+   }
+ 
+   if (len >= QVORTEX_WIDE_BLOCK_BYTES) {
+     size_t nblocks = len / QVORTEX_WIDE_BLOCK_BYTES;
+     b->compress_wide(ctx->state, ctx->sbox, data, nblocks);
+     data += nblocks * QVORTEX_WIDE_BLOCK_BYTES;
+     len -= nblocks * QVORTEX_WIDE_BLOCK_BYTES;
+   }
+ 
+   if (len > 0) {
+     memcpy(ctx->buffer, data, len);
+     QVORTEX_STAT_ADD(tail_copies, 1);
+     ctx->buffer_len = len;
+   }
+ }
+ 
+ /* Same padding as Qvortex: 0x80, zeros, then the 64-bit bit length */
+ static inline void qvortex_lite_wide_final(qvortex_wide_ctx *ctx,
+                                            uint8_t out[QVORTEX_WIDE_DIGEST_BYTES]) {
+   size_t nblocks = ctx->buffer_len <= QVORTEX_WIDE_SHORT_MAX ? 1 : 2;
+   uint64_t block[2 * QVORTEX_WIDE_BLOCK_BYTES / 8] = {0};
+ 
+   if (ctx->buffer_len > 0) memcpy(block, ctx->buffer, ctx->buffer_len);
+   ((uint8_t *)block)[ctx->buffer_len] = 0x80;
+   block[nblocks * QVORTEX_WIDE_BLOCK_BYTES / 8 - 1] = ctx->total_len * 8;
+   qvortex_backend_get()->compress_wide(ctx->state, ctx->sbox, (const uint8_t *)block, nblocks);
+ 
+   memcpy(out, ctx->state, QVORTEX_WIDE_DIGEST_BYTES);
+   memset(ctx, 0, sizeof(*ctx));
+ }
+ 
+ /* ------------------------------------------------------------------------
+    Shared Keys and Compact Contexts
+    ------------------------------------------------------------------------ */
+ 
+ typedef struct qvortex_key qvortex_key;
+ typedef struct qvortex_ctx qvortex_ctx;
+ 
+ /* A keyed template shared by reference between contexts */
+ struct qvortex_key {
+   qvortex_template tpl;
+   uint64_t id;
+   uint32_t refs;
+ };
+ 
+ /*
+  * Streaming context without a private S-box: the state and the block
+  * buffer fill one 64-byte-aligned pair of cache lines, and the buffer
+  * always holds the last total_len % 64 bytes.
+  */
+ struct qvortex_ctx {
+   uint64_t state[QVORTEX_LITE_STATE_WORDS];
+   uint8_t buffer[QVORTEX_LITE_BLOCK_BYTES];
+   qvortex_key *key;
+   uint64_t total_len;
+ } __attribute__((aligned(QVORTEX_CTX_ALIGN)));
+ 
+ static void *qvortex_aligned_alloc(size_t align, size_t size) {
+ #if defined(_WIN32)
+   return _aligned_malloc(size, align);
+ #else
+   void *p;
+   return posix_memalign(&p, align, size) == 0 ? p : NULL;
+ #endif
+ }
+ 
+ static void qvortex_aligned_free(void *p) {
+ #if defined(_WIN32)
+   _aligned_free(p);
+ #else
+   free(p);
+ #endif
+ }
+ 
+ static qvortex_key *qvortex_lite_key_new(const uint8_t *key, size_t key_len) {
+   qvortex_key *k = (qvortex_key *)malloc(sizeof(*k));
+   if (!k) return NULL;
+ 
+   qvortex_lite_template_init(&k->tpl, key, key_len);
+   /* Names the key in checkpoints without revealing the S-box */
+   k->id = qvortex_lite_hash64(&k->tpl, k->tpl.sbox, sizeof(k->tpl.sbox));
+   k->refs = 1;
+   return k;
+ }
+ 
+ static inline void qvortex_lite_key_retain(qvortex_key *k) {
+   __atomic_fetch_add(&k->refs, 1, __ATOMIC_RELAXED);
+ }
+ 
+ static inline void qvortex_lite_key_release(qvortex_key *k) {
+   if (__atomic_sub_fetch(&k->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+     memset(&k->tpl, 0, sizeof(k->tpl));
+     free(k);
+   }
+ }
+ 
+ static inline void qvortex_lite_cctx_init(qvortex_ctx *ctx, qvortex_key *key) {
+   qvortex_lite_key_retain(key);
+   memcpy(ctx->state, key->tpl.state, sizeof(ctx->state));
+   ctx->key = key;
+   ctx->total_len = 0;
+ }
+ 
+ static inline void qvortex_lite_cctx_update(qvortex_ctx *ctx, const uint8_t *data, size_t len) {
+   const qvortex_backend *b = qvortex_backend_get();
+   const uint8_t *sbox = ctx->key->tpl.sbox;
+   size_t used = (size_t)(ctx->total_len % QVORTEX_LITE_BLOCK_BYTES);
+   QVORTEX_STAT_ADD(bytes, len);
+   ctx->total_len += len;
+ 
+   if (used > 0) {
+     size_t n = QVORTEX_LITE_BLOCK_BYTES - used;
+     if (n > len) n = len;
+     memcpy(ctx->buffer + used, data, n);
+     QVORTEX_STAT_ADD(tail_copies, 1);
+     data += n;
+     len -= n;
+     if (used + n < QVORTEX_LITE_BLOCK_BYTES) return;
+     b->compress(ctx->state, sbox, ctx->buffer, 1);
+   }
+ 
+   if (len >= QVORTEX_LITE_BLOCK_BYTES) {
+     size_t nblocks = len / QVORTEX_LITE_BLOCK_BYTES;
+     b->compress(ctx->state, sbox, data, nblocks);
+     data += nblocks * QVORTEX_LITE_BLOCK_BYTES;
+     len -= nblocks * QVORTEX_LITE_BLOCK_BYTES;
+   }
+ 
+   if (len > 0) {
+     memcpy(ctx->buffer, data, len);
+     QVORTEX_STAT_ADD(tail_copies, 1);
+   }
+ }
+ 
+ static inline void qvortex_lite_cctx_updatev(qvortex_ctx *ctx, const struct iovec *iov, int iovcnt) {
+   size_t used = (size_t)(ctx->total_len % QVORTEX_LITE_BLOCK_BYTES);
+   ctx->total_len += qvortex_iov_total(iov, iovcnt);
+   (void)qvortex_lite_absorbv(ctx->state, ctx->key->tpl.sbox, ctx->buffer, used, iov, iovcnt);
+ }
+ 
+ /*
+  * Fork a stream: the state, counters and only the live part of the
+  * buffer are copied, and the fork takes its own reference to the key.
+  */
+ static inline void qvortex_lite_cctx_clone(qvortex_ctx *dst, const qvortex_ctx *src) {
+   size_t used = (size_t)(src->total_len % QVORTEX_LITE_BLOCK_BYTES);
+   memcpy(dst->state, src->state, sizeof(dst->state));
+   memcpy(dst->buffer, src->buffer, used);
+   dst->key = src->key;
+   dst->total_len = src->total_len;
+   qvortex_lite_key_retain(dst->key);
+ }
+ 
+ /* Drop the key reference and wipe the context */
+ static inline void qvortex_lite_cctx_discard(qvortex_ctx *ctx) {
+   if (ctx->key) qvortex_lite_key_release(ctx->key);
+   memset(ctx, 0, sizeof(*ctx));
+ }
+ 
+ static inline void qvortex_lite_cctx_final(qvortex_ctx *ctx, uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   qvortex_lite_compress_tail(ctx->state, ctx->key->tpl.sbox, ctx->buffer,
+                              (size_t)(ctx->total_len % QVORTEX_LITE_BLOCK_BYTES), ctx->total_len);
+   memcpy(out, ctx->state, QVORTEX_LITE_DIGEST_BYTES);
+   qvortex_lite_cctx_discard(ctx);
+ }
+ 
+ /* ---- Checkpoints ---- */
+ 
+ /*
+  * Serialized context, all integers little-endian:
+  *
+  *   0   4  magic "QVC" and format version
+  *   4   8  key id (qvortex_key_id)
+  *   12  8  total_len
+  *   20  64 state words
+  *   84  -  buffered tail, total_len % 64 bytes
+  */
+ #define QVORTEX_CTX_EXPORT_VERSION 1
+ #define QVORTEX_CTX_EXPORT_HEADER 84
+ #define QVORTEX_CTX_EXPORT_MAX (QVORTEX_CTX_EXPORT_HEADER + QVORTEX_LITE_BLOCK_BYTES - 1)
+ 
+ static const uint8_t QVORTEX_CTX_MAGIC[4] = { 'Q', 'V', 'C', QVORTEX_CTX_EXPORT_VERSION };
+ 
+ static inline void qvortex_store_le64(uint8_t *p, uint64_t v) {
+   for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+ }
+ 
+ static inline uint64_t qvortex_load_le64(const uint8_t *p) {
+   uint64_t v = 0;
+   for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+   return v;
+ }
+ 
+ static size_t qvortex_lite_cctx_export(const qvortex_ctx *ctx, uint8_t out[QVORTEX_CTX_EXPORT_MAX]) {
+   size_t tail = (size_t)(ctx->total_len % QVORTEX_LITE_BLOCK_BYTES);
+ 
+   memcpy(out, QVORTEX_CTX_MAGIC, sizeof(QVORTEX_CTX_MAGIC));
+   qvortex_store_le64(out + 4, ctx->key->id);
+   qvortex_store_le64(out + 12, ctx->total_len);
+   for (int i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
+     qvortex_store_le64(out + 20 + 8 * i, ctx->state[i]);
+   }
+   memcpy(out + QVORTEX_CTX_EXPORT_HEADER, ctx->buffer, tail);
+   return QVORTEX_CTX_EXPORT_HEADER + tail;
+ }
+ 
+ /* Validates everything before touching ctx */
+ static int qvortex_lite_cctx_import(qvortex_ctx *ctx, qvortex_key *key,
+                                     const uint8_t *in, size_t len) {
+   if (len < QVORTEX_CTX_EXPORT_HEADER) return QVORTEX_ERROR_FORMAT;
+   if (memcmp(in, QVORTEX_CTX_MAGIC, sizeof(QVORTEX_CTX_MAGIC)) != 0) return QVORTEX_ERROR_FORMAT;
+   if (qvortex_load_le64(in + 4) != key->id) return QVORTEX_ERROR_FORMAT;
+ 
+   uint64_t total_len = qvortex_load_le64(in + 12);
+   size_t tail = (size_t)(total_len % QVORTEX_LITE_BLOCK_BYTES);
+   if (len != QVORTEX_CTX_EXPORT_HEADER + tail) return QVORTEX_ERROR_FORMAT;
+ 
+   qvortex_lite_key_retain(key);
+   for (int i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
+     ctx->state[i] = qvortex_load_le64(in + 20 + 8 * i);
+   }
+   memcpy(ctx->buffer, in + QVORTEX_CTX_EXPORT_HEADER, tail);
+   ctx->key = key;
+   ctx->total_len = total_len;
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /* ------------------------------------------------------------------------
+    Multi-Buffer Batch Hashing
+    ------------------------------------------------------------------------ */
+ 
+ /* Per-lane cursor: full blocks straight from the message, then padded tail */
+ typedef struct {
+   const uint8_t *data;
+   size_t full_blocks;
+   size_t tail_blocks;
+   size_t tail_off;
+   size_t index;                               /* message index, SIZE_MAX when idle */
+   uint8_t tail[2 * QVORTEX_LITE_BLOCK_BYTES];
+ } qvortex_lane;
+ 
+ /* Same padding as qvortex_lite_final, built up front */
+ static inline void qvortex_lane_start(qvortex_lane *lane, const uint8_t *msg,
+                                       size_t len, size_t index) {
+   size_t rem = len % QVORTEX_LITE_BLOCK_BYTES;
+   uint64_t total_bits = (uint64_t)len * 8;
+ 
+   lane->data = msg;
+   lane->full_blocks = len / QVORTEX_LITE_BLOCK_BYTES;
+   lane->tail_blocks = (rem + 1 + 8 <= QVORTEX_LITE_BLOCK_BYTES) ? 1 : 2;
+   lane->tail_off = 0;
+   lane->index = index;
+   QVORTEX_STAT_ADD(bytes, len);
+ 
+   memset(lane->tail, 0, sizeof(lane->tail));
+   if (rem > 0) memcpy(lane->tail, msg + len - rem, rem);
+   lane->tail[rem] = 0x80;
+   memcpy(&lane->tail[lane->tail_blocks * QVORTEX_LITE_BLOCK_BYTES - 8], &total_bits, 8);
+ }
+ 
+ static void qvortex_lite_hash_many(const qvortex_template *tpl,
+                                    const uint8_t *const *msgs, const size_t *lens,
+                                    size_t n, uint8_t *out) {
+   static const uint8_t idle_block[QVORTEX_LITE_BLOCK_BYTES] = {0};
+   const qvortex_backend *be = qvortex_backend_get();
+   const size_t lanes = be->lanes;
+   uint64_t state[QVORTEX_LITE_STATE_WORDS][QVORTEX_MAX_LANES];
+   const uint8_t *blocks[QVORTEX_MAX_LANES];
+   qvortex_lane lane[QVORTEX_MAX_LANES];
+   size_t next = 0, active = 0, l;
+   int i;
+ 
+   memset(state, 0, sizeof(state));
+   for (l = 0; l < lanes; l++) {
+     lane[l].index = SIZE_MAX;
+     blocks[l] = idle_block;
+   }
+ 
+   for (;;) {
+     /* Refill idle lanes with the next messages */
+     for (l = 0; l < lanes && next < n; l++) {
+       if (lane[l].index != SIZE_MAX) continue;
+       qvortex_lane_start(&lane[l], msgs[next], lens[next], next);
+       for (i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
+         state[i][l] = tpl->state[i];
+       }
+       next++;
+       active++;
+     }
+     if (active == 0) break;
+ 
+     /* A lone straggler finishes faster on the single-stream kernel */
+     if (active == 1 && next == n) {
+       for (l = 0; lane[l].index == SIZE_MAX; l++) {}
+       uint64_t st[QVORTEX_LITE_STATE_WORDS];
+       for (i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) st[i] = state[i][l];
+       be->compress(st, tpl->sbox, lane[l].data, lane[l].full_blocks);
+       be->compress(st, tpl->sbox, lane[l].tail + lane[l].tail_off, lane[l].tail_blocks);
+       memcpy(out + lane[l].index * QVORTEX_LITE_DIGEST_BYTES, st, QVORTEX_LITE_DIGEST_BYTES);
+       break;
+     }
+ 
+     for (l = 0; l < lanes; l++) {
+       if (lane[l].index == SIZE_MAX) {
+         blocks[l] = idle_block;
+       } else if (lane[l].full_blocks > 0) {
+         blocks[l] = lane[l].data;
+       } else {
+         blocks[l] = lane[l].tail + lane[l].tail_off;
+       }
+     }
+ 
+     be->compress_multi(state, tpl->sbox, blocks);
+     QVORTEX_STAT_ADD(blocks, lanes);
+ 
+     /* Advance cursors and emit finished digests */
+     for (l = 0; l < lanes; l++) {
+       qvortex_lane *ln = &lane[l];
+       if (ln->index == SIZE_MAX) continue;
+ 
+       if (ln->full_blocks > 0) {
+         ln->data += QVORTEX_LITE_BLOCK_BYTES;
+         ln->full_blocks--;
+         continue;
+       }
+       ln->tail_off += QVORTEX_LITE_BLOCK_BYTES;
+       if (--ln->tail_blocks > 0) continue;
+ 
+       uint8_t *dst = out + ln->index * QVORTEX_LITE_DIGEST_BYTES;
+       for (i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) {
+         memcpy(dst + i * 8, &state[i][l], 8);
+       }
+       ln->index = SIZE_MAX;
+       active--;
+     }
+   }
+ 
+   /* Tails hold message bytes; don't leave them on the stack */
+   memset(lane, 0, sizeof(lane));
+ }
+ 
+ /* ---- Tag verification ---- */
+ 
+ /* Messages hashed per hash_many call while verifying (64 digests, 4 KiB of stack) */
+ #define QVORTEX_VERIFY_BATCH 64
+ 
+ /* 1 if the first len bytes match, 0 otherwise, in time independent of the contents */
+ static inline uint32_t qvortex_ct_equal(const uint8_t *a, const uint8_t *b, size_t len) {
+   uint32_t diff = 0;
+   for (size_t i = 0; i < len; i++) diff |= (uint32_t)(a[i] ^ b[i]);
+   return (uint32_t)((diff - 1) >> 31);
+ }
+ 
+ /* Set bit i of bitmap for each message whose tag matches, clear it otherwise */
+ static void qvortex_lite_verify_many(const qvortex_template *tpl,
+                                      const uint8_t *const *msgs, const size_t *lens,
+                                      const uint8_t *const *tags, size_t tag_len,
+                                      size_t n, uint8_t *bitmap) {
+   uint8_t digests[QVORTEX_VERIFY_BATCH * QVORTEX_LITE_DIGEST_BYTES];
+ 
+   memset(bitmap, 0, (n + 7) / 8);
+   for (size_t base = 0; base < n; base += QVORTEX_VERIFY_BATCH) {
+     size_t m = n - base < QVORTEX_VERIFY_BATCH ? n - base : QVORTEX_VERIFY_BATCH;
+     qvortex_lite_hash_many(tpl, msgs + base, lens + base, m, digests);
+ 
+     for (size_t j = 0; j < m; j++) {
+       size_t i = base + j;
+       uint32_t ok = qvortex_ct_equal(digests + j * QVORTEX_LITE_DIGEST_BYTES, tags[i], tag_len);
+       bitmap[i / 8] |= (uint8_t)(ok << (i % 8));
+     }
+   }
+   memset(digests, 0, sizeof(digests));
+ }
+ 
+ /* ------------------------------------------------------------------------
+    Tree Hashing Mode
+    ------------------------------------------------------------------------ */
+ 
+ /*
+  * A separate digest, not interchangeable with qvortex_hash. The input is
+  * cut into 8 KiB chunks; each chunk is a leaf hashed with the normal
+  * compression function, and chaining values (the full 512-bit state) are
+  * combined pairwise by parent nodes. The tree has the BLAKE3 shape: the left
+  * subtree of any node holds the largest power-of-two number of chunks that
+  * leaves at least one chunk on the right, so the streaming CV stack and a
+  * parallel split produce the same root.
+  *
+  * Domain separation is a tweak of the starting state: word 7 gets the tree
+  * tag and node flags, and leaves also fold their chunk index into word 6.
+  */
+ #define QVORTEX_TREE_DOMAIN 0x5174726565000000ULL  /* "Qtree" */
+ #define QVORTEX_TREE_LEAF   0x01ULL
+ #define QVORTEX_TREE_PARENT 0x02ULL
+ #define QVORTEX_TREE_ROOT   0x04ULL
+ 
+ static inline void qvortex_tree_node_state(uint64_t st[QVORTEX_LITE_STATE_WORDS],
+                                            const qvortex_template *tpl,
+                                            uint64_t index, uint64_t flags) {
+   memcpy(st, tpl->state, sizeof(tpl->state));
+   st[6] ^= index;
+   st[7] ^= QVORTEX_TREE_DOMAIN | flags;
+ }
+ 
+ /* Any single leaf, including a short final chunk */
+ static void qvortex_tree_leaf(const qvortex_template *tpl, const uint8_t *data, size_t len,
+                               uint64_t index, uint64_t flags,
+                               uint64_t cv[QVORTEX_LITE_STATE_WORDS]) {
+   qvortex_lite_ctx ctx;
+   uint8_t out[QVORTEX_LITE_DIGEST_BYTES];
+ 
+   qvortex_lite_init_from_template(&ctx, tpl);
+   qvortex_tree_node_state(ctx.state, tpl, index, QVORTEX_TREE_LEAF | flags);
+   qvortex_lite_update(&ctx, data, len);
+   qvortex_lite_final(&ctx, out);
+   memcpy(cv, out, sizeof(out));
+ }
+ 
+ static void qvortex_tree_parent(const qvortex_template *tpl,
+                                 const uint64_t left[QVORTEX_LITE_STATE_WORDS],
+                                 const uint64_t right[QVORTEX_LITE_STATE_WORDS],
+                                 uint64_t flags, uint64_t cv[QVORTEX_LITE_STATE_WORDS]) {
+   uint8_t block[2 * QVORTEX_LITE_BLOCK_BYTES];
+   uint64_t st[QVORTEX_LITE_STATE_WORDS];
+ 
+   memcpy(block, left, QVORTEX_LITE_BLOCK_BYTES);
+   memcpy(block + QVORTEX_LITE_BLOCK_BYTES, right, QVORTEX_LITE_BLOCK_BYTES);
+   qvortex_tree_node_state(st, tpl, 0, QVORTEX_TREE_PARENT | flags);
+   qvortex_backend_get()->compress(st, tpl->sbox, block, 2);
+   memcpy(cv, st, sizeof(st));
+ }
+ 
+ /*
+  * Chaining values of `count` consecutive full chunks, several at a time on
+  * the multi-buffer kernel. Full chunks all have the same length, so the
+  * lanes run in lockstep: 128 message blocks, then one shared padding block.
+  */
+ static void qvortex_tree_leaves(const qvortex_template *tpl, const uint8_t *data,
+                                 uint64_t first, size_t count,
+                                 uint64_t cvs[][QVORTEX_LITE_STATE_WORDS]) {
+   const qvortex_backend *be = qvortex_backend_get();
+   const size_t lanes = be->lanes;
+   uint64_t state[QVORTEX_LITE_STATE_WORDS][QVORTEX_MAX_LANES];
+   const uint8_t *blocks[QVORTEX_MAX_LANES];
+   uint8_t pad[QVORTEX_LITE_BLOCK_BYTES] = {0x80};
+   uint64_t total_bits = (uint64_t)QVORTEX_TREE_CHUNK_BYTES * 8;
+   size_t done = 0, l;
+   int i;
+ 
+   memcpy(&pad[QVORTEX_LITE_BLOCK_BYTES - 8], &total_bits, 8);
+ 
+   for (; done + lanes <= count; done += lanes) {
+     for (l = 0; l < lanes; l++) {
+       uint64_t st[QVORTEX_LITE_STATE_WORDS];
+       qvortex_tree_node_state(st, tpl, first + done + l, QVORTEX_TREE_LEAF);
+       for (i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) state[i][l] = st[i];
+     }
+     for (size_t off = 0; off < QVORTEX_TREE_CHUNK_BYTES; off += QVORTEX_LITE_BLOCK_BYTES) {
+       for (l = 0; l < lanes; l++) {
+         blocks[l] = data + (done + l) * QVORTEX_TREE_CHUNK_BYTES + off;
+       }
+       be->compress_multi(state, tpl->sbox, blocks);
+     }
+     for (l = 0; l < lanes; l++) blocks[l] = pad;
+     be->compress_multi(state, tpl->sbox, blocks);
+     QVORTEX_STAT_ADD(blocks, lanes * (QVORTEX_TREE_CHUNK_BYTES / QVORTEX_LITE_BLOCK_BYTES + 1));
+     QVORTEX_STAT_ADD(bytes, lanes * QVORTEX_TREE_CHUNK_BYTES);
+     for (l = 0; l < lanes; l++) {
+       for (i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) cvs[done + l][i] = state[i][l];
+     }
+   }
+ 
+   for (; done < count; done++) {
+     qvortex_tree_leaf(tpl, data + done * QVORTEX_TREE_CHUNK_BYTES,
+                       QVORTEX_TREE_CHUNK_BYTES, first + done, 0, cvs[done]);
+   }
+ }
+ 
+ /* Root CV of a complete, non-root subtree of 2^k full chunks (2^k <= QVORTEX_TREE_TASK_CHUNKS) */
+ static void qvortex_tree_subtree(const qvortex_template *tpl, const uint8_t *data,
+                                  uint64_t first, size_t count,
+                                  uint64_t cv[QVORTEX_LITE_STATE_WORDS]) {
+   uint64_t cvs[QVORTEX_TREE_TASK_CHUNKS][QVORTEX_LITE_STATE_WORDS];
+ 
+   qvortex_tree_leaves(tpl, data, first, count, cvs);
+   for (; count > 1; count /= 2) {
+     for (size_t i = 0; i < count / 2; i++) {
+       qvortex_tree_parent(tpl, cvs[2 * i], cvs[2 * i + 1], 0, cvs[i]);
+     }
+   }
+   memcpy(cv, cvs[0], sizeof(cvs[0]));
+ }
+ 
+ /* ---- Work-stealing pool ---- */
+ 
+ typedef void (*qvortex_task_fn)(void *arg, size_t task);
+ 
+ #if HAVE_PTHREADS
+ /* Each participant owns a deque of task indices; thieves take from the back */
+ typedef struct {
+   pthread_mutex_t lock;
+   size_t head;
+   size_t tail;
+ } qvortex_deque;
+ 
+ typedef struct qvortex_pool {
+   int nworkers;                  /* background threads; the caller also works */
+   int ndeques;
+   pthread_t *threads;
+   qvortex_deque *deques;         /* nworkers + 1 in use, the last one is the caller's */
+   pthread_mutex_t lock;
+   pthread_cond_t work_cond;
+   pthread_cond_t done_cond;
+   uint64_t generation;
+   size_t remaining;
+   int busy_workers;
+   int shutdown;
+   qvortex_task_fn fn;
+   void *arg;
+ } qvortex_pool;
+ 
+ static int qvortex_deque_pop(qvortex_deque *q, size_t *task, int steal) {
+   int found = 0;
+   pthread_mutex_lock(&q->lock);
+   if (q->head < q->tail) {
+     *task = steal ? --q->tail : q->head++;
+     found = 1;
+   }
+   pthread_mutex_unlock(&q->lock);
+   return found;
+ }
+ 
+ /* Drain own deque, then steal until every deque is empty */
+ static void qvortex_pool_work(qvortex_pool *pool, int self) {
+   const int nq = pool->nworkers + 1;
+   size_t task, finished = 0;
+ 
+   for (;;) {
+     int found = qvortex_deque_pop(&pool->deques[self], &task, 0);
+     for (int v = 1; !found && v < nq; v++) {
+       found = qvortex_deque_pop(&pool->deques[(self + v) % nq], &task, 1);
+     }
+     if (!found) break;
+     pool->fn(pool->arg, task);
+     finished++;
+   }
+ 
+   if (finished > 0) {
+     pthread_mutex_lock(&pool->lock);
+     pool->remaining -= finished;
+     if (pool->remaining == 0) pthread_cond_broadcast(&pool->done_cond);
+     pthread_mutex_unlock(&pool->lock);
+   }
+ }
+ 
+ static void *qvortex_pool_thread(void *p) {
+   qvortex_pool *pool = (qvortex_pool *)p;
+   uint64_t seen = 0;
+   int self;
+ 
+   pthread_mutex_lock(&pool->lock);
+   for (self = 0; !pthread_equal(pool->threads[self], pthread_self()); self++) {}
+   for (;;) {
+     while (!pool->shutdown && pool->generation == seen) {
+       pthread_cond_wait(&pool->work_cond, &pool->lock);
+     }
+     if (pool->shutdown) break;
+     seen = pool->generation;
+     pool->busy_workers++;
+     pthread_mutex_unlock(&pool->lock);
+ 
+     qvortex_pool_work(pool, self);
+ 
+     pthread_mutex_lock(&pool->lock);
+     if (--pool->busy_workers == 0) pthread_cond_broadcast(&pool->done_cond);
+   }
+   pthread_mutex_unlock(&pool->lock);
+   return NULL;
+ }
+ 
+ static void qvortex_pool_destroy(qvortex_pool *pool);
+ 
+ static qvortex_pool *qvortex_pool_create(int nworkers) {
+   qvortex_pool *pool = (qvortex_pool *)calloc(1, sizeof(qvortex_pool));
+   if (!pool) return NULL;
+ 
+   pool->threads = (pthread_t *)calloc((size_t)nworkers, sizeof(pthread_t));
+   pool->deques = (qvortex_deque *)calloc((size_t)nworkers + 1, sizeof(qvortex_deque));
+   if (!pool->threads || !pool->deques) {
+     free(pool->threads);
+     free(pool->deques);
+     free(pool);
+     return NULL;
+   }
+   pool->ndeques = nworkers + 1;
+   for (int i = 0; i < pool->ndeques; i++) pthread_mutex_init(&pool->deques[i].lock, NULL);
+   pthread_mutex_init(&pool->lock, NULL);
+   pthread_cond_init(&pool->work_cond, NULL);
+   pthread_cond_init(&pool->done_cond, NULL);
+ 
+   /* Hold the lock so workers see every thread id before looking themselves up */
+   pthread_mutex_lock(&pool->lock);
+   for (int i = 0; i < nworkers; i++) {
+     if (pthread_create(&pool->threads[i], NULL, qvortex_pool_thread, pool) != 0) break;
+     pool->nworkers++;
+   }
+   pthread_mutex_unlock(&pool->lock);
+ 
+   if (pool->nworkers == 0) {
+     qvortex_pool_destroy(pool);
+     return NULL;
+   }
+   return pool;
+ }
+ 
+ static void qvortex_pool_destroy(qvortex_pool *pool) {
+   if (!pool) return;
+ 
+   pthread_mutex_lock(&pool->lock);
+   pool->shutdown = 1;
+   pthread_cond_broadcast(&pool->work_cond);
+   pthread_mutex_unlock(&pool->lock);
+   for (int i = 0; i < pool->nworkers; i++) pthread_join(pool->threads[i], NULL);
+ 
+   for (int i = 0; i < pool->ndeques; i++) pthread_mutex_destroy(&pool->deques[i].lock);
+   pthread_mutex_destroy(&pool->lock);
+   pthread_cond_destroy(&pool->work_cond);
+   pthread_cond_destroy(&pool->done_cond);
+   free(pool->threads);
+   free(pool->deques);
+   free(pool);
+ }
+ 
+ /* Run fn(arg, 0..ntasks-1) across the pool and the calling thread */
+ static void qvortex_pool_run(qvortex_pool *pool, qvortex_task_fn fn, void *arg, size_t ntasks) {
+   const int nq = pool->nworkers + 1;
+ 
+   if (ntasks <= 1) {
+     if (ntasks == 1) fn(arg, 0);
+     return;
+   }
+ 
+   pthread_mutex_lock(&pool->lock);
+   pool->fn = fn;
+   pool->arg = arg;
+   pool->remaining = ntasks;
+ 
+   /*
+    * Contiguous ranges keep neighbouring chunks on one core until stolen.
+    * A worker that slept through the previous round may already be popping,
+    * so fill each deque under its lock.
+    */
+   for (int q = 0; q < nq; q++) {
+     pthread_mutex_lock(&pool->deques[q].lock);
+     pool->deques[q].head = ntasks * (size_t)q / (size_t)nq;
+     pool->deques[q].tail = ntasks * (size_t)(q + 1) / (size_t)nq;
+     pthread_mutex_unlock(&pool->deques[q].lock);
+   }
+   pool->generation++;
+   pthread_cond_broadcast(&pool->work_cond);
+   pthread_mutex_unlock(&pool->lock);
+ 
+   qvortex_pool_work(pool, nq - 1);
+ 
+   /* Wait for stolen tasks to finish and for workers to leave the deques */
+   pthread_mutex_lock(&pool->lock);
+   while (pool->remaining > 0 || pool->busy_workers > 0) {
+     pthread_cond_wait(&pool->done_cond, &pool->lock);
+   }
+   pthread_mutex_unlock(&pool->lock);
+ }
+ #else
+ typedef struct qvortex_pool qvortex_pool;
+ #endif /* HAVE_PTHREADS */
+ 
+ /* ---- Streaming tree context ---- */
+ 
+ struct qvortex_tree_ctx {
+   qvortex_template tpl;
+   uint8_t chunk[QVORTEX_TREE_CHUNK_BYTES];     /* partial or held-back last chunk */
+   size_t chunk_len;
+   uint64_t chunks;                             /* chunks already folded into cv_stack */
+   uint64_t cv_stack[QVORTEX_TREE_MAX_DEPTH][QVORTEX_LITE_STATE_WORDS];
+   size_t cv_depth;
+   qvortex_pool *pool;                          /* NULL when single-threaded */
+ };
+ typedef struct qvortex_tree_ctx qvortex_tree_ctx;
+ 
+ /* Popcount of the chunk count is the number of complete subtrees pending */
+ static inline size_t qvortex_popcount64(uint64_t x) {
+   size_t n = 0;
+   for (; x; x &= x - 1) n++;
+   return n;
+ }
+ 
+ /*
+  * Push the CV of an aligned subtree of `count` chunks, then merge every
+  * subtree that is now complete. Callers only push chunks that are known
+  * to be followed by more input, so none of these merges can be the root.
+  */
+ static void qvortex_tree_push(qvortex_tree_ctx *ctx, const uint64_t cv[QVORTEX_LITE_STATE_WORDS],
+                               uint64_t count) {
+   memcpy(ctx->cv_stack[ctx->cv_depth++], cv, QVORTEX_LITE_BLOCK_BYTES);
+   ctx->chunks += count;
+ 
+   while (ctx->cv_depth > qvortex_popcount64(ctx->chunks)) {
+     ctx->cv_depth--;
+     qvortex_tree_parent(&ctx->tpl, ctx->cv_stack[ctx->cv_depth - 1],
+                         ctx->cv_stack[ctx->cv_depth], 0,
+                         ctx->cv_stack[ctx->cv_depth - 1]);
+   }
+ }
+ 
+ typedef struct {
+   const qvortex_template *tpl;
+   const uint8_t *data;
+   uint64_t first;                          /* chunk index of data[0] */
+   const uint64_t *task_first;              /* per task: offset in chunks */
+   const size_t *task_count;                /* per task: power-of-two chunk count */
+   uint64_t (*cvs)[QVORTEX_LITE_STATE_WORDS];
+ } qvortex_tree_job;
+ 
+ static void qvortex_tree_run_task(void *arg, size_t task) {
+   qvortex_tree_job *job = (qvortex_tree_job *)arg;
+   uint64_t off = job->task_first[task];
+   qvortex_tree_subtree(job->tpl, job->data + off * QVORTEX_TREE_CHUNK_BYTES,
+                        job->first + off, job->task_count[task], job->cvs[task]);
+ }
+ 
+ /* Maximum subtree tasks handed to the pool per round */
+ #define QVORTEX_TREE_BATCH_TASKS 256
+ 
+ /*
+  * Fold `count` full chunks (none of them the last chunk of the input) into
+  * the tree. They are split greedily into the largest aligned power-of-two
+  * subtrees, so every task is a complete subtree whose CV can be pushed as-is.
+  */
+ static void qvortex_tree_add_chunks(qvortex_tree_ctx *ctx, const uint8_t *data, size_t count) {
+   uint64_t task_first[QVORTEX_TREE_BATCH_TASKS];
+   size_t task_count[QVORTEX_TREE_BATCH_TASKS];
+   uint64_t (*cvs)[QVORTEX_LITE_STATE_WORDS];
+   uint64_t single[1][QVORTEX_LITE_STATE_WORDS];
+ 
+   cvs = ctx->pool ? (uint64_t (*)[QVORTEX_LITE_STATE_WORDS])malloc(
+             sizeof(uint64_t[QVORTEX_TREE_BATCH_TASKS][QVORTEX_LITE_STATE_WORDS])) : NULL;
+ 
+   while (count > 0) {
+     size_t ntasks = 0;
+     uint64_t pos = ctx->chunks, off = 0;
+ 
+     while (off < count && ntasks < (cvs ? QVORTEX_TREE_BATCH_TASKS : 1)) {
+       size_t size = QVORTEX_TREE_TASK_CHUNKS;
+       while (size > count - off || (pos + off) % size != 0) size /= 2;
+       task_first[ntasks] = off;
+       task_count[ntasks] = size;
+       ntasks++;
+       off += size;
+     }
+ 
+     qvortex_tree_job job = {&ctx->tpl, data, pos, task_first, task_count, cvs ? cvs : single};
+ #if HAVE_PTHREADS
+     if (ctx->pool) {
+       qvortex_pool_run(ctx->pool, qvortex_tree_run_task, &job, ntasks);
+     } else
+ #endif
+     {
+       qvortex_tree_run_task(&job, 0);
+     }
+ 
+     for (size_t t = 0; t < ntasks; t++) {
+       qvortex_tree_push(ctx, job.cvs[t], task_count[t]);
+     }
+     data += off * QVORTEX_TREE_CHUNK_BYTES;
+     count -= off;
+   }
+ 
+   free(cvs);
+ }
+ 
+ static void qvortex_lite_tree_update(qvortex_tree_ctx *ctx, const uint8_t *data, size_t len) {
+   if (len == 0) return;
+ 
+   /* A held-back full chunk is not the last one once more input arrives */
+   if (ctx->chunk_len == QVORTEX_TREE_CHUNK_BYTES) {
+     qvortex_tree_add_chunks(ctx, ctx->chunk, 1);
+     ctx->chunk_len = 0;
+   }
+ 
+   /* Top up a partial chunk */
+   if (ctx->chunk_len > 0) {
+     size_t take = QVORTEX_TREE_CHUNK_BYTES - ctx->chunk_len;
+     if (take > len) take = len;
+     memcpy(ctx->chunk + ctx->chunk_len, data, take);
+     ctx->chunk_len += take;
+     data += take;
+     len -= take;
+     if (len == 0) return;
+ 
+     qvortex_tree_add_chunks(ctx, ctx->chunk, 1);
+     ctx->chunk_len = 0;
+   }
+ 
+   /* Hash full chunks in place, always keeping the last (maybe root) chunk back */
+   size_t full = (len - 1) / QVORTEX_TREE_CHUNK_BYTES;
+   qvortex_tree_add_chunks(ctx, data, full);
+   data += full * QVORTEX_TREE_CHUNK_BYTES;
+   len -= full * QVORTEX_TREE_CHUNK_BYTES;
+ 
+   memcpy(ctx->chunk, data, len);
+   ctx->chunk_len = len;
+ }
+ 
+ static void qvortex_lite_tree_final(qvortex_tree_ctx *ctx, uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   uint64_t cv[QVORTEX_LITE_STATE_WORDS];
+ 
+   if (ctx->cv_depth == 0) {
+     /* The whole input is one chunk: the leaf is the root */
+     qvortex_tree_leaf(&ctx->tpl, ctx->chunk, ctx->chunk_len, 0, QVORTEX_TREE_ROOT, cv);
+   } else {
+     qvortex_tree_leaf(&ctx->tpl, ctx->chunk, ctx->chunk_len, ctx->chunks, 0, cv);
+     while (ctx->cv_depth > 0) {
+       ctx->cv_depth--;
+       qvortex_tree_parent(&ctx->tpl, ctx->cv_stack[ctx->cv_depth], cv,
+                           ctx->cv_depth == 0 ? QVORTEX_TREE_ROOT : 0, cv);
+     }
+   }
+   memcpy(out, cv, QVORTEX_LITE_DIGEST_BYTES);
+ }
+ 
+ /* ---- Incremental trees ---- */
+ 
+ /*
+  * A tree-mode digest that keeps every chaining value, so after an in-place
+  * edit only the touched chunks and their path to the root are rehashed.
+  * CVs are stored in order: entry 2i is leaf i and entry 2s - 1 the parent
+  * whose left subtree ends before chunk s (in the BLAKE3 shape each split
+  * point belongs to exactly one parent). Stored CVs are all non-root, so an
+  * aligned subtree stays valid when the input grows or shrinks past it; the
+  * root-flagged CV is kept on the side.
+  */
+ #define QVORTEX_MERKLE_BATCH_CHUNKS QVORTEX_TREE_TASK_CHUNKS
+ 
+ /* A modified byte range of the input */
+ typedef struct {
+   uint64_t offset;
+   uint64_t length;
+ } qvortex_range;
+ 
+ typedef struct qvortex_merkle qvortex_merkle;
+ 
+ struct qvortex_merkle {
+   qvortex_template tpl;
+   uint64_t len;                                /* input length the CVs describe */
+   uint64_t chunks;                             /* leaves (an empty input has one) */
+   uint64_t (*cvs)[QVORTEX_LITE_STATE_WORDS];   /* 2 * chunks - 1 nodes, in order */
+   uint64_t root[QVORTEX_LITE_STATE_WORDS];
+   int valid;                                   /* cleared until built, or by a failed update */
+ };
+ 
+ /* Chunks [lo, hi) to rehash */
+ typedef struct {
+   uint64_t lo;
+   uint64_t hi;
+ } qvortex_span;
+ 
+ /*
+  * Input for len bytes at off: a pointer into the caller's buffer, or the
+  * bytes read into scratch (QVORTEX_MERKLE_BATCH_CHUNKS chunks); NULL on error
+  */
+ typedef const uint8_t *(*qvortex_merkle_source_fn)(void *arg, uint64_t off, size_t len,
+                                                     uint8_t *scratch);
+ 
+ static inline uint64_t qvortex_merkle_chunks(uint64_t len) {
+   return len == 0 ? 1 : (len - 1) / QVORTEX_TREE_CHUNK_BYTES + 1;
+ }
+ 
+ /* Chunks in the left subtree of an n-chunk node (n >= 2) */
+ static inline uint64_t qvortex_tree_left_chunks(uint64_t n) {
+   uint64_t p = 1;
+   while (2 * p < n) p *= 2;
+   return p;
+ }
+ 
+ static inline uint64_t qvortex_merkle_node(uint64_t lo, uint64_t hi) {
+   return hi - lo == 1 ? 2 * lo : 2 * (lo + qvortex_tree_left_chunks(hi - lo)) - 1;
+ }
+ 
+ static int qvortex_span_cmp(const void *a, const void *b) {
+   const qvortex_span *x = (const qvortex_span *)a, *y = (const qvortex_span *)b;
+   return (x->lo > y->lo) - (x->lo < y->lo);
+ }
+ 
+ /* Does any span intersect chunks [lo, hi)? Spans are sorted and disjoint. */
+ static int qvortex_spans_hit(const qvortex_span *s, size_t n, uint64_t lo, uint64_t hi) {
+   size_t a = 0, b = n;
+   while (a < b) {
+     size_t mid = a + (b - a) / 2;
+     if (s[mid].hi <= lo) a = mid + 1;
+     else b = mid;
+   }
+   return a < n && s[a].lo < hi;
+ }
+ 
+ /*
+  * Dirty chunks of a len-byte input: the chunks under each range, plus the
+  * old last chunk onwards when the length changed. Sorted and merged.
+  */
+ static size_t qvortex_merkle_spans(const qvortex_merkle *m, uint64_t len,
+                                    const qvortex_range *ranges, size_t nranges,
+                                    qvortex_span *spans) {
+   uint64_t chunks = qvortex_merkle_chunks(len);
+   size_t n = 0, out = 0;
+ 
+   if (!m->valid) {
+     spans[0].lo = 0;
+     spans[0].hi = chunks;
+     return 1;
+   }
+   for (size_t i = 0; i < nranges; i++) {
+     if (ranges[i].length == 0 || ranges[i].offset >= len) continue;
+     uint64_t end = len - ranges[i].offset < ranges[i].length ? len : ranges[i].offset + ranges[i].length;
+     spans[n].lo = ranges[i].offset / QVORTEX_TREE_CHUNK_BYTES;
+     spans[n].hi = (end - 1) / QVORTEX_TREE_CHUNK_BYTES + 1;
+     n++;
+   }
+   if (len != m->len) {
+     spans[n].lo = (m->chunks < chunks ? m->chunks : chunks) - 1;
+     spans[n].hi = chunks;
+     n++;
+   }
+   if (n == 0) return 0;
+ 
+   qsort(spans, n, sizeof(*spans), qvortex_span_cmp);
+   for (size_t i = 1; i < n; i++) {
+     if (spans[i].lo <= spans[out].hi) {
+       if (spans[i].hi > spans[out].hi) spans[out].hi = spans[i].hi;
+     } else {
+       spans[++out] = spans[i];
+     }
+   }
+   return out + 1;
+ }
+ 
+ /* Rehash the leaves under the spans, full chunks on the multi-buffer kernel */
+ static int qvortex_merkle_leaves(qvortex_merkle *m, const qvortex_span *spans, size_t nspans,
+                                  qvortex_merkle_source_fn source, void *arg, uint8_t *scratch) {
+   uint64_t cvs[QVORTEX_MERKLE_BATCH_CHUNKS][QVORTEX_LITE_STATE_WORDS];
+   static const uint8_t empty[1] = {0};
+ 
+   for (size_t s = 0; s < nspans; s++) {
+     for (uint64_t i = spans[s].lo; i < spans[s].hi;) {
+       uint64_t count = spans[s].hi - i, off = i * QVORTEX_TREE_CHUNK_BYTES;
+       if (count > QVORTEX_MERKLE_BATCH_CHUNKS) count = QVORTEX_MERKLE_BATCH_CHUNKS;
+       size_t bytes = (size_t)(m->len - off < count * QVORTEX_TREE_CHUNK_BYTES
+                               ? m->len - off : count * QVORTEX_TREE_CHUNK_BYTES);
+       const uint8_t *p = bytes > 0 ? source(arg, off, bytes, scratch) : empty;
+       if (!p) return QVORTEX_ERROR_IO;
+ 
+       size_t full = bytes / QVORTEX_TREE_CHUNK_BYTES;
+       qvortex_tree_leaves(&m->tpl, p, i, full, cvs);
+       for (size_t k = 0; k < full; k++) memcpy(m->cvs[2 * (i + k)], cvs[k], sizeof(cvs[k]));
+       if (full < count) {
+         /* Only the last chunk of the input can be short */
+         qvortex_tree_leaf(&m->tpl, p + full * QVORTEX_TREE_CHUNK_BYTES,
+                           bytes - full * QVORTEX_TREE_CHUNK_BYTES, i + full, 0,
+                           m->cvs[2 * (i + full)]);
+       }
+       if (m->chunks == 1) qvortex_tree_leaf(&m->tpl, p, bytes, 0, QVORTEX_TREE_ROOT, m->root);
+       i += count;
+     }
+   }
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /* Recompute the parents of node [lo, hi) that sit above a dirty chunk */
+ static void qvortex_merkle_parents(qvortex_merkle *m, const qvortex_span *spans, size_t nspans,
+                                    uint64_t lo, uint64_t hi) {
+   if (hi - lo == 1) return;
+ 
+   uint64_t mid = lo + qvortex_tree_left_chunks(hi - lo);
+   if (qvortex_spans_hit(spans, nspans, lo, mid)) qvortex_merkle_parents(m, spans, nspans, lo, mid);
+   if (qvortex_spans_hit(spans, nspans, mid, hi)) qvortex_merkle_parents(m, spans, nspans, mid, hi);
+   qvortex_tree_parent(&m->tpl, m->cvs[qvortex_merkle_node(lo, mid)],
+                       m->cvs[qvortex_merkle_node(mid, hi)], 0, m->cvs[2 * mid - 1]);
+ }
+ 
+ /*
+  * Bring the tree up to date with a len-byte input in which only the given
+  * ranges (and any growth or truncation) changed. An invalid tree is
+  * rebuilt from scratch. On failure the tree is left invalid.
+  */
+ static int qvortex_lite_merkle_update(qvortex_merkle *m, uint64_t len,
+                                       const qvortex_range *ranges, size_t nranges,
+                                       qvortex_merkle_source_fn source, void *arg,
+                                       uint8_t *scratch) {
+   uint64_t chunks = qvortex_merkle_chunks(len);
+   if (chunks > (SIZE_MAX / 2) / sizeof(m->cvs[0])) return QVORTEX_ERROR_MEMORY_ALLOCATION;
+ 
+   qvortex_span *spans = (qvortex_span *)malloc((nranges + 1) * sizeof(qvortex_span));
+   if (!spans) return QVORTEX_ERROR_MEMORY_ALLOCATION;
+   size_t nspans = qvortex_merkle_spans(m, len, ranges, nranges, spans);
+   if (nspans == 0) {
+     free(spans);
+     return QVORTEX_SUCCESS;
+   }
+ 
+   if (!m->cvs || chunks != m->chunks) {
+     void *cvs = realloc(m->cvs, (size_t)(2 * chunks - 1) * sizeof(m->cvs[0]));
+     if (!cvs) {
+       free(spans);
+       m->valid = 0;
+       return QVORTEX_ERROR_MEMORY_ALLOCATION;
+     }
+     m->cvs = (uint64_t (*)[QVORTEX_LITE_STATE_WORDS])cvs;
+   }
+   m->len = len;
+   m->chunks = chunks;
+   m->valid = 0;
+ 
+   int rc = qvortex_merkle_leaves(m, spans, nspans, source, arg, scratch);
+   if (rc == QVORTEX_SUCCESS && chunks > 1) {
+     uint64_t mid = qvortex_tree_left_chunks(chunks);
+     qvortex_merkle_parents(m, spans, nspans, 0, chunks);
+     qvortex_tree_parent(&m->tpl, m->cvs[qvortex_merkle_node(0, mid)],
+                         m->cvs[qvortex_merkle_node(mid, chunks)], QVORTEX_TREE_ROOT, m->root);
+   }
+   m->valid = rc == QVORTEX_SUCCESS;
+   free(spans);
+   return rc;
+ }
+ 
+ static const uint8_t *qvortex_merkle_source_buffer(void *arg, uint64_t off, size_t len,
+                                                    uint8_t *scratch) {
+   (void)len;
+   (void)scratch;
+   return (const uint8_t *)arg + off;
+ }
+ 
+ #if HAVE_POSIX_IO
+ static const uint8_t *qvortex_merkle_source_fd(void *arg, uint64_t off, size_t len,
+                                                uint8_t *scratch) {
+   int fd = *(const int *)arg;
+   size_t got = 0;
+ 
+   while (got < len) {
+     ssize_t n = pread(fd, scratch + got, len - got, (off_t)(off + got));
+     if (n > 0) got += (size_t)n;
+     else if (n == 0 || errno != EINTR) return NULL;
+   }
+   return scratch;
+ }
+ #endif
+ 
+ /*
+  * Serialized tree, all integers little-endian:
+  *
+  *   0   4  magic "QVM" and format version
+  *   4   8  key id (as qvortex_key_id)
+  *   12  8  input length
+  *   20  64 root CV
+  *   84  -  the 2 * chunks - 1 node CVs, 64 bytes each, in order
+  */
+ #define QVORTEX_MERKLE_EXPORT_VERSION 1
+ #define QVORTEX_MERKLE_EXPORT_HEADER 84
+ 
+ static const uint8_t QVORTEX_MERKLE_MAGIC[4] = { 'Q', 'V', 'M', QVORTEX_MERKLE_EXPORT_VERSION };
+ 
+ static inline uint64_t qvortex_merkle_key_id(const qvortex_merkle *m) {
+   return qvortex_lite_hash64(&m->tpl, m->tpl.sbox, sizeof(m->tpl.sbox));
+ }
+ 
+ static void qvortex_store_cv(uint8_t *p, const uint64_t cv[QVORTEX_LITE_STATE_WORDS]) {
+   for (int i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) qvortex_store_le64(p + 8 * i, cv[i]);
+ }
+ 
+ static void qvortex_load_cv(const uint8_t *p, uint64_t cv[QVORTEX_LITE_STATE_WORDS]) {
+   for (int i = 0; i < QVORTEX_LITE_STATE_WORDS; i++) cv[i] = qvortex_load_le64(p + 8 * i);
+ }
+ 
+ static inline size_t qvortex_merkle_export_bytes(uint64_t chunks) {
+   return QVORTEX_MERKLE_EXPORT_HEADER + (size_t)(2 * chunks - 1) * QVORTEX_LITE_BLOCK_BYTES;
+ }
+ 
+ static void qvortex_lite_merkle_export(const qvortex_merkle *m, uint8_t *out) {
+   memcpy(out, QVORTEX_MERKLE_MAGIC, sizeof(QVORTEX_MERKLE_MAGIC));
+   qvortex_store_le64(out + 4, qvortex_merkle_key_id(m));
+   qvortex_store_le64(out + 12, m->len);
+   qvortex_store_cv(out + 20, m->root);
+   out += QVORTEX_MERKLE_EXPORT_HEADER;
+   for (uint64_t i = 0; i < 2 * m->chunks - 1; i++, out += QVORTEX_LITE_BLOCK_BYTES) {
+     qvortex_store_cv(out, m->cvs[i]);
+   }
+ }
+ 
+ static int qvortex_lite_merkle_import(qvortex_merkle *m, const uint8_t *in, size_t len) {
+   if (len < QVORTEX_MERKLE_EXPORT_HEADER) return QVORTEX_ERROR_FORMAT;
+   if (memcmp(in, QVORTEX_MERKLE_MAGIC, sizeof(QVORTEX_MERKLE_MAGIC)) != 0) return QVORTEX_ERROR_FORMAT;
+   if (qvortex_load_le64(in + 4) != qvortex_merkle_key_id(m)) return QVORTEX_ERROR_FORMAT;
+ 
+   uint64_t input_len = qvortex_load_le64(in + 12);
+   uint64_t chunks = qvortex_merkle_chunks(input_len);
+   if (chunks > (len - QVORTEX_MERKLE_EXPORT_HEADER) / QVORTEX_LITE_BLOCK_BYTES ||
+       len != qvortex_merkle_export_bytes(chunks)) {
+     return QVORTEX_ERROR_FORMAT;
+   }
+ 
+   void *cvs = realloc(m->cvs, (size_t)(2 * chunks - 1) * sizeof(m->cvs[0]));
+   if (!cvs) return QVORTEX_ERROR_MEMORY_ALLOCATION;
+   m->cvs = (uint64_t (*)[QVORTEX_LITE_STATE_WORDS])cvs;
+   m->len = input_len;
+   m->chunks = chunks;
+   qvortex_load_cv(in + 20, m->root);
+   in += QVORTEX_MERKLE_EXPORT_HEADER;
+   for (uint64_t i = 0; i < 2 * chunks - 1; i++, in += QVORTEX_LITE_BLOCK_BYTES) {
+     qvortex_load_cv(in, m->cvs[i]);
+   }
+   m->valid = 1;
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /* ------------------------------------------------------------------------
+    File Hashing
+    ------------------------------------------------------------------------ */
+ 
+ /* Consumer of file contents, fed in order */
+ typedef void (*qvortex_feed_fn)(void *arg, const uint8_t *data, size_t len);
+ 
+ static void qvortex_lite_feed_update(void *arg, const uint8_t *data, size_t len) {
+   qvortex_lite_update((qvortex_lite_ctx *)arg, data, len);
+ }
+ 
+ #if HAVE_POSIX_IO
+ /* Feed whatever read() returns until end of file, in large aligned chunks */
+ static int qvortex_lite_read_fd(int fd, qvortex_feed_fn feed, void *arg) {
+   void *buf = NULL;
+   int rc = QVORTEX_SUCCESS;
+ 
+   if (posix_memalign(&buf, QVORTEX_IO_ALIGN, QVORTEX_IO_BUFFER_BYTES) != 0) {
+     return QVORTEX_ERROR_MEMORY_ALLOCATION;
+   }
+ 
+   for (;;) {
+     ssize_t n = read(fd, buf, QVORTEX_IO_BUFFER_BYTES);
+     if (n > 0) {
+       feed(arg, (const uint8_t *)buf, (size_t)n);
+     } else if (n == 0) {
+       break;
+     } else if (errno != EINTR) {
+       rc = QVORTEX_ERROR_IO;
+       break;
+     }
+   }
+ 
+   free(buf);
+   return rc;
+ }
+ 
+ /* Map a large regular file and feed it in place; returns 0 if it was not mapped */
+ static int qvortex_lite_map_fd(int fd, qvortex_feed_fn feed, void *arg) {
+   struct stat st;
+   if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return 0;
+   if (st.st_size < QVORTEX_MMAP_MIN_BYTES || (uint64_t)st.st_size > SIZE_MAX) return 0;
+ 
+   /* Start at the current offset, as read() would */
+   off_t pos = lseek(fd, 0, SEEK_CUR);
+   if (pos < 0 || pos > st.st_size) return 0;
+ 
+   size_t size = (size_t)st.st_size;
+   void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+   if (map == MAP_FAILED) return 0;
+ #ifdef MADV_SEQUENTIAL
+   (void)madvise(map, size, MADV_SEQUENTIAL);
+ #endif
+ 
+   feed(arg, (const uint8_t *)map + pos, size - (size_t)pos);
+   munmap(map, size);
+   (void)lseek(fd, 0, SEEK_END);
+   return 1;
+ }
+ 
+ static int qvortex_lite_feed_fd(int fd, qvortex_feed_fn feed, void *arg) {
+   if (qvortex_lite_map_fd(fd, feed, arg)) return QVORTEX_SUCCESS;
+   return qvortex_lite_read_fd(fd, feed, arg);
+ }
+ 
+ static int qvortex_lite_hash_fd(const qvortex_template *tpl, int fd,
+                                 uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   qvortex_lite_ctx ctx;
+ 
+   qvortex_lite_init_from_template(&ctx, tpl);
+   int rc = qvortex_lite_feed_fd(fd, qvortex_lite_feed_update, &ctx);
+   if (rc == QVORTEX_SUCCESS) qvortex_lite_final(&ctx, out);
+ 
+   /* Zeroize context state for security */
+   memset(&ctx, 0, sizeof(ctx));
+   return rc;
+ }
+ #endif /* HAVE_POSIX_IO */
+ 
+ static int qvortex_lite_feed_file(const char *path, qvortex_feed_fn feed, void *arg) {
+ #if HAVE_POSIX_IO
+   int flags = O_RDONLY;
+ #ifdef O_CLOEXEC
+   flags |= O_CLOEXEC;
+ #endif
+   int fd = open(path, flags);
+   if (fd < 0) return QVORTEX_ERROR_IO;
+ 
+   int rc = qvortex_lite_feed_fd(fd, feed, arg);
+   int saved_errno = errno;  /* Keep a read error visible to the caller */
+   close(fd);
+   errno = saved_errno;
+   return rc;
+ #else
+   FILE *f = fopen(path, "rb");
+   if (!f) return QVORTEX_ERROR_IO;
+ 
+   uint8_t *buf = (uint8_t *)malloc(QVORTEX_IO_BUFFER_BYTES);
+   if (!buf) {
+     fclose(f);
+     return QVORTEX_ERROR_MEMORY_ALLOCATION;
+   }
+ 
+   size_t n;
+   while ((n = fread(buf, 1, QVORTEX_IO_BUFFER_BYTES, f)) > 0) {
+     feed(arg, buf, n);
+   }
+   int rc = ferror(f) ? QVORTEX_ERROR_IO : QVORTEX_SUCCESS;
+ 
+   free(buf);
+   fclose(f);
+   return rc;
+ #endif
+ }
+ 
+ static int qvortex_lite_hash_file(const qvortex_template *tpl, const char *path,
+                                   uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   qvortex_lite_ctx ctx;
+ 
+   qvortex_lite_init_from_template(&ctx, tpl);
+   int rc = qvortex_lite_feed_file(path, qvortex_lite_feed_update, &ctx);
+   if (rc == QVORTEX_SUCCESS) qvortex_lite_final(&ctx, out);
+ 
+   memset(&ctx, 0, sizeof(ctx));
+   return rc;
+ }
+ 
+ /* ------------------------------------------------------------------------
+    Content-Defined Chunking
+    ------------------------------------------------------------------------ */
+ 
+ /*
+  * FastCDC-style chunking fused with hashing: the input is scanned for a
+  * gear-hash boundary one stride at a time, and each stride goes into the
+  * chunk's digest while it is still in L1, so every byte is read from
+  * memory once.
+  */
+ #define QVORTEX_CDC_STRIDE 4096
+ #define QVORTEX_CDC_MIN_AVG 64
+ #define QVORTEX_CDC_MAX_BYTES (1u << 30)
+ 
+ typedef struct {
+   uint64_t offset;
+   uint64_t length;
+   uint8_t digest[QVORTEX_LITE_DIGEST_BYTES];
+ } qvortex_chunk;
+ 
+ typedef void (*qvortex_chunk_cb)(void *user, const qvortex_chunk *chunk);
+ 
+ typedef struct qvortex_chunker qvortex_chunker;
+ 
+ struct qvortex_chunker {
+   qvortex_lite_ctx ctx;       /* Digest of the chunk in progress */
+   qvortex_template tpl;
+   uint64_t gear[256];
+   uint64_t mask_s;            /* Below avg_size: harder to cut */
+   uint64_t mask_l;            /* From avg_size on: easier to cut */
+   size_t min_size, avg_size, max_size;
+   uint64_t fp;
+   uint64_t offset;            /* Stream offset of the chunk in progress */
+   size_t len;                 /* Bytes in the chunk in progress */
+   qvortex_chunk_cb cb;
+   void *user;
+ };
+ 
+ /* Top n bits: a left-shifting gear hash mixes the most history into them */
+ static inline uint64_t qvortex_cdc_mask(int n) {
+   return ~0ULL << (64 - n);
+ }
+ 
+ static int qvortex_lite_chunker_init(qvortex_chunker *c, size_t min_size, size_t avg_size,
+                                      size_t max_size, const uint8_t *key, size_t key_len,
+                                      qvortex_chunk_cb cb, void *user) {
+   if (min_size == 0 || min_size > avg_size || avg_size > max_size) return QVORTEX_ERROR_UNSUPPORTED;
+   if (avg_size < QVORTEX_CDC_MIN_AVG || max_size > QVORTEX_CDC_MAX_BYTES) return QVORTEX_ERROR_UNSUPPORTED;
+ 
+   /* Fixed gear table (splitmix64), so boundaries match across keys and runs */
+   uint64_t x = 0x51766F7274657843ULL;
+   for (int i = 0; i < 256; i++) {
+     uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+     z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+     z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+     c->gear[i] = z ^ (z >> 31);
+   }
+ 
+   /* Normalized chunking, level 2 */
+   int bits = 0;
+   while (((size_t)2 << bits) <= avg_size) bits++;
+   c->mask_s = qvortex_cdc_mask(bits + 2);
+   c->mask_l = qvortex_cdc_mask(bits - 2);
+ 
+   c->min_size = min_size;
+   c->avg_size = avg_size;
+   c->max_size = max_size;
+   c->fp = 0;
+   c->offset = 0;
+   c->len = 0;
+   c->cb = cb;
+   c->user = user;
+   qvortex_lite_template_init(&c->tpl, key, key_len);
+   qvortex_lite_init_from_template(&c->ctx, &c->tpl);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /* Bytes of p[0..n) that belong to the current chunk; *cut is set if it ends there */
+ static size_t qvortex_cdc_scan(qvortex_chunker *c, const uint8_t *p, size_t n, int *cut) {
+   const uint64_t *gear = c->gear;
+   const uint64_t mask_s = c->mask_s, mask_l = c->mask_l;
+   uint64_t fp = c->fp;
+   size_t base = c->len;
+ 
+   /* Cut-point skipping: nothing shorter than min_size ends a chunk */
+   size_t i = c->min_size > base ? c->min_size - base : 0;
+   size_t lim_s = c->avg_size > base ? c->avg_size - base : 0;
+   size_t lim_l = c->max_size - base;
+   *cut = 0;
+ 
+   size_t end = lim_s < n ? lim_s : n;
+   for (; i < end; i++) {
+     fp = (fp << 1) + gear[p[i]];
+     if (!(fp & mask_s)) goto found;
+   }
+   end = lim_l < n ? lim_l : n;
+   for (; i < end; i++) {
+     fp = (fp << 1) + gear[p[i]];
+     if (!(fp & mask_l)) goto found;
+   }
+   if (lim_l <= n) {
+     *cut = 1;
+     return lim_l;
+   }
+   c->fp = fp;
+   return n;
+ 
+ found:
+   *cut = 1;
+   return i + 1;
+ }
+ 
+ static void qvortex_lite_chunker_emit(qvortex_chunker *c) {
+   qvortex_chunk chunk;
+   chunk.offset = c->offset;
+   chunk.length = c->len;
+   qvortex_lite_final(&c->ctx, chunk.digest);
+ 
+   c->offset += c->len;
+   c->len = 0;
+   c->fp = 0;
+   qvortex_lite_init_from_template(&c->ctx, &c->tpl);
+   c->cb(c->user, &chunk);
+ }
+ 
+ static void qvortex_lite_chunker_update(qvortex_chunker *c, const uint8_t *data, size_t len) {
+   while (len > 0) {
+     int cut;
+     size_t n = len < QVORTEX_CDC_STRIDE ? len : QVORTEX_CDC_STRIDE;
+     n = qvortex_cdc_scan(c, data, n, &cut);
+ 
+     qvortex_lite_update(&c->ctx, data, n);
+     c->len += n;
+     data += n;
+     len -= n;
+     if (cut) qvortex_lite_chunker_emit(c);
+   }
+ }
+ 
+ static void qvortex_lite_chunker_feed(void *arg, const uint8_t *data, size_t len) {
+   qvortex_lite_chunker_update((qvortex_chunker *)arg, data, len);
+ }
+ 
+ /* Emit the trailing chunk, if any, and start over at offset 0 */
+ static void qvortex_lite_chunker_final(qvortex_chunker *c) {
+   if (c->len > 0) qvortex_lite_chunker_emit(c);
+   c->offset = 0;
+ }
+ 
+ static void qvortex_lite_chunker_wipe(qvortex_chunker *c) {
+   memset(&c->ctx, 0, sizeof(c->ctx));
+   memset(&c->tpl, 0, sizeof(c->tpl));
+ }
+ 
+ /* Growable result array for the qvortex_chunk_* one-shot functions */
+ typedef struct {
+   qvortex_chunk *chunks;
+   size_t count;
+   size_t cap;
+   int failed;
+ } qvortex_chunk_list;
+ 
+ static void qvortex_chunk_list_push(void *user, const qvortex_chunk *chunk) {
+   qvortex_chunk_list *l = (qvortex_chunk_list *)user;
+   if (l->failed) return;
+ 
+   if (l->count == l->cap) {
+     size_t cap = l->cap ? l->cap * 2 : 64;
+     qvortex_chunk *grown = (qvortex_chunk *)realloc(l->chunks, cap * sizeof(*grown));
+     if (!grown) {
+       l->failed = 1;
+       return;
+     }
+     l->chunks = grown;
+     l->cap = cap;
+   }
+   l->chunks[l->count++] = *chunk;
+ }
+ 
+ /* Run one of the feeders below through a chunker into a list */
+ typedef int (*qvortex_chunk_source_fn)(qvortex_chunker *c, const void *src, size_t len);
+ 
+ static int qvortex_chunk_source_buffer(qvortex_chunker *c, const void *src, size_t len) {
+   qvortex_lite_chunker_update(c, (const uint8_t *)src, len);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ #if HAVE_POSIX_IO
+ static int qvortex_chunk_source_fd(qvortex_chunker *c, const void *src, size_t len) {
+   (void)len;
+   return qvortex_lite_feed_fd(*(const int *)src, qvortex_lite_chunker_feed, c);
+ }
+ #endif
+ 
+ static int qvortex_chunk_source_file(qvortex_chunker *c, const void *src, size_t len) {
+   (void)len;
+   return qvortex_lite_feed_file((const char *)src, qvortex_lite_chunker_feed, c);
+ }
+ 
+ static int qvortex_lite_chunk_collect(qvortex_chunk_source_fn source, const void *src, size_t len,
+                                       size_t min_size, size_t avg_size, size_t max_size,
+                                       const uint8_t *key, size_t key_len,
+                                       qvortex_chunk **chunks, size_t *count) {
+   qvortex_chunk_list list = { NULL, 0, 0, 0 };
+   qvortex_chunker *c = (qvortex_chunker *)malloc(sizeof(*c));
+   if (!c) return QVORTEX_ERROR_MEMORY_ALLOCATION;
+ 
+   int rc = qvortex_lite_chunker_init(c, min_size, avg_size, max_size, key, key_len,
+                                      qvortex_chunk_list_push, &list);
+   if (rc == QVORTEX_SUCCESS) rc = source(c, src, len);
+   if (rc == QVORTEX_SUCCESS) qvortex_lite_chunker_final(c);
+   if (rc == QVORTEX_SUCCESS && list.failed) rc = QVORTEX_ERROR_MEMORY_ALLOCATION;
+ 
+   qvortex_lite_chunker_wipe(c);
+   free(c);
+   if (rc != QVORTEX_SUCCESS) {
+     free(list.chunks);
+     return rc;
+   }
+   *chunks = list.chunks;
+   *count = list.count;
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /* ------------------------------------------------------------------------
+    Digest Index
+    ------------------------------------------------------------------------ */
+ 
+ /*
+  * A memory-mapped map from 64-byte digests to 64-bit values (such as object
+  * locations), opened without reading or rebuilding anything. The file is:
+  *
+  *   header    one page
+  *   buckets   nbuckets (a power of two) cache lines of 8 slots
+  *   records   capacity records of digest[64] + value, appended in order
+  *
+  * A slot holds a 24-bit fingerprint (digest bytes 13..15) and the record
+  * number + 1; zero is empty. The bucket comes from digest bytes 0..7 and
+  * collisions probe linearly into the next bucket. Buckets are sized so
+  * the table is at most 75% full at capacity, which keeps nearly every
+  * lookup to the bucket line plus one record. Records are never moved or
+  * rewritten; an insert appends a record, then publishes its slot, then
+  * the count, so concurrent readers of the mapping see complete entries.
+  * There may be one writer at a time. The layout is in host byte order,
+  * checked on open.
+  */
+ #define QVORTEX_INDEX_VERSION 1
+ #define QVORTEX_INDEX_HEADER_BYTES 4096
+ #define QVORTEX_INDEX_SLOTS 8
+ #define QVORTEX_INDEX_RECORD_BYTES (QVORTEX_LITE_DIGEST_BYTES + 8)
+ #define QVORTEX_INDEX_RECORD_BITS 40
+ #define QVORTEX_INDEX_MAX_CAPACITY ((1ULL << QVORTEX_INDEX_RECORD_BITS) - 2)
+ #define QVORTEX_INDEX_BYTE_ORDER 0x0102030405060708ULL
+ 
+ /* Lookups in flight per group in the batched calls */
+ #define QVORTEX_INDEX_BATCH 16
+ 
+ static const uint8_t QVORTEX_INDEX_MAGIC[4] = { 'Q', 'V', 'X', QVORTEX_INDEX_VERSION };
+ 
+ typedef struct {
+   uint8_t magic[4];
+   uint32_t record_bytes;
+   uint64_t byte_order;
+   uint64_t nbuckets;
+   uint64_t capacity;
+   uint64_t count;                              /* records appended so far */
+ } qvortex_index_header;
+ 
+ typedef struct qvortex_index qvortex_index;
+ 
+ struct qvortex_index {
+   uint8_t *map;
+   size_t map_len;
+   int fd;
+   int writable;
+   qvortex_index_header *hdr;
+   uint64_t (*buckets)[QVORTEX_INDEX_SLOTS];
+   uint8_t *records;
+   uint64_t mask;                               /* nbuckets - 1 */
+ };
+ 
+ static inline uint64_t qvortex_index_fingerprint(const uint8_t digest[QVORTEX_LITE_DIGEST_BYTES]) {
+   return qvortex_load_le64(digest + 8) >> QVORTEX_INDEX_RECORD_BITS;
+ }
+ 
+ static inline uint8_t *qvortex_index_record(const qvortex_index *ix, uint64_t r) {
+   return ix->records + r * QVORTEX_INDEX_RECORD_BYTES;
+ }
+ 
+ /* Smallest power-of-two bucket count keeping capacity entries at most 75% of the slots */
+ static inline uint64_t qvortex_index_buckets_for(uint64_t capacity) {
+   uint64_t nbuckets = 1;
+   while (nbuckets * QVORTEX_INDEX_SLOTS * 3 < capacity * 4) nbuckets *= 2;
+   return nbuckets;
+ }
+ 
+ static inline uint64_t qvortex_index_file_bytes(uint64_t nbuckets, uint64_t capacity) {
+   return QVORTEX_INDEX_HEADER_BYTES + nbuckets * 64 + capacity * QVORTEX_INDEX_RECORD_BYTES;
+ }
+ 
+ /*
+  * Probe for a digest. Returns 1 and its record number if present, else 0
+  * and, in *empty, the first free slot on its probe sequence.
+  */
+ static int qvortex_index_find(const qvortex_index *ix, const uint8_t digest[QVORTEX_LITE_DIGEST_BYTES],
+                               uint64_t *record, uint64_t **empty) {
+   const uint64_t fp = qvortex_index_fingerprint(digest);
+   const uint64_t count = __atomic_load_n(&ix->hdr->count, __ATOMIC_ACQUIRE);
+   uint64_t b = qvortex_load_le64(digest) & ix->mask;
+ 
+   /* At most every bucket once: a file whose slots are all taken ends here */
+   if (empty) *empty = NULL;
+   for (uint64_t probed = 0; probed <= ix->mask; probed++, b = (b + 1) & ix->mask) {
+     uint64_t *bucket = ix->buckets[b];
+     for (int s = 0; s < QVORTEX_INDEX_SLOTS; s++) {
+       uint64_t v = __atomic_load_n(&bucket[s], __ATOMIC_ACQUIRE);
+       if (v == 0) {
+         if (empty) *empty = &bucket[s];
+         return 0;
+       }
+       if (v >> QVORTEX_INDEX_RECORD_BITS != fp) continue;
+       uint64_t r = (v & ((1ULL << QVORTEX_INDEX_RECORD_BITS) - 1)) - 1;
+       if (r < count && memcmp(qvortex_index_record(ix, r), digest, QVORTEX_LITE_DIGEST_BYTES) == 0) {
+         *record = r;
+         return 1;
+       }
+     }
+   }
+   return 0;
+ }
+ 
+ /* Touch the home bucket of a digest, then the record of its first fingerprint match */
+ static inline void qvortex_index_prefetch_bucket(const qvortex_index *ix, const uint8_t *digest) {
+   __builtin_prefetch(ix->buckets[qvortex_load_le64(digest) & ix->mask], 0, 3);
+ }
+ 
+ static inline void qvortex_index_prefetch_record(const qvortex_index *ix, const uint8_t *digest) {
+   const uint64_t *bucket = ix->buckets[qvortex_load_le64(digest) & ix->mask];
+   const uint64_t fp = qvortex_index_fingerprint(digest);
+   for (int s = 0; s < QVORTEX_INDEX_SLOTS && bucket[s] != 0; s++) {
+     if (bucket[s] >> QVORTEX_INDEX_RECORD_BITS == fp) {
+       uint64_t r = (bucket[s] & ((1ULL << QVORTEX_INDEX_RECORD_BITS) - 1)) - 1;
+       __builtin_prefetch(qvortex_index_record(ix, r), 0, 3);
+       return;
+     }
+   }
+ }
+ 
+ static inline int qvortex_lite_index_lookup(const qvortex_index *ix,
+                                             const uint8_t digest[QVORTEX_LITE_DIGEST_BYTES],
+                                             uint64_t *value) {
+   uint64_t r;
+   if (!qvortex_index_find(ix, digest, &r, NULL)) return 0;
+   memcpy(value, qvortex_index_record(ix, r) + QVORTEX_LITE_DIGEST_BYTES, sizeof(*value));
+   return 1;
+ }
+ 
+ /*
+  * Insert-or-get: a new digest is appended with *value; for one already
+  * present *value becomes the stored value. Returns 1 if inserted, 0 if it
+  * was present, or a negative error.
+  */
+ static int qvortex_lite_index_insert(qvortex_index *ix, const uint8_t digest[QVORTEX_LITE_DIGEST_BYTES],
+                                      uint64_t *value) {
+   uint64_t r, *slot = NULL;
+   if (qvortex_index_find(ix, digest, &r, &slot)) {
+     memcpy(value, qvortex_index_record(ix, r) + QVORTEX_LITE_DIGEST_BYTES, sizeof(*value));
+     return 0;
+   }
+ 
+   r = ix->hdr->count;
+   if (r >= ix->hdr->capacity || !slot) return QVORTEX_ERROR_UNSUPPORTED;
+   uint8_t *rec = qvortex_index_record(ix, r);
+   memcpy(rec, digest, QVORTEX_LITE_DIGEST_BYTES);
+   memcpy(rec + QVORTEX_LITE_DIGEST_BYTES, value, sizeof(*value));
+   __atomic_store_n(slot, qvortex_index_fingerprint(digest) << QVORTEX_INDEX_RECORD_BITS | (r + 1),
+                    __ATOMIC_RELEASE);
+   __atomic_store_n(&ix->hdr->count, r + 1, __ATOMIC_RELEASE);
+   return 1;
+ }
+ 
+ /*
+  * Batched lookups or inserts, pipelined over groups of QVORTEX_INDEX_BATCH:
+  * while one group is resolved, the candidate records of the next and the
+  * home buckets of the one after are already being fetched, so the cache
+  * misses overlap instead of queuing one after another. Bit i of the bitmap
+  * is set if digest i was found (or, for inserts, added).
+  */
+ static int qvortex_lite_index_many(qvortex_index *ix, const uint8_t *digests, uint64_t *values,
+                                    size_t n, uint8_t *bitmap, int insert) {
+   const size_t batch = QVORTEX_INDEX_BATCH * QVORTEX_LITE_DIGEST_BYTES;
+   const uint8_t *end = digests + n * QVORTEX_LITE_DIGEST_BYTES;
+   const uint8_t *d;
+ 
+   memset(bitmap, 0, (n + 7) / 8);
+   for (d = digests; d < end && d < digests + 2 * batch; d += QVORTEX_LITE_DIGEST_BYTES) {
+     qvortex_index_prefetch_bucket(ix, d);
+   }
+   for (d = digests; d < end && d < digests + batch; d += QVORTEX_LITE_DIGEST_BYTES) {
+     qvortex_index_prefetch_record(ix, d);
+   }
+ 
+   for (size_t base = 0; base < n; base += QVORTEX_INDEX_BATCH) {
+     const uint8_t *group = digests + base * QVORTEX_LITE_DIGEST_BYTES;
+     const uint8_t *next = group + batch, *ahead = group + 2 * batch;
+     size_t count = n - base < QVORTEX_INDEX_BATCH ? n - base : QVORTEX_INDEX_BATCH;
+ 
+     for (d = ahead; d < end && d < ahead + batch; d += QVORTEX_LITE_DIGEST_BYTES) {
+       qvortex_index_prefetch_bucket(ix, d);
+     }
+     for (d = next; d < end && d < next + batch; d += QVORTEX_LITE_DIGEST_BYTES) {
+       qvortex_index_prefetch_record(ix, d);
+     }
+     for (size_t i = 0; i < count; i++) {
+       const uint8_t *digest = group + i * QVORTEX_LITE_DIGEST_BYTES;
+       int hit = insert ? qvortex_lite_index_insert(ix, digest, &values[base + i])
+                        : qvortex_lite_index_lookup(ix, digest, &values[base + i]);
+       if (hit < 0) return hit;
+       if (hit) bitmap[(base + i) >> 3] |= (uint8_t)(1u << ((base + i) & 7));
+     }
+   }
+   return QVORTEX_SUCCESS;
+ }
+ 
+ #if HAVE_POSIX_IO
+ static int qvortex_index_map(qvortex_index *ix, int fd, size_t len, int writable) {
+   void *map = mmap(NULL, len, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+   if (map == MAP_FAILED) return QVORTEX_ERROR_IO;
+ 
+   ix->map = (uint8_t *)map;
+   ix->map_len = len;
+   ix->fd = fd;
+   ix->writable = writable;
+   ix->hdr = (qvortex_index_header *)map;
+   ix->buckets = (uint64_t (*)[QVORTEX_INDEX_SLOTS])(ix->map + QVORTEX_INDEX_HEADER_BYTES);
+   ix->records = ix->map + QVORTEX_INDEX_HEADER_BYTES + ix->hdr->nbuckets * 64;
+   ix->mask = ix->hdr->nbuckets - 1;
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /* Sparse file of the full size: untouched buckets and records cost no disk */
+ static int qvortex_lite_index_create(const char *path, uint64_t capacity, qvortex_index *ix) {
+   uint64_t nbuckets = qvortex_index_buckets_for(capacity);
+   uint64_t bytes = qvortex_index_file_bytes(nbuckets, capacity);
+   if ((uint64_t)(size_t)bytes != bytes || (uint64_t)(off_t)bytes != bytes) {
+     return QVORTEX_ERROR_UNSUPPORTED;
+   }
+ 
+   int flags = O_RDWR | O_CREAT | O_EXCL;
+ #ifdef O_CLOEXEC
+   flags |= O_CLOEXEC;
+ #endif
+   int fd = open(path, flags, 0644);
+   if (fd < 0) return QVORTEX_ERROR_IO;
+   if (ftruncate(fd, (off_t)bytes) != 0) {
+     close(fd);
+     unlink(path);
+     return QVORTEX_ERROR_IO;
+   }
+ 
+   qvortex_index_header hdr;
+   memset(&hdr, 0, sizeof(hdr));
+   memcpy(hdr.magic, QVORTEX_INDEX_MAGIC, sizeof(hdr.magic));
+   hdr.record_bytes = QVORTEX_INDEX_RECORD_BYTES;
+   hdr.byte_order = QVORTEX_INDEX_BYTE_ORDER;
+   hdr.nbuckets = nbuckets;
+   hdr.capacity = capacity;
+   if (pwrite(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr) ||
+       qvortex_index_map(ix, fd, (size_t)bytes, 1) != QVORTEX_SUCCESS) {
+     close(fd);
+     unlink(path);
+     return QVORTEX_ERROR_IO;
+   }
+   return QVORTEX_SUCCESS;
+ }
+ 
+ static int qvortex_lite_index_open(const char *path, int writable, qvortex_index *ix) {
+   qvortex_index_header hdr;
+   struct stat st;
+ 
+   int flags = writable ? O_RDWR : O_RDONLY;
+ #ifdef O_CLOEXEC
+   flags |= O_CLOEXEC;
+ #endif
+   int fd = open(path, flags);
+   if (fd < 0) return QVORTEX_ERROR_IO;
+   if (fstat(fd, &st) != 0 || pread(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr)) {
+     close(fd);
+     return QVORTEX_ERROR_IO;
+   }
+ 
+   /*
+    * Reject anything whose size does not match its own header, or whose
+    * buckets are not the ones create sizes for its capacity
+    */
+   if (memcmp(hdr.magic, QVORTEX_INDEX_MAGIC, sizeof(hdr.magic)) != 0 ||
+       hdr.record_bytes != QVORTEX_INDEX_RECORD_BYTES || hdr.byte_order != QVORTEX_INDEX_BYTE_ORDER ||
+       hdr.capacity == 0 || hdr.capacity > QVORTEX_INDEX_MAX_CAPACITY ||
+       hdr.nbuckets != qvortex_index_buckets_for(hdr.capacity) || hdr.count > hdr.capacity ||
+       qvortex_index_file_bytes(hdr.nbuckets, hdr.capacity) != (uint64_t)st.st_size) {
+     close(fd);
+     return QVORTEX_ERROR_FORMAT;
+   }
+   if ((uint64_t)(size_t)st.st_size != (uint64_t)st.st_size) {
+     close(fd);
+     return QVORTEX_ERROR_UNSUPPORTED;
+   }
+ 
+   int rc = qvortex_index_map(ix, fd, (size_t)st.st_size, writable);
+   if (rc != QVORTEX_SUCCESS) close(fd);
+   return rc;
+ }
+ #endif
+ 
+ /* ------------------------------------------------------------------------
+    GPU Batches
+    ------------------------------------------------------------------------ */
+ 
+ /*
+  * Handle for qvortex_gpu_hash_records. The device side (qvortex_gpu.h)
+  * holds the uploaded template and buffers reused across batches.
+  */
+ typedef struct qvortex_gpu qvortex_gpu;
+ 
+ struct qvortex_gpu {
+ #if QVORTEX_GPU
+   qvortex_gpu_device *dev;
+ #else
+   int unused;
+ #endif
+ };
+ 
+ #if QVORTEX_GPU
+ _Static_assert(sizeof(qvortex_gpu_record) == sizeof(qvortex_range) &&
+                offsetof(qvortex_gpu_record, length) == offsetof(qvortex_range, length),
+                "qvortex_range is passed to the device as qvortex_gpu_record");
+ #endif
+ 
+ /* ------------------------------------------------------------------------
+    Streaming Reader
+    ------------------------------------------------------------------------ */
+ 
+ /*
+  * Hashes many file descriptors from one driving thread while keeping the
+  * I/O busy. Each stream owns two aligned buffers: when a read completes,
+  * the read into the other buffer is submitted first and only then is the
+  * completed buffer hashed, so the device (or peer) fills one buffer while
+  * qvortex_lite_update consumes the other. One read per stream is in flight
+  * at a time, which keeps pipes and sockets in order.
+  *
+  * Reads go through io_uring on Linux, or through a small pool of blocking
+  * I/O threads elsewhere (or when io_uring is unavailable).
+  */
+ 
+ /* Called once per stream with its digest, or with NULL and errno set on error */
+ typedef void (*qvortex_reader_cb)(void *user, int status, const uint8_t *digest);
+ 
+ typedef struct qvortex_reader qvortex_reader;
+ 
+ #if HAVE_POSIX_IO && HAVE_PTHREADS
+ 
+ #if defined(__linux__) && defined(__has_include)
+ #if __has_include(<linux/io_uring.h>)
+ #include <linux/io_uring.h>
+ #include <sys/syscall.h>
+ #define HAVE_IO_URING 1
+ #endif
+ #endif
+ #ifndef HAVE_IO_URING
+ #define HAVE_IO_URING 0
+ #endif
+ 
+ struct qvortex_reader_stream;
+ 
+ typedef struct qvortex_read_req {
+   struct qvortex_reader_stream *stream;
+   uint8_t *buf;
+   ssize_t res;                             /* bytes read, or -errno */
+   struct qvortex_read_req *next;
+ } qvortex_read_req;
+ 
+ typedef struct qvortex_reader_stream {
+   qvortex_lite_ctx ctx;
+   int fd;
+   int64_t offset;                          /* -1 for pipes and sockets */
+   qvortex_read_req req[2];
+   int cur;                                 /* buffer of the read in flight */
+   qvortex_reader_cb cb;
+   void *user;
+   struct qvortex_reader_stream *prev, *next;
+ } qvortex_reader_stream;
+ 
+ #if HAVE_IO_URING
+ typedef struct {
+   int fd;
+   void *ring;
+   size_t ring_size;
+   struct io_uring_sqe *sqes;
+   size_t sqes_size;
+   unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+   unsigned *cq_head, *cq_tail, *cq_mask;
+   struct io_uring_cqe *cqes;
+   unsigned sq_entries, cq_entries;
+   unsigned to_submit;
+ } qvortex_uring;
+ #endif
+ 
+ struct qvortex_reader {
+   int use_uring;
+   int closing;                             /* draining in qvortex_reader_free */
+   size_t buffer_bytes;
+   size_t active;                           /* streams not yet reported */
+   size_t in_flight;                        /* reads owned by the kernel or an I/O thread */
+   size_t max_in_flight;
+   qvortex_read_req *wait_head, *wait_tail; /* reads waiting for a free slot */
+   qvortex_reader_stream *streams;
+ #if HAVE_IO_URING
+   qvortex_uring ring;
+ #endif
+   pthread_t *threads;
+   int nthreads;
+   pthread_mutex_t lock;
+   pthread_cond_t req_cond, done_cond;
+   qvortex_read_req *req_head, *req_tail;   /* handed to I/O threads */
+   qvortex_read_req *done_head, *done_tail; /* completed by I/O threads */
+   int shutdown;
+ };
+ 
+ static void qvortex_req_append(qvortex_read_req **head, qvortex_read_req **tail,
+                                qvortex_read_req *req) {
+   req->next = NULL;
+   if (*tail) (*tail)->next = req; else *head = req;
+   *tail = req;
+ }
+ 
+ #if HAVE_IO_URING
+ static int qvortex_uring_setup(qvortex_uring *u, unsigned entries) {
+   struct io_uring_params p;
+   memset(&p, 0, sizeof(p));
+   memset(u, 0, sizeof(*u));
+ 
+   u->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+   if (u->fd < 0) return -1;
+ 
+   /* One mapping for both rings, and offset -1 meaning "current position" */
+   if (!(p.features & IORING_FEAT_SINGLE_MMAP) || !(p.features & IORING_FEAT_RW_CUR_POS)) {
+     close(u->fd);
+     return -1;
+   }
+ 
+   size_t sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+   size_t cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+   u->ring_size = sq_size > cq_size ? sq_size : cq_size;
+   u->ring = mmap(NULL, u->ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                  u->fd, IORING_OFF_SQ_RING);
+   if (u->ring == MAP_FAILED) {
+     close(u->fd);
+     return -1;
+   }
+   u->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+   u->sqes = (struct io_uring_sqe *)mmap(NULL, u->sqes_size, PROT_READ | PROT_WRITE,
+                                         MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_SQES);
+   if (u->sqes == MAP_FAILED) {
+     munmap(u->ring, u->ring_size);
+     close(u->fd);
+     return -1;
+   }
+ 
+   uint8_t *ring = (uint8_t *)u->ring;
+   u->sq_head = (unsigned *)(ring + p.sq_off.head);
+   u->sq_tail = (unsigned *)(ring + p.sq_off.tail);
+   u->sq_mask = (unsigned *)(ring + p.sq_off.ring_mask);
+   u->sq_array = (unsigned *)(ring + p.sq_off.array);
+   u->cq_head = (unsigned *)(ring + p.cq_off.head);
+   u->cq_tail = (unsigned *)(ring + p.cq_off.tail);
+   u->cq_mask = (unsigned *)(ring + p.cq_off.ring_mask);
+   u->cqes = (struct io_uring_cqe *)(ring + p.cq_off.cqes);
+   u->sq_entries = p.sq_entries;
+   u->cq_entries = p.cq_entries;
+   return 0;
+ }
+ 
+ static void qvortex_uring_teardown(qvortex_uring *u) {
+   munmap(u->sqes, u->sqes_size);
+   munmap(u->ring, u->ring_size);
+   close(u->fd);
+ }
+ 
+ /* Submit queued SQEs and optionally wait for at least one completion */
+ static int qvortex_uring_enter(qvortex_uring *u, int wait) {
+   for (;;) {
+     unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0;
+     long ret = syscall(__NR_io_uring_enter, u->fd, u->to_submit, wait ? 1 : 0, flags, NULL, 0);
+     if (ret >= 0) {
+       u->to_submit -= (unsigned)ret;
+       if (u->to_submit == 0 || !wait) return QVORTEX_SUCCESS;
+       continue;
+     }
+     if (errno == EINTR) continue;
+     if (errno == EAGAIN || errno == EBUSY) {
+       if (!wait) return QVORTEX_SUCCESS;  /* Retried on the next poll */
+       continue;
+     }
+     return QVORTEX_ERROR_IO;
+   }
+ }
+ 
+ static int qvortex_uring_submit(qvortex_uring *u, qvortex_read_req *req, size_t len) {
+   unsigned tail = *u->sq_tail;
+   while (tail - __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE) == u->sq_entries) {
+     if (qvortex_uring_enter(u, 0) != QVORTEX_SUCCESS) return QVORTEX_ERROR_IO;
+   }
+ 
+   unsigned idx = tail & *u->sq_mask;
+   struct io_uring_sqe *sqe = &u->sqes[idx];
+   memset(sqe, 0, sizeof(*sqe));
+   sqe->opcode = IORING_OP_READ;
+   sqe->fd = req->stream->fd;
+   sqe->addr = (uint64_t)(uintptr_t)req->buf;
+   sqe->len = (uint32_t)len;
+   sqe->off = (uint64_t)req->stream->offset;  /* -1: current file position */
+   sqe->user_data = (uint64_t)(uintptr_t)req;
+   u->sq_array[idx] = idx;
+   __atomic_store_n(u->sq_tail, tail + 1, __ATOMIC_RELEASE);
+   u->to_submit++;
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /* Move every available CQE onto a list */
+ static void qvortex_uring_reap(qvortex_uring *u, qvortex_read_req **head, qvortex_read_req **tail) {
+   unsigned h = *u->cq_head;
+   unsigned t = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+   for (; h != t; h++) {
+     struct io_uring_cqe *cqe = &u->cqes[h & *u->cq_mask];
+     qvortex_read_req *req = (qvortex_read_req *)(uintptr_t)cqe->user_data;
+     req->res = cqe->res;
+     qvortex_req_append(head, tail, req);
+   }
+   __atomic_store_n(u->cq_head, h, __ATOMIC_RELEASE);
+ }
+ #endif /* HAVE_IO_URING */
+ 
+ static void *qvortex_reader_io_thread(void *arg) {
+   struct qvortex_reader *r = (struct qvortex_reader *)arg;
+ 
+   pthread_mutex_lock(&r->lock);
+   for (;;) {
+     while (!r->shutdown && !r->req_head) pthread_cond_wait(&r->req_cond, &r->lock);
+     if (!r->req_head) break;
+ 
+     qvortex_read_req *req = r->req_head;
+     r->req_head = req->next;
+     if (!r->req_head) r->req_tail = NULL;
+     pthread_mutex_unlock(&r->lock);
+ 
+     const qvortex_reader_stream *s = req->stream;
+     ssize_t n;
+     do {
+       n = s->offset >= 0 ? pread(s->fd, req->buf, r->buffer_bytes, (off_t)s->offset)
+                          : read(s->fd, req->buf, r->buffer_bytes);
+     } while (n < 0 && errno == EINTR);
+     req->res = n < 0 ? -errno : n;
+ 
+     pthread_mutex_lock(&r->lock);
+     qvortex_req_append(&r->done_head, &r->done_tail, req);
+     pthread_cond_signal(&r->done_cond);
+   }
+   pthread_mutex_unlock(&r->lock);
+   return NULL;
+ }
+ 
+ /* Hand waiting reads to the kernel or the I/O threads while slots are free */
+ static int qvortex_reader_dispatch(struct qvortex_reader *r) {
+   while (r->wait_head && r->in_flight < r->max_in_flight) {
+     qvortex_read_req *req = r->wait_head;
+     r->wait_head = req->next;
+     if (!r->wait_head) r->wait_tail = NULL;
+ 
+ #if HAVE_IO_URING
+     if (r->use_uring) {
+       if (qvortex_uring_submit(&r->ring, req, r->buffer_bytes) != QVORTEX_SUCCESS) {
+         /* Back to the front of the queue, so the next poll retries it */
+         req->next = r->wait_head;
+         r->wait_head = req;
+         if (!r->wait_tail) r->wait_tail = req;
+         return QVORTEX_ERROR_IO;
+       }
+       r->in_flight++;
+       continue;
+     }
+ #endif
+     pthread_mutex_lock(&r->lock);
+     qvortex_req_append(&r->req_head, &r->req_tail, req);
+     pthread_cond_signal(&r->req_cond);
+     pthread_mutex_unlock(&r->lock);
+     r->in_flight++;
+   }
+   return QVORTEX_SUCCESS;
+ }
+ 
+ static void qvortex_reader_queue(struct qvortex_reader *r, qvortex_reader_stream *s) {
+   qvortex_req_append(&r->wait_head, &r->wait_tail, &s->req[s->cur]);
+ }
+ 
+ static void qvortex_reader_finish(struct qvortex_reader *r, qvortex_reader_stream *s, int rc, int err) {
+   uint8_t digest[QVORTEX_LITE_DIGEST_BYTES];
+ 
+   if (s->prev) s->prev->next = s->next; else r->streams = s->next;
+   if (s->next) s->next->prev = s->prev;
+   r->active--;
+ 
+   if (!r->closing) {
+     if (rc == QVORTEX_SUCCESS) qvortex_lite_final(&s->ctx, digest);
+     errno = err;
+     s->cb(s->user, rc, rc == QVORTEX_SUCCESS ? digest : NULL);
+   }
+ 
+   free(s->req[0].buf);
+   free(s->req[1].buf);
+   /* Zeroize context state for security */
+   memset(s, 0, sizeof(*s));
+   free(s);
+ }
+ 
+ /* Collect finished reads, blocking for at least one when wait is set */
+ static int qvortex_reader_collect(struct qvortex_reader *r, int wait,
+                                   qvortex_read_req **head, qvortex_read_req **tail) {
+ #if HAVE_IO_URING
+   if (r->use_uring) {
+     qvortex_uring_reap(&r->ring, head, tail);
+     if (!*head && (wait || r->ring.to_submit)) {
+       if (qvortex_uring_enter(&r->ring, wait) != QVORTEX_SUCCESS) return QVORTEX_ERROR_IO;
+       qvortex_uring_reap(&r->ring, head, tail);
+     }
+     return QVORTEX_SUCCESS;
+   }
+ #endif
+   pthread_mutex_lock(&r->lock);
+   while (wait && !r->done_head) pthread_cond_wait(&r->done_cond, &r->lock);
+   *head = r->done_head;
+   *tail = r->done_tail;
+   r->done_head = r->done_tail = NULL;
+   pthread_mutex_unlock(&r->lock);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ static int qvortex_lite_reader_poll(struct qvortex_reader *r, int wait) {
+   qvortex_read_req *head = NULL, *tail = NULL, *req;
+   int rc;
+ 
+   if ((rc = qvortex_reader_dispatch(r)) != QVORTEX_SUCCESS) return rc;
+   if (r->in_flight == 0) return (int)r->active;
+   if ((rc = qvortex_reader_collect(r, wait, &head, &tail)) != QVORTEX_SUCCESS) return rc;
+ 
+   /* Start every stream's next read before hashing anything */
+   for (req = head; req; req = req->next) {
+     qvortex_reader_stream *s = req->stream;
+     r->in_flight--;
+     if (req->res > 0 && !r->closing) {
+       if (s->offset >= 0) s->offset += req->res;
+       s->cur ^= 1;
+       qvortex_reader_queue(r, s);
+     }
+   }
+   /* A failed submit is reported only after the reaped reads are delivered */
+   rc = qvortex_reader_dispatch(r);
+ #if HAVE_IO_URING
+   if (rc == QVORTEX_SUCCESS && r->use_uring && r->ring.to_submit &&
+       qvortex_uring_enter(&r->ring, 0) != QVORTEX_SUCCESS) {
+     rc = QVORTEX_ERROR_IO;
+   }
+ #endif
+ 
+   /* Hash (or finish) while those reads are in progress */
+   while ((req = head) != NULL) {
+     qvortex_reader_stream *s = req->stream;
+     head = req->next;
+     if (req->res > 0 && !r->closing) {
+       qvortex_lite_update(&s->ctx, req->buf, (size_t)req->res);
+     } else if (req->res >= 0) {
+       qvortex_reader_finish(r, s, QVORTEX_SUCCESS, 0);
+     } else {
+       qvortex_reader_finish(r, s, QVORTEX_ERROR_IO, (int)-req->res);
+     }
+   }
+   return rc != QVORTEX_SUCCESS ? rc : (int)r->active;
+ }
+ 
+ static struct qvortex_reader *qvortex_lite_reader_new(unsigned depth, size_t buffer_bytes,
+                                                       unsigned flags) {
+   struct qvortex_reader *r = (struct qvortex_reader *)calloc(1, sizeof(struct qvortex_reader));
+   if (!r) return NULL;
+ 
+   r->buffer_bytes = buffer_bytes;
+   r->max_in_flight = depth;
+   pthread_mutex_init(&r->lock, NULL);
+   pthread_cond_init(&r->req_cond, NULL);
+   pthread_cond_init(&r->done_cond, NULL);
+ 
+ #if HAVE_IO_URING
+   if (!(flags & QVORTEX_READER_THREADS) && qvortex_uring_setup(&r->ring, depth) == 0) {
+     /* Never more reads in flight than the CQ can hold */
+     r->use_uring = 1;
+     if (r->max_in_flight > r->ring.cq_entries) r->max_in_flight = r->ring.cq_entries;
+     return r;
+   }
+ #else
+   (void)flags;
+ #endif
+ 
+   int nthreads = depth < QVORTEX_READER_MAX_THREADS ? (int)depth : QVORTEX_READER_MAX_THREADS;
+   r->threads = (pthread_t *)calloc((size_t)nthreads, sizeof(pthread_t));
+   if (!r->threads) {
+     free(r);
+     return NULL;
+   }
+   while (r->nthreads < nthreads &&
+          pthread_create(&r->threads[r->nthreads], NULL, qvortex_reader_io_thread, r) == 0) {
+     r->nthreads++;
+   }
+   if (r->nthreads == 0) {
+     free(r->threads);
+     free(r);
+     return NULL;
+   }
+   return r;
+ }
+ 
+ static int qvortex_lite_reader_add(struct qvortex_reader *r, int fd, const qvortex_template *tpl,
+                                    qvortex_reader_cb cb, void *user) {
+   qvortex_reader_stream *s = (qvortex_reader_stream *)calloc(1, sizeof(qvortex_reader_stream));
+   if (!s) return QVORTEX_ERROR_MEMORY_ALLOCATION;
+ 
+   for (int b = 0; b < 2; b++) {
+     void *buf = NULL;
+     if (posix_memalign(&buf, QVORTEX_IO_ALIGN, r->buffer_bytes) != 0) {
+       free(s->req[0].buf);
+       free(s);
+       return QVORTEX_ERROR_MEMORY_ALLOCATION;
+     }
+     s->req[b].stream = s;
+     s->req[b].buf = (uint8_t *)buf;
+   }
+ 
+   /* Files and block devices are read at explicit offsets from the current one */
+   struct stat st;
+   off_t pos = -1;
+   if (fstat(fd, &st) == 0 && (S_ISREG(st.st_mode) || S_ISBLK(st.st_mode))) {
+     pos = lseek(fd, 0, SEEK_CUR);
+   }
+   s->offset = pos >= 0 ? (int64_t)pos : -1;
+   s->fd = fd;
+   s->cb = cb;
+   s->user = user;
+   qvortex_lite_init_from_template(&s->ctx, tpl);
+ 
+   s->next = r->streams;
+   if (r->streams) r->streams->prev = s;
+   r->streams = s;
+   r->active++;
+ 
+   /* The stream is registered now: a failed submit stays queued for the next poll */
+   qvortex_reader_queue(r, s);
+   (void)qvortex_reader_dispatch(r);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ static void qvortex_lite_reader_free(struct qvortex_reader *r) {
+   /* Buffers can't be freed under a pending read, so let those land first */
+   r->closing = 1;
+   while (r->in_flight > 0 && qvortex_lite_reader_poll(r, 1) >= 0) {
+   }
+ 
+   /* If polling failed, reads may still be pending: stop the I/O before freeing */
+ #if HAVE_IO_URING
+   if (r->use_uring) {
+     qvortex_uring_teardown(&r->ring);
+     /* The ring winds down asynchronously, so unreported reads keep their buffers */
+     if (r->in_flight > 0) {
+       for (qvortex_reader_stream *s = r->streams; s; s = s->next) {
+         s->req[0].buf = s->req[1].buf = NULL;
+       }
+     }
+   }
+ #endif
+   if (r->threads) {
+     /* I/O threads finish every queued read before they exit */
+     pthread_mutex_lock(&r->lock);
+     r->shutdown = 1;
+     pthread_cond_broadcast(&r->req_cond);
+     pthread_mutex_unlock(&r->lock);
+     for (int t = 0; t < r->nthreads; t++) pthread_join(r->threads[t], NULL);
+     free(r->threads);
+   }
+   while (r->streams) qvortex_reader_finish(r, r->streams, QVORTEX_SUCCESS, 0);
+ 
+   pthread_mutex_destroy(&r->lock);
+   pthread_cond_destroy(&r->req_cond);
+   pthread_cond_destroy(&r->done_cond);
+   free(r);
+ }
+ #endif /* HAVE_POSIX_IO && HAVE_PTHREADS */
+ 
+ /* ------------------------------------------------------------------------
+    Public API Functions (with C linkage)
+    ------------------------------------------------------------------------ */
+ 
+ #ifdef __cplusplus
+ extern "C" {
+ #endif
+ 
+ /**
+  * One-shot hash function for Qvortex
+  *
+  * @param data            Input data to hash
+  * @param len             Length of input data
+  * @param blocks_per_sbox Legacy parameter (not used in Qvortex)
+  * @param use_precomputed Legacy parameter (not used in Qvortex)
+  * @param key             Optional key for keyed hashing
+  * @param key_len         Length of key
+  * @param out             Output buffer (64 bytes)
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_hash(const uint8_t *data, size_t len,
+                 int blocks_per_sbox, int use_precomputed,
+                 const uint8_t *key, size_t key_len,
+                 uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   
+   /* Parameter validation */
+   if (!data && len > 0) return QVORTEX_ERROR_NULL_POINTER;
+   if (!out) return QVORTEX_ERROR_NULL_POINTER;
+   
+   QVORTEX_PROBE2(hash_start, len, key_len);
+   qvortex_template scratch;
+   const qvortex_template *tpl = qvortex_lite_template_get(&scratch, key, key_len);
+   if (len <= QVORTEX_LITE_SHORT_MAX) {
+     qvortex_lite_hash_short(tpl, data, len, out);
+     QVORTEX_PROBE1(hash_done, len);
+     return QVORTEX_SUCCESS;
+   }
+ 
+   /* Backward compatibility with old VortexHash API, but using new QvortexLite */
+   qvortex_lite_ctx ctx;
+   qvortex_lite_init_from_template(&ctx, tpl);
+   qvortex_lite_update(&ctx, data, len);
+   qvortex_lite_final(&ctx, out);
+   QVORTEX_PROBE1(hash_done, len);
+   
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Initialize a Qvortex context
+  * 
+  * @param ctx     Pointer to context structure
+  * @param key     Optional key for keyed hashing
+  * @param key_len Length of key
+  * 
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_init(qvortex_lite_ctx *ctx, const uint8_t *key, size_t key_len) {
+   if (!ctx) return QVORTEX_ERROR_NULL_POINTER;
+   
+   QVORTEX_PROBE2(init_start, ctx, key_len);
+   qvortex_lite_init(ctx, key, key_len);
+   QVORTEX_PROBE1(init_done, ctx);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Update a Qvortex context with new data
+  * 
+  * @param ctx  Pointer to context structure
+  * @param data Input data to hash
+  * @param len  Length of input data
+  * 
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_update(qvortex_lite_ctx *ctx, const uint8_t *data, size_t len) {
+   if (!ctx) return QVORTEX_ERROR_NULL_POINTER;
+   if (!data && len > 0) return QVORTEX_ERROR_NULL_POINTER;
+   
+   QVORTEX_PROBE2(update_start, ctx, len);
+   qvortex_lite_update(ctx, data, len);
+   QVORTEX_PROBE1(update_done, ctx);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /* Shared argument checks for the scatter-gather API */
+ static int qvortex_check_iov(const struct iovec *iov, int iovcnt) {
+   if (iovcnt < 0) return QVORTEX_ERROR_UNSUPPORTED;
+   if (!iov && iovcnt > 0) return QVORTEX_ERROR_NULL_POINTER;
+   for (int v = 0; v < iovcnt; v++) {
+     if (!iov[v].iov_base && iov[v].iov_len > 0) return QVORTEX_ERROR_NULL_POINTER;
+   }
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Update a Qvortex context with a list of fragments, as if concatenated
+  *
+  * Blocks that straddle fragments are assembled in the context buffer and
+  * every whole block inside a fragment is compressed in place, so the
+  * result matches one qvortex_update over the joined data without copying
+  * it.
+  *
+  * @param ctx    Pointer to context structure
+  * @param iov    Array of iovcnt fragments
+  * @param iovcnt Number of fragments
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_updatev(qvortex_lite_ctx *ctx, const struct iovec *iov, int iovcnt) {
+   if (!ctx) return QVORTEX_ERROR_NULL_POINTER;
+   int rc = qvortex_check_iov(iov, iovcnt);
+   if (rc != QVORTEX_SUCCESS) return rc;
+ 
+   QVORTEX_PROBE2(update_start, ctx, iovcnt);
+   qvortex_lite_updatev(ctx, iov, iovcnt);
+   QVORTEX_PROBE1(update_done, ctx);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Finalize a Qvortex context and output the digest
+  * 
+  * @param ctx Pointer to context structure
+  * @param out Output buffer (64 bytes)
+  * 
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_final(qvortex_lite_ctx *ctx, uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   if (!ctx) return QVORTEX_ERROR_NULL_POINTER;
+   if (!out) return QVORTEX_ERROR_NULL_POINTER;
+   
+   QVORTEX_PROBE1(final_start, ctx);
+   qvortex_lite_final(ctx, out);
+   QVORTEX_PROBE1(final_done, ctx);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Derive a reusable keyed template
+  *
+  * Runs the SHAKE-128 key schedule once so that many contexts (or one-shot
+  * hashes) under the same key can skip it.
+  *
+  * @param tpl     Pointer to template structure
+  * @param key     Optional key for keyed hashing
+  * @param key_len Length of key
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_template_init(qvortex_template *tpl, const uint8_t *key, size_t key_len) {
+   if (!tpl) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   qvortex_lite_template_init(tpl, key, key_len);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Initialize a Qvortex context from a keyed template
+  *
+  * @param ctx Pointer to context structure
+  * @param tpl Template from qvortex_template_init
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_init_from_template(qvortex_lite_ctx *ctx, const qvortex_template *tpl) {
+   if (!ctx || !tpl) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   QVORTEX_PROBE2(init_start, ctx, 0);
+   qvortex_lite_init_from_template(ctx, tpl);
+   QVORTEX_PROBE1(init_done, ctx);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Derive a shared, reference-counted key
+  *
+  * Compact contexts (qvortex_ctx_init) point at the key's S-box instead of
+  * copying it, so any number of streams under one key share 256 bytes.
+  *
+  * @param key     Optional key for keyed hashing
+  * @param key_len Length of key
+  *
+  * @return New key holding one reference, or NULL on allocation failure
+  */
+ qvortex_key *qvortex_key_new(const uint8_t *key, size_t key_len) {
+   if (!key && key_len > 0) return NULL;
+   return qvortex_lite_key_new(key, key_len);
+ }
+ 
+ /**
+  * Take another reference to a key (thread-safe)
+  *
+  * @param key Key from qvortex_key_new
+  *
+  * @return key
+  */
+ qvortex_key *qvortex_key_retain(qvortex_key *key) {
+   if (key) qvortex_lite_key_retain(key);
+   return key;
+ }
+ 
+ /**
+  * Drop a reference to a key; the last one frees it (thread-safe)
+  *
+  * @param key Key from qvortex_key_new (NULL is ignored)
+  */
+ void qvortex_key_release(qvortex_key *key) {
+   if (key) qvortex_lite_key_release(key);
+ }
+ 
+ /**
+  * The template inside a key, for the *_with_template functions
+  *
+  * @param key Key from qvortex_key_new
+  *
+  * @return Template, valid while a reference to key is held
+  */
+ const qvortex_template *qvortex_key_template(const qvortex_key *key) {
+   return key ? &key->tpl : NULL;
+ }
+ 
+ /**
+  * Stable 64-bit identifier of a key, as recorded in context checkpoints
+  *
+  * Equal keys give equal ids in every process and on every platform, so
+  * a checkpoint can be matched to its key without storing the S-box.
+  *
+  * @param key Key from qvortex_key_new
+  *
+  * @return Key id, or 0 if key is NULL
+  */
+ uint64_t qvortex_key_id(const qvortex_key *key) {
+   return key ? key->id : 0;
+ }
+ 
+ /**
+  * Size of qvortex_ctx in bytes, for bindings and arena allocators
+  *
+  * @return sizeof(qvortex_ctx)
+  */
+ size_t qvortex_ctx_size(void) {
+   return sizeof(qvortex_ctx);
+ }
+ 
+ /**
+  * Required alignment of qvortex_ctx memory
+  *
+  * @return Alignment in bytes (a power of two)
+  */
+ size_t qvortex_ctx_align(void) {
+   return QVORTEX_CTX_ALIGN;
+ }
+ 
+ /**
+  * Initialize a compact context in caller-provided memory
+  *
+  * The context takes its own reference to key, released by
+  * qvortex_ctx_final or qvortex_ctx_discard.
+  *
+  * @param ctx Memory of qvortex_ctx_size() bytes aligned to qvortex_ctx_align()
+  * @param key Key from qvortex_key_new
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_ctx_init(qvortex_ctx *ctx, qvortex_key *key) {
+   if (!ctx || !key) return QVORTEX_ERROR_NULL_POINTER;
+   if ((uintptr_t)ctx % QVORTEX_CTX_ALIGN != 0) return QVORTEX_ERROR_UNSUPPORTED;
+ 
+   QVORTEX_PROBE2(init_start, ctx, 0);
+   qvortex_lite_cctx_init(ctx, key);
+   QVORTEX_PROBE1(init_done, ctx);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Fork a compact context midway through a stream
+  *
+  * dst continues from exactly where src is, so a shared prefix is hashed
+  * once and each record only pays for its own bytes. The fork copies the
+  * 64-byte state and the buffered tail, and retains the key rather than
+  * copying the S-box. Both contexts are then independent and each must be
+  * finalized or discarded.
+  *
+  * @param dst Uninitialized or discarded context, aligned like any qvortex_ctx
+  * @param src Live context from qvortex_ctx_init (not yet finalized)
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_ctx_clone(qvortex_ctx *dst, const qvortex_ctx *src) {
+   if (!dst || !src || !src->key) return QVORTEX_ERROR_NULL_POINTER;
+   if ((uintptr_t)dst % QVORTEX_CTX_ALIGN != 0) return QVORTEX_ERROR_UNSUPPORTED;
+   if (dst == src) return QVORTEX_SUCCESS;
+ 
+   qvortex_lite_cctx_clone(dst, src);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Update a compact context with new data
+  *
+  * @param ctx  Context from qvortex_ctx_init
+  * @param data Input data to hash
+  * @param len  Length of input data
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_ctx_update(qvortex_ctx *ctx, const uint8_t *data, size_t len) {
+   if (!ctx || !ctx->key) return QVORTEX_ERROR_NULL_POINTER;
+   if (!data && len > 0) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   QVORTEX_PROBE2(update_start, ctx, len);
+   if (len > 0) qvortex_lite_cctx_update(ctx, data, len);
+   QVORTEX_PROBE1(update_done, ctx);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Update a compact context with a list of fragments (see qvortex_updatev)
+  *
+  * @param ctx    Context from qvortex_ctx_init
+  * @param iov    Array of iovcnt fragments
+  * @param iovcnt Number of fragments
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_ctx_updatev(qvortex_ctx *ctx, const struct iovec *iov, int iovcnt) {
+   if (!ctx || !ctx->key) return QVORTEX_ERROR_NULL_POINTER;
+   int rc = qvortex_check_iov(iov, iovcnt);
+   if (rc != QVORTEX_SUCCESS) return rc;
+ 
+   QVORTEX_PROBE2(update_start, ctx, iovcnt);
+   qvortex_lite_cctx_updatev(ctx, iov, iovcnt);
+   QVORTEX_PROBE1(update_done, ctx);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Finalize a compact context, output the digest and release its key
+  *
+  * @param ctx Context from qvortex_ctx_init
+  * @param out Output buffer (64 bytes)
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_ctx_final(qvortex_ctx *ctx, uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   if (!ctx || !ctx->key) return QVORTEX_ERROR_NULL_POINTER;
+   if (!out) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   QVORTEX_PROBE1(final_start, ctx);
+   qvortex_lite_cctx_final(ctx, out);
+   QVORTEX_PROBE1(final_done, ctx);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Abandon a compact context without a digest, releasing its key
+  *
+  * Safe to call on a context that was already finalized or discarded.
+  *
+  * @param ctx Context from qvortex_ctx_init
+  */
+ void qvortex_ctx_discard(qvortex_ctx *ctx) {
+   if (ctx) qvortex_lite_cctx_discard(ctx);
+ }
+ 
+ /**
+  * Allocate and initialize a compact context on the heap
+  *
+  * @param key Key from qvortex_key_new
+  *
+  * @return New context, or NULL on failure
+  */
+ qvortex_ctx *qvortex_ctx_new(qvortex_key *key) {
+   if (!key) return NULL;
+ 
+   qvortex_ctx *ctx = (qvortex_ctx *)qvortex_aligned_alloc(QVORTEX_CTX_ALIGN, sizeof(qvortex_ctx));
+   if (!ctx) return NULL;
+   qvortex_lite_cctx_init(ctx, key);
+   return ctx;
+ }
+ 
+ /**
+  * Discard and free a context from qvortex_ctx_new
+  *
+  * @param ctx Context (NULL is ignored)
+  */
+ void qvortex_ctx_free(qvortex_ctx *ctx) {
+   if (!ctx) return;
+ 
+   qvortex_lite_cctx_discard(ctx);
+   qvortex_aligned_free(ctx);
+ }
+ 
+ /**
+  * Serialize a compact context so the stream can be resumed elsewhere
+  *
+  * The checkpoint is at most QVORTEX_CTX_EXPORT_MAX (147) bytes and holds
+  * the key id rather than the key, so it is only as secret as the data
+  * hashed so far. The context itself is left unchanged.
+  *
+  * @param ctx     Context from qvortex_ctx_init
+  * @param out     Output buffer
+  * @param out_cap Size of out, at least QVORTEX_CTX_EXPORT_MAX
+  * @param out_len Receives the number of bytes written
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_ctx_export(const qvortex_ctx *ctx, uint8_t *out, size_t out_cap, size_t *out_len) {
+   if (!ctx || !ctx->key || !out || !out_len) return QVORTEX_ERROR_NULL_POINTER;
+   if (out_cap < QVORTEX_CTX_EXPORT_MAX) return QVORTEX_ERROR_UNSUPPORTED;
+ 
+   *out_len = qvortex_lite_cctx_export(ctx, out);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Initialize a compact context from a checkpoint made by qvortex_ctx_export
+  *
+  * key must be the same key the checkpoint was made under (its
+  * qvortex_key_id must match); the context takes its own reference.
+  *
+  * @param ctx Memory of qvortex_ctx_size() bytes aligned to qvortex_ctx_align()
+  * @param key Key from qvortex_key_new
+  * @param in  Checkpoint bytes
+  * @param len Checkpoint length
+  *
+  * @return 0 on success, QVORTEX_ERROR_FORMAT if the checkpoint is malformed,
+  *         of another version or for another key
+  */
+ int qvortex_ctx_import(qvortex_ctx *ctx, qvortex_key *key, const uint8_t *in, size_t len) {
+   if (!ctx || !key || !in) return QVORTEX_ERROR_NULL_POINTER;
+   if ((uintptr_t)ctx % QVORTEX_CTX_ALIGN != 0) return QVORTEX_ERROR_UNSUPPORTED;
+ 
+   return qvortex_lite_cctx_import(ctx, key, in, len);
+ }
+ 
+ /**
+  * One-shot hash using a keyed template
+  *
+  * @param tpl  Template from qvortex_template_init
+  * @param data Input data to hash
+  * @param len  Length of input data
+  * @param out  Output buffer (64 bytes)
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_hash_with_template(const qvortex_template *tpl,
+                                const uint8_t *data, size_t len,
+                                uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   if (!tpl) return QVORTEX_ERROR_NULL_POINTER;
+   if (!data && len > 0) return QVORTEX_ERROR_NULL_POINTER;
+   if (!out) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   QVORTEX_PROBE2(hash_start, len, 0);
+   if (len <= QVORTEX_LITE_SHORT_MAX) {
+     qvortex_lite_hash_short(tpl, data, len, out);
+     QVORTEX_PROBE1(hash_done, len);
+     return QVORTEX_SUCCESS;
+   }
+ 
+   qvortex_lite_ctx ctx;
+   qvortex_lite_init_from_template(&ctx, tpl);
+   qvortex_lite_update(&ctx, data, len);
+   qvortex_lite_final(&ctx, out);
+   QVORTEX_PROBE1(hash_done, len);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * One-shot hash of a list of fragments using a keyed template
+  *
+  * Same digest as qvortex_hash_with_template over the concatenation.
+  *
+  * @param tpl    Template from qvortex_template_init
+  * @param iov    Array of iovcnt fragments
+  * @param iovcnt Number of fragments
+  * @param out    Output buffer (64 bytes)
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_hashv_with_template(const qvortex_template *tpl,
+                                 const struct iovec *iov, int iovcnt,
+                                 uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   if (!tpl || !out) return QVORTEX_ERROR_NULL_POINTER;
+   int rc = qvortex_check_iov(iov, iovcnt);
+   if (rc != QVORTEX_SUCCESS) return rc;
+ 
+   QVORTEX_PROBE2(hash_start, iovcnt, 0);
+   qvortex_lite_hashv(tpl, iov, iovcnt, out);
+   QVORTEX_PROBE1(hash_done, iovcnt);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * One-shot hash of a list of fragments
+  *
+  * @param iov     Array of iovcnt fragments
+  * @param iovcnt  Number of fragments
+  * @param key     Optional key for keyed hashing
+  * @param key_len Length of key
+  * @param out     Output buffer (64 bytes)
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_hashv(const struct iovec *iov, int iovcnt,
+                   const uint8_t *key, size_t key_len,
+                   uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   if (!out) return QVORTEX_ERROR_NULL_POINTER;
+   int rc = qvortex_check_iov(iov, iovcnt);
+   if (rc != QVORTEX_SUCCESS) return rc;
+ 
+   qvortex_template scratch;
+   QVORTEX_PROBE2(hash_start, iovcnt, key_len);
+   qvortex_lite_hashv(qvortex_lite_template_get(&scratch, key, key_len), iov, iovcnt, out);
+   QVORTEX_PROBE1(hash_done, iovcnt);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * 64-bit keyed hash for hash tables
+  *
+  * Equal to the XOR of the eight little-endian 64-bit words of the
+  * qvortex_hash_with_template digest, computed without a context. Derive
+  * tpl once from a secret random key to resist hash flooding (HashDoS).
+  *
+  * @param data Input data
+  * @param len  Length of input data
+  * @param tpl  Template from qvortex_template_init (NULL for unkeyed, which
+  *             derives the S-box on every call)
+  *
+  * @return The 64-bit hash, or 0 if data is NULL and len > 0
+  */
+ uint64_t qvortex_hash64(const void *data, size_t len, const qvortex_template *tpl) {
+   if (!data && len > 0) return 0;
+ 
+   if (!tpl) {
+     return qvortex_lite_hash64(&QL_DEFAULT_TEMPLATE, (const uint8_t *)data, len);
+   }
+   return qvortex_lite_hash64(tpl, (const uint8_t *)data, len);
+ }
+ 
+ /**
+  * Size of qvortex_template in bytes, for bindings that allocate it
+  *
+  * @return sizeof(qvortex_template)
+  */
+ size_t qvortex_template_size(void) {
+   return sizeof(qvortex_template);
+ }
+ 
+ /**
+  * Compress whole blocks with the active backend
+  *
+  * The bare compression function, for bindings that keep their own
+  * buffering and padding (such as qvortex::backend::dispatch in qvortex.hpp).
+  *
+  * @param state   Chaining state (8 words, starting from a template's state)
+  * @param sbox    S-box from the same template
+  * @param blocks  nblocks consecutive 64-byte blocks
+  * @param nblocks Number of blocks
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_compress(uint64_t state[QVORTEX_LITE_STATE_WORDS], const uint8_t sbox[256],
+                      const uint8_t *blocks, size_t nblocks) {
+   if (!state || !sbox) return QVORTEX_ERROR_NULL_POINTER;
+   if (!blocks && nblocks > 0) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   if (nblocks > 0) qvortex_backend_get()->compress(state, sbox, blocks, nblocks);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Start a SHAKE-128 extendable-output computation (NOT FIPS 202 SHAKE128)
+  *
+  * This is the sponge behind the Qvortex key schedule, on the selected
+  * backend's Keccak-f[1600]. Its permutation uses Qvortex's own pi step,
+  * so the output is NOT interchangeable with FIPS 202 SHAKE128; see
+  * qvortex_shake128_ctx.
+  *
+  * @param ctx Pointer to XOF context (qvortex_shake128_ctx_size() bytes)
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_shake128_init(qvortex_shake128_ctx *ctx) {
+   if (!ctx) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   shake128_init(&ctx->sponge);
+   ctx->squeezing = 0;
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Absorb input; whole 168-byte blocks are XORed in 64-bit lanes
+  *
+  * @param ctx Context from qvortex_shake128_init, not yet finalized
+  * @param in  Input data
+  * @param len Length of input data
+  *
+  * @return 0 on success, QVORTEX_ERROR_UNSUPPORTED after finalize
+  */
+ int qvortex_shake128_absorb(qvortex_shake128_ctx *ctx, const uint8_t *in, size_t len) {
+   if (!ctx) return QVORTEX_ERROR_NULL_POINTER;
+   if (!in && len > 0) return QVORTEX_ERROR_NULL_POINTER;
+   if (ctx->squeezing) return QVORTEX_ERROR_UNSUPPORTED;
+ 
+   if (len > 0) shake128_absorb(&ctx->sponge, in, len);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Pad the input and switch to squeezing
+  *
+  * @param ctx Context from qvortex_shake128_init
+  *
+  * @return 0 on success, QVORTEX_ERROR_UNSUPPORTED if already finalized
+  */
+ int qvortex_shake128_finalize(qvortex_shake128_ctx *ctx) {
+   if (!ctx) return QVORTEX_ERROR_NULL_POINTER;
+   if (ctx->squeezing) return QVORTEX_ERROR_UNSUPPORTED;
+ 
+   QVORTEX_STAT_ADD(shake128_calls, 1);
+   shake128_finalize(&ctx->sponge);
+   ctx->squeezing = 1;
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Squeeze output; may be called repeatedly to continue the stream
+  *
+  * @param ctx Finalized context
+  * @param out Output buffer
+  * @param len Bytes to produce
+  *
+  * @return 0 on success, QVORTEX_ERROR_UNSUPPORTED before finalize
+  */
+ int qvortex_shake128_squeeze(qvortex_shake128_ctx *ctx, uint8_t *out, size_t len) {
+   if (!ctx) return QVORTEX_ERROR_NULL_POINTER;
+   if (!out && len > 0) return QVORTEX_ERROR_NULL_POINTER;
+   if (!ctx->squeezing) return QVORTEX_ERROR_UNSUPPORTED;
+ 
+   if (len > 0) shake128_squeeze(&ctx->sponge, out, len);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * One-shot SHAKE-128 (same variant as qvortex_shake128_init, NOT FIPS 202)
+  *
+  * qvortex_shake128("") begins 665d6a34, where FIPS 202 SHAKE128 gives
+  * 7f9c2ba4; output never matches standard SHAKE128.
+  *
+  * @param in      Input data
+  * @param len     Length of input data
+  * @param out     Output buffer
+  * @param out_len Bytes to produce
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_shake128(const uint8_t *in, size_t len, uint8_t *out, size_t out_len) {
+   if (!in && len > 0) return QVORTEX_ERROR_NULL_POINTER;
+   if (!out && out_len > 0) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   shake128(in, len, out, out_len);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Initialize a wide (Qvortex-1024) context
+  *
+  * The wide variant runs the Qvortex construction over a 16-word state and
+  * 128-byte blocks and produces a 128-byte digest. It is a separate hash:
+  * its digests are unrelated to Qvortex digests under the same key.
+  *
+  * @param ctx     Pointer to wide context structure
+  * @param key     Optional key for keyed hashing
+  * @param key_len Length of key
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_wide_init(qvortex_wide_ctx *ctx, const uint8_t *key, size_t key_len) {
+   if (!ctx) return QVORTEX_ERROR_NULL_POINTER;
+   if (!key && key_len > 0) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   qvortex_template scratch;
+   qvortex_lite_wide_init(ctx, qvortex_lite_template_get(&scratch, key, key_len));
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Initialize a wide context from a keyed template (only its S-box is used)
+  *
+  * @param ctx Pointer to wide context structure
+  * @param tpl Template from qvortex_template_init
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_wide_init_from_template(qvortex_wide_ctx *ctx, const qvortex_template *tpl) {
+   if (!ctx || !tpl) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   qvortex_lite_wide_init(ctx, tpl);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Update a wide context with new data
+  *
+  * @param ctx  Pointer to wide context structure
+  * @param data Input data to hash
+  * @param len  Length of input data
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_wide_update(qvortex_wide_ctx *ctx, const uint8_t *data, size_t len) {
+   if (!ctx) return QVORTEX_ERROR_NULL_POINTER;
+   if (!data && len > 0) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   qvortex_lite_wide_update(ctx, data, len);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Finalize a wide context and wipe it
+  *
+  * @param ctx Pointer to wide context structure
+  * @param out Output buffer (128 bytes)
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_wide_final(qvortex_wide_ctx *ctx, uint8_t out[QVORTEX_WIDE_DIGEST_BYTES]) {
+   if (!ctx || !out) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   qvortex_lite_wide_final(ctx, out);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * One-shot wide hash using a keyed template
+  *
+  * @param tpl  Template from qvortex_template_init
+  * @param data Input data to hash
+  * @param len  Length of input data
+  * @param out  Output buffer (128 bytes)
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_wide_hash_with_template(const qvortex_template *tpl,
+                                     const uint8_t *data, size_t len,
+                                     uint8_t out[QVORTEX_WIDE_DIGEST_BYTES]) {
+   if (!tpl) return QVORTEX_ERROR_NULL_POINTER;
+   if (!data && len > 0) return QVORTEX_ERROR_NULL_POINTER;
+   if (!out) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   qvortex_wide_ctx ctx;
+   qvortex_lite_wide_init(&ctx, tpl);
+   qvortex_lite_wide_update(&ctx, data, len);
+   qvortex_lite_wide_final(&ctx, out);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * One-shot wide hash
+  *
+  * @param data    Input data to hash
+  * @param len     Length of input data
+  * @param key     Optional key for keyed hashing
+  * @param key_len Length of key
+  * @param out     Output buffer (128 bytes)
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_wide_hash(const uint8_t *data, size_t len, const uint8_t *key, size_t key_len,
+                       uint8_t out[QVORTEX_WIDE_DIGEST_BYTES]) {
+   if (!key && key_len > 0) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   qvortex_template scratch;
+   return qvortex_wide_hash_with_template(qvortex_lite_template_get(&scratch, key, key_len),
+                                          data, len, out);
+ }
+ 
+ /**
+  * Size of qvortex_wide_ctx in bytes, for bindings that allocate it
+  *
+  * @return sizeof(qvortex_wide_ctx)
+  */
+ size_t qvortex_wide_ctx_size(void) {
+   return sizeof(qvortex_wide_ctx);
+ }
+ 
+ /**
+  * Size of qvortex_shake128_ctx in bytes, for bindings that allocate it
+  *
+  * @return sizeof(qvortex_shake128_ctx)
+  */
+ size_t qvortex_shake128_ctx_size(void) {
+   return sizeof(qvortex_shake128_ctx);
+ }
+ 
+ /**
+  * Derive keyed templates for many keys at once
+  *
+  * Each template is identical to qvortex_template_init on that key alone,
+  * but the SHAKE-128 key schedules run side by side on the multi-lane
+  * Keccak of the selected backend (2 states on NEON, 4 on AVX2, 8 on
+  * AVX-512), which suits key rotation and bulk tenant onboarding.
+  *
+  * @param keys     Array of n key pointers (NULL or empty for unkeyed)
+  * @param key_lens Array of n key lengths
+  * @param n        Number of keys
+  * @param out      Output array of n templates
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_derive_templates(const uint8_t *const *keys, const size_t *key_lens,
+                              size_t n, qvortex_template *out) {
+   if (n == 0) return QVORTEX_SUCCESS;
+   if (!keys || !key_lens || !out) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   qvortex_lite_derive_templates(keys, key_lens, n, out);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /* Shared argument checks for the batch API */
+ static int qvortex_check_batch(const uint8_t *const *msgs, const size_t *lens,
+                                size_t n, const uint8_t *out) {
+   if (n == 0) return QVORTEX_SUCCESS;
+   if (!msgs || !lens || !out) return QVORTEX_ERROR_NULL_POINTER;
+   for (size_t i = 0; i < n; i++) {
+     if (!msgs[i] && lens[i] > 0) return QVORTEX_ERROR_NULL_POINTER;
+   }
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Hash many independent messages with a keyed template
+  *
+  * Messages are interleaved across SIMD lanes (2 on NEON, 4 on AVX2 and the
+  * scalar backend, 8 on AVX-512); lengths may differ freely. Each digest is
+  * identical to qvortex_hash_with_template on that message alone.
+  *
+  * @param tpl  Template from qvortex_template_init
+  * @param msgs Array of n message pointers
+  * @param lens Array of n message lengths
+  * @param n    Number of messages
+  * @param out  Output buffer (n * 64 bytes, digest i at out + 64 * i)
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_hash_many_with_template(const qvortex_template *tpl,
+                                     const uint8_t *const *msgs, const size_t *lens,
+                                     size_t n, uint8_t *out) {
+   if (!tpl) return QVORTEX_ERROR_NULL_POINTER;
+   int rc = qvortex_check_batch(msgs, lens, n, out);
+   if (rc != QVORTEX_SUCCESS || n == 0) return rc;
+ 
+   qvortex_lite_hash_many(tpl, msgs, lens, n, out);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Hash many independent messages under one key
+  *
+  * The key schedule runs once and its S-box is shared by the whole batch.
+  *
+  * @param msgs    Array of n message pointers
+  * @param lens    Array of n message lengths
+  * @param n       Number of messages
+  * @param key     Optional key for keyed hashing
+  * @param key_len Length of key
+  * @param out     Output buffer (n * 64 bytes, digest i at out + 64 * i)
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_hash_many(const uint8_t *const *msgs, const size_t *lens, size_t n,
+                       const uint8_t *key, size_t key_len, uint8_t *out) {
+   int rc = qvortex_check_batch(msgs, lens, n, out);
+   if (rc != QVORTEX_SUCCESS || n == 0) return rc;
+ 
+   qvortex_template scratch;
+   qvortex_lite_hash_many(qvortex_lite_template_get(&scratch, key, key_len), msgs, lens, n, out);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Check a MAC tag against a message under a keyed template
+  *
+  * The tag is compared in constant time. A tag shorter than 64 bytes is
+  * checked against the same-length prefix of the digest; every byte
+  * dropped from the tag makes forgery 256 times easier.
+  *
+  * @param tpl     Template from qvortex_template_init
+  * @param msg     Message
+  * @param len     Length of message
+  * @param tag     Expected tag
+  * @param tag_len Length of tag (1 to 64)
+  *
+  * @return 0 if the tag matches, QVORTEX_ERROR_VERIFY if it does not,
+  *         other non-zero values on invalid arguments
+  */
+ int qvortex_verify(const qvortex_template *tpl, const uint8_t *msg, size_t len,
+                    const uint8_t *tag, size_t tag_len) {
+   if (!tpl || !tag) return QVORTEX_ERROR_NULL_POINTER;
+   if (!msg && len > 0) return QVORTEX_ERROR_NULL_POINTER;
+   if (tag_len == 0 || tag_len > QVORTEX_LITE_DIGEST_BYTES) return QVORTEX_ERROR_UNSUPPORTED;
+ 
+   uint8_t digest[QVORTEX_LITE_DIGEST_BYTES];
+   if (len <= QVORTEX_LITE_SHORT_MAX) {
+     qvortex_lite_hash_short(tpl, msg, len, digest);
+   } else {
+     qvortex_lite_ctx ctx;
+     qvortex_lite_init_from_template(&ctx, tpl);
+     qvortex_lite_update(&ctx, msg, len);
+     qvortex_lite_final(&ctx, digest);
+     memset(&ctx, 0, sizeof(ctx));
+   }
+ 
+   uint32_t ok = qvortex_ct_equal(digest, tag, tag_len);
+   memset(digest, 0, sizeof(digest));
+   return ok ? QVORTEX_SUCCESS : QVORTEX_ERROR_VERIFY;
+ }
+ 
+ /**
+  * Check many MAC tags under one keyed template
+  *
+  * Messages are hashed across SIMD lanes as in qvortex_hash_many_with_template
+  * and every tag is compared in constant time. No early exit: the call
+  * takes as long for a batch of forgeries as for a batch of valid tags.
+  *
+  * @param tpl     Template from qvortex_template_init
+  * @param msgs    Array of n message pointers
+  * @param lens    Array of n message lengths
+  * @param tags    Array of n tag pointers
+  * @param tag_len Length of every tag (1 to 64)
+  * @param n       Number of messages
+  * @param bitmap  Output of (n + 7) / 8 bytes; bit i % 8 of byte i / 8 is
+  *                set if tag i matches
+  *
+  * @return 0 on success (whatever the tags), non-zero on invalid arguments
+  */
+ int qvortex_verify_many(const qvortex_template *tpl,
+                         const uint8_t *const *msgs, const size_t *lens,
+                         const uint8_t *const *tags, size_t tag_len,
+                         size_t n, uint8_t *bitmap) {
+   if (!tpl) return QVORTEX_ERROR_NULL_POINTER;
+   if (tag_len == 0 || tag_len > QVORTEX_LITE_DIGEST_BYTES) return QVORTEX_ERROR_UNSUPPORTED;
+   int rc = qvortex_check_batch(msgs, lens, n, bitmap);
+   if (rc != QVORTEX_SUCCESS || n == 0) return rc;
+   if (!tags) return QVORTEX_ERROR_NULL_POINTER;
+   for (size_t i = 0; i < n; i++) {
+     if (!tags[i]) return QVORTEX_ERROR_NULL_POINTER;
+   }
+ 
+   qvortex_lite_verify_many(tpl, msgs, lens, tags, tag_len, n, bitmap);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Hash everything readable from a file descriptor
+  *
+  * Regular files of 1 MiB or more are memory-mapped with MADV_SEQUENTIAL
+  * and hashed in place; pipes, sockets and small files are read in 1 MiB
+  * aligned chunks. Hashing starts at the current offset and leaves the
+  * descriptor at end of file. Not available on Windows.
+  *
+  * @param fd      Open file descriptor
+  * @param key     Optional key for keyed hashing
+  * @param key_len Length of key
+  * @param out     Output buffer (64 bytes)
+  *
+  * @return 0 on success, non-zero on error (QVORTEX_ERROR_IO with errno set)
+  */
+ int qvortex_hash_fd(int fd, const uint8_t *key, size_t key_len,
+                     uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   if (!out) return QVORTEX_ERROR_NULL_POINTER;
+ 
+ #if HAVE_POSIX_IO
+   qvortex_template tpl;
+   qvortex_lite_template_init(&tpl, key, key_len);
+   return qvortex_lite_hash_fd(&tpl, fd, out);
+ #else
+   (void)fd;
+   (void)key;
+   (void)key_len;
+   return QVORTEX_ERROR_UNSUPPORTED;
+ #endif
+ }
+ 
+ /**
+  * Hash a file by path without reading it into the caller's memory
+  *
+  * @param path    Path of the file to hash
+  * @param key     Optional key for keyed hashing
+  * @param key_len Length of key
+  * @param out     Output buffer (64 bytes)
+  *
+  * @return 0 on success, non-zero on error (QVORTEX_ERROR_IO with errno set)
+  */
+ int qvortex_hash_file(const char *path, const uint8_t *key, size_t key_len,
+                       uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   if (!path || !out) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   qvortex_template tpl;
+   qvortex_lite_template_init(&tpl, key, key_len);
+   return qvortex_lite_hash_file(&tpl, path, out);
+ }
+ 
+ /**
+  * Create a content-defined chunker that digests each chunk as it is found
+  *
+  * Boundaries come from a FastCDC gear hash with normalized chunking: no
+  * chunk is shorter than min_size (except the last) or longer than
+  * max_size, and lengths cluster around avg_size. Boundaries depend only
+  * on the content and the three sizes, not on the key or on how the input
+  * is split across qvortex_chunker_update calls.
+  *
+  * @param min_size Smallest chunk length (at least 1)
+  * @param avg_size Target chunk length (at least 64; rounded down to a power of two)
+  * @param max_size Largest chunk length (at most 1 GiB)
+  * @param key      Optional key for keyed chunk digests
+  * @param key_len  Length of key
+  * @param cb       Called with each chunk, in stream order
+  * @param user     Passed to cb
+  *
+  * @return New chunker, or NULL on invalid sizes or allocation failure
+  */
+ qvortex_chunker *qvortex_chunker_new(size_t min_size, size_t avg_size, size_t max_size,
+                                      const uint8_t *key, size_t key_len,
+                                      qvortex_chunk_cb cb, void *user) {
+   if (!cb || (!key && key_len > 0)) return NULL;
+ 
+   qvortex_chunker *c = (qvortex_chunker *)malloc(sizeof(*c));
+   if (!c) return NULL;
+   if (qvortex_lite_chunker_init(c, min_size, avg_size, max_size, key, key_len,
+                                 cb, user) != QVORTEX_SUCCESS) {
+     free(c);
+     return NULL;
+   }
+   return c;
+ }
+ 
+ /**
+  * Feed the next bytes of the stream; completed chunks are reported to cb
+  *
+  * @param c    Chunker from qvortex_chunker_new
+  * @param data Input data
+  * @param len  Length of input data
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_chunker_update(qvortex_chunker *c, const uint8_t *data, size_t len) {
+   if (!c) return QVORTEX_ERROR_NULL_POINTER;
+   if (!data && len > 0) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   qvortex_lite_chunker_update(c, data, len);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * End the stream: report the trailing chunk and reset for a new stream
+  *
+  * @param c Chunker from qvortex_chunker_new
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_chunker_final(qvortex_chunker *c) {
+   if (!c) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   qvortex_lite_chunker_final(c);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Free a chunker, dropping any unfinished chunk
+  *
+  * @param c Chunker (NULL is ignored)
+  */
+ void qvortex_chunker_free(qvortex_chunker *c) {
+   if (!c) return;
+ 
+   qvortex_lite_chunker_wipe(c);
+   free(c);
+ }
+ 
+ /**
+  * Chunk and digest a buffer in one pass
+  *
+  * @param data     Input data
+  * @param len      Length of input data
+  * @param min_size Smallest chunk length
+  * @param avg_size Target chunk length
+  * @param max_size Largest chunk length
+  * @param key      Optional key for keyed chunk digests
+  * @param key_len  Length of key
+  * @param chunks   Receives an array of chunks, freed with qvortex_chunks_free
+  * @param count    Receives the number of chunks (0 for empty input)
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_chunk_buffer(const uint8_t *data, size_t len,
+                          size_t min_size, size_t avg_size, size_t max_size,
+                          const uint8_t *key, size_t key_len,
+                          qvortex_chunk **chunks, size_t *count) {
+   if (!data && len > 0) return QVORTEX_ERROR_NULL_POINTER;
+   if (!chunks || !count) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   return qvortex_lite_chunk_collect(qvortex_chunk_source_buffer, data, len,
+                                     min_size, avg_size, max_size, key, key_len, chunks, count);
+ }
+ 
+ /**
+  * Chunk and digest everything readable from a file descriptor
+  *
+  * Uses the same mmap and read() paths as qvortex_hash_fd. Not available
+  * on Windows.
+  *
+  * @param fd       Open file descriptor
+  * @param min_size Smallest chunk length
+  * @param avg_size Target chunk length
+  * @param max_size Largest chunk length
+  * @param key      Optional key for keyed chunk digests
+  * @param key_len  Length of key
+  * @param chunks   Receives an array of chunks, freed with qvortex_chunks_free
+  * @param count    Receives the number of chunks
+  *
+  * @return 0 on success, non-zero on error (QVORTEX_ERROR_IO with errno set)
+  */
+ int qvortex_chunk_fd(int fd, size_t min_size, size_t avg_size, size_t max_size,
+                      const uint8_t *key, size_t key_len,
+                      qvortex_chunk **chunks, size_t *count) {
+   if (!chunks || !count) return QVORTEX_ERROR_NULL_POINTER;
+ 
+ #if HAVE_POSIX_IO
+   return qvortex_lite_chunk_collect(qvortex_chunk_source_fd, &fd, 0,
+                                     min_size, avg_size, max_size, key, key_len, chunks, count);
+ #else
+   (void)fd;
+   (void)min_size;
+   (void)avg_size;
+   (void)max_size;
+   (void)key;
+   (void)key_len;
+   return QVORTEX_ERROR_UNSUPPORTED;
+ #endif
+ }
+ 
+ /**
+  * Chunk and digest a file by path
+  *
+  * @param path     Path of the file
+  * @param min_size Smallest chunk length
+  * @param avg_size Target chunk length
+  * @param max_size Largest chunk length
+  * @param key      Optional key for keyed chunk digests
+  * @param key_len  Length of key
+  * @param chunks   Receives an array of chunks, freed with qvortex_chunks_free
+  * @param count    Receives the number of chunks
+  *
+  * @return 0 on success, non-zero on error (QVORTEX_ERROR_IO with errno set)
+  */
+ int qvortex_chunk_file(const char *path, size_t min_size, size_t avg_size, size_t max_size,
+                        const uint8_t *key, size_t key_len,
+                        qvortex_chunk **chunks, size_t *count) {
+   if (!path || !chunks || !count) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   return qvortex_lite_chunk_collect(qvortex_chunk_source_file, path, 0,
+                                     min_size, avg_size, max_size, key, key_len, chunks, count);
+ }
+ 
+ /**
+  * Free an array from qvortex_chunk_buffer, qvortex_chunk_fd or qvortex_chunk_file
+  *
+  * @param chunks Array (NULL is ignored)
+  */
+ void qvortex_chunks_free(qvortex_chunk *chunks) {
+   free(chunks);
+ }
+ 
+ /**
+  * Create a streaming reader that hashes many descriptors from one thread
+  *
+  * Every stream double-buffers: its next read is issued before the data
+  * just read is hashed, so I/O and hashing overlap. Reads use io_uring on
+  * Linux and a pool of I/O threads otherwise.
+  *
+  * @param depth        Reads in flight across all streams (0 for 64)
+  * @param buffer_bytes Size of each of a stream's two buffers (0 for 256 KiB)
+  * @param flags        QVORTEX_READER_THREADS to skip io_uring
+  *
+  * @return New reader, or NULL on failure or without POSIX I/O
+  */
+ qvortex_reader *qvortex_reader_new(unsigned depth, size_t buffer_bytes, unsigned flags) {
+ #if HAVE_POSIX_IO && HAVE_PTHREADS
+   if (depth == 0) depth = QVORTEX_READER_DEPTH;
+   if (buffer_bytes == 0) buffer_bytes = QVORTEX_READER_BUFFER_BYTES;
+   if (buffer_bytes > (1u << 30)) buffer_bytes = 1u << 30;  /* io_uring lengths are 32-bit */
+   return qvortex_lite_reader_new(depth, buffer_bytes, flags);
+ #else
+   (void)depth;
+   (void)buffer_bytes;
+   (void)flags;
+   return NULL;
+ #endif
+ }
+ 
+ /**
+  * Start hashing a descriptor with a keyed template
+  *
+  * The descriptor is read from its current offset to end of file; it must
+  * stay open until the callback runs and is never closed by the reader.
+  *
+  * @param r    Reader from qvortex_reader_new
+  * @param fd   Open descriptor (file, pipe or socket)
+  * @param tpl  Template from qvortex_template_init
+  * @param cb   Called from qvortex_reader_poll once the stream is done
+  * @param user Passed through to cb
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_reader_add_fd_with_template(qvortex_reader *r, int fd, const qvortex_template *tpl,
+                                         qvortex_reader_cb cb, void *user) {
+   if (!r || !tpl || !cb) return QVORTEX_ERROR_NULL_POINTER;
+ 
+ #if HAVE_POSIX_IO && HAVE_PTHREADS
+   return qvortex_lite_reader_add(r, fd, tpl, cb, user);
+ #else
+   (void)fd;
+   (void)user;
+   return QVORTEX_ERROR_UNSUPPORTED;
+ #endif
+ }
+ 
+ /**
+  * Start hashing a descriptor
+  *
+  * @param r       Reader from qvortex_reader_new
+  * @param fd      Open descriptor (file, pipe or socket)
+  * @param key     Optional key for keyed hashing
+  * @param key_len Length of key
+  * @param cb      Called from qvortex_reader_poll once the stream is done
+  * @param user    Passed through to cb
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_reader_add_fd(qvortex_reader *r, int fd, const uint8_t *key, size_t key_len,
+                           qvortex_reader_cb cb, void *user) {
+   qvortex_template tpl;
+   qvortex_lite_template_init(&tpl, key, key_len);
+   return qvortex_reader_add_fd_with_template(r, fd, &tpl, cb, user);
+ }
+ 
+ /**
+  * Process finished reads and run the callbacks of finished streams
+  *
+  * @param r    Reader from qvortex_reader_new
+  * @param wait Non-zero to block until at least one read completes
+  *
+  * @return Number of streams still in progress, or a negative error code
+  */
+ int qvortex_reader_poll(qvortex_reader *r, int wait) {
+   if (!r) return QVORTEX_ERROR_NULL_POINTER;
+ 
+ #if HAVE_POSIX_IO && HAVE_PTHREADS
+   return qvortex_lite_reader_poll(r, wait);
+ #else
+   (void)wait;
+   return QVORTEX_ERROR_UNSUPPORTED;
+ #endif
+ }
+ 
+ /**
+  * Drive the reader until every stream has finished
+  *
+  * @param r Reader from qvortex_reader_new
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_reader_run(qvortex_reader *r) {
+   int rc;
+   while ((rc = qvortex_reader_poll(r, 1)) > 0) {
+   }
+   return rc;
+ }
+ 
+ /**
+  * Name of the I/O mechanism a reader uses
+  *
+  * @param r Reader from qvortex_reader_new
+  *
+  * @return "io_uring" or "threads"
+  */
+ const char *qvortex_reader_backend(const qvortex_reader *r) {
+ #if HAVE_POSIX_IO && HAVE_PTHREADS
+   if (r && r->use_uring) return "io_uring";
+ #else
+   (void)r;
+ #endif
+   return "threads";
+ }
+ 
+ /**
+  * Release a reader
+  *
+  * Reads still in flight are allowed to land first; streams that have not
+  * finished are dropped without running their callbacks.
+  *
+  * @param r Reader from qvortex_reader_new (NULL is ignored)
+  */
+ void qvortex_reader_free(qvortex_reader *r) {
+   if (!r) return;
+ 
+ #if HAVE_POSIX_IO && HAVE_PTHREADS
+   qvortex_lite_reader_free(r);
+ #endif
+ }
+ 
+ /**
+  * Return the version string of the Qvortex implementation
+  * 
+  * @return Version string
+  */
+ const char* qvortex_version(void) {
+   static char version[16];
+   snprintf(version, sizeof(version), "%d.%d.%d", 
+            QVORTEX_VERSION_MAJOR, 
+            QVORTEX_VERSION_MINOR, 
+            QVORTEX_VERSION_PATCH);
+   return version;
+ }
+ 
+ /**
+  * Create a streaming tree-mode context
+  *
+  * Tree mode produces a different digest from qvortex_hash. Full 8 KiB
+  * chunks are hashed by a work-stealing pool owned by the context as they
+  * arrive in qvortex_tree_update; the caller's thread works too.
+  *
+  * @param key      Optional key for keyed hashing
+  * @param key_len  Length of key
+  * @param nthreads Threads to use including the caller, 0 for one per online CPU
+  *
+  * @return New context, or NULL on allocation failure
+  */
+ qvortex_tree_ctx *qvortex_tree_new(const uint8_t *key, size_t key_len, int nthreads) {
+   qvortex_tree_ctx *ctx = (qvortex_tree_ctx *)calloc(1, sizeof(qvortex_tree_ctx));
+   if (!ctx) return NULL;
+ 
+   qvortex_lite_template_init(&ctx->tpl, key, key_len);
+ 
+ #if HAVE_PTHREADS
+   if (nthreads <= 0) {
+     long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+     nthreads = ncpu > 0 ? (int)ncpu : 1;
+   }
+   /* A failed pool just means single-threaded hashing */
+   if (nthreads > 1) ctx->pool = qvortex_pool_create(nthreads - 1);
+ #else
+   (void)nthreads;
+ #endif
+   return ctx;
+ }
+ 
+ /**
+  * Feed data into a tree-mode context
+  *
+  * Returns once every full chunk in data has been hashed, so the buffer may
+  * be reused immediately.
+  *
+  * @param ctx  Context from qvortex_tree_new
+  * @param data Input data to hash
+  * @param len  Length of input data
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_tree_update(qvortex_tree_ctx *ctx, const uint8_t *data, size_t len) {
+   if (!ctx) return QVORTEX_ERROR_NULL_POINTER;
+   if (!data && len > 0) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   qvortex_lite_tree_update(ctx, data, len);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Finalize a tree-mode context and output the digest
+  *
+  * The context can not be updated afterwards; release it with qvortex_tree_free.
+  *
+  * @param ctx Context from qvortex_tree_new
+  * @param out Output buffer (64 bytes)
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_tree_final(qvortex_tree_ctx *ctx, uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   if (!ctx) return QVORTEX_ERROR_NULL_POINTER;
+   if (!out) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   qvortex_lite_tree_final(ctx, out);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Release a tree-mode context and its worker threads
+  *
+  * @param ctx Context from qvortex_tree_new (NULL is ignored)
+  */
+ void qvortex_tree_free(qvortex_tree_ctx *ctx) {
+   if (!ctx) return;
+ 
+ #if HAVE_PTHREADS
+   qvortex_pool_destroy(ctx->pool);
+ #endif
+   /* Zeroize context state for security */
+   memset(ctx, 0, sizeof(qvortex_tree_ctx));
+   free(ctx);
+ }
+ 
+ /**
+  * One-shot tree-mode hash
+  *
+  * @param data     Input data to hash
+  * @param len      Length of input data
+  * @param key      Optional key for keyed hashing
+  * @param key_len  Length of key
+  * @param nthreads Threads to use including the caller, 0 for one per online CPU
+  * @param out      Output buffer (64 bytes)
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_tree_hash(const uint8_t *data, size_t len,
+                       const uint8_t *key, size_t key_len, int nthreads,
+                       uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   if (!data && len > 0) return QVORTEX_ERROR_NULL_POINTER;
+   if (!out) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   /* Threads don't pay off below a few tasks' worth of chunks */
+   if (len <= 4 * QVORTEX_TREE_TASK_CHUNKS * QVORTEX_TREE_CHUNK_BYTES) nthreads = 1;
+ 
+   qvortex_tree_ctx *ctx = qvortex_tree_new(key, key_len, nthreads);
+   if (!ctx) return QVORTEX_ERROR_MEMORY_ALLOCATION;
+ 
+   qvortex_lite_tree_update(ctx, data, len);
+   qvortex_lite_tree_final(ctx, out);
+   qvortex_tree_free(ctx);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Create an incremental tree-mode hasher
+  *
+  * The root it computes is the qvortex_tree_hash digest of the input. It
+  * also keeps every chaining value (128 bytes per 8 KiB chunk), so after an
+  * in-place edit qvortex_merkle_update rehashes only the touched chunks and
+  * their path to the root. Export the values to keep them next to the file.
+  *
+  * @param key     Optional key for keyed hashing
+  * @param key_len Length of key
+  *
+  * @return New tree (empty until built), or NULL on allocation failure
+  */
+ qvortex_merkle *qvortex_merkle_new(const uint8_t *key, size_t key_len) {
+   if (!key && key_len > 0) return NULL;
+ 
+   qvortex_merkle *m = (qvortex_merkle *)calloc(1, sizeof(qvortex_merkle));
+   if (!m) return NULL;
+   qvortex_lite_template_init(&m->tpl, key, key_len);
+   return m;
+ }
+ 
+ /**
+  * Update the tree after in-place edits of a buffer
+  *
+  * Only the chunks under the given ranges are read; a change of length also
+  * rehashes from the old last chunk on. A tree that was never built (or
+  * whose last update failed) is built from the whole buffer, as it is
+  * with nranges = 0.
+  *
+  * @param m       Tree from qvortex_merkle_new or qvortex_merkle_import
+  * @param data    The whole current input
+  * @param len     Length of the input
+  * @param ranges  Byte ranges modified since the last update
+  * @param nranges Number of ranges
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_merkle_update(qvortex_merkle *m, const uint8_t *data, size_t len,
+                           const qvortex_range *ranges, size_t nranges) {
+   if (!m) return QVORTEX_ERROR_NULL_POINTER;
+   if (!data && len > 0) return QVORTEX_ERROR_NULL_POINTER;
+   if (!ranges && nranges > 0) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   return qvortex_lite_merkle_update(m, len, ranges, nranges, qvortex_merkle_source_buffer,
+                                     (void *)data, NULL);
+ }
+ 
+ /**
+  * Update the tree after in-place edits of a file
+  *
+  * As qvortex_merkle_update, reading only the dirty chunks with pread; the
+  * length is taken from fstat and the file offset is left alone.
+  *
+  * @param m       Tree from qvortex_merkle_new or qvortex_merkle_import
+  * @param fd      Readable file descriptor
+  * @param ranges  Byte ranges modified since the last update
+  * @param nranges Number of ranges
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_merkle_update_fd(qvortex_merkle *m, int fd,
+                              const qvortex_range *ranges, size_t nranges) {
+   if (!m) return QVORTEX_ERROR_NULL_POINTER;
+   if (!ranges && nranges > 0) return QVORTEX_ERROR_NULL_POINTER;
+ 
+ #if HAVE_POSIX_IO
+   struct stat st;
+   if (fstat(fd, &st) != 0 || st.st_size < 0) return QVORTEX_ERROR_IO;
+ 
+   uint8_t *scratch = (uint8_t *)malloc(QVORTEX_MERKLE_BATCH_CHUNKS * QVORTEX_TREE_CHUNK_BYTES);
+   if (!scratch) return QVORTEX_ERROR_MEMORY_ALLOCATION;
+   int rc = qvortex_lite_merkle_update(m, (uint64_t)st.st_size, ranges, nranges,
+                                       qvortex_merkle_source_fd, &fd, scratch);
+   free(scratch);
+   return rc;
+ #else
+   (void)fd;
+   return QVORTEX_ERROR_UNSUPPORTED;
+ #endif
+ }
+ 
+ /**
+  * Forget the stored values so the next update rebuilds the whole tree
+  *
+  * @param m Tree from qvortex_merkle_new
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_merkle_reset(qvortex_merkle *m) {
+   if (!m) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   m->valid = 0;
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Root digest of the input as of the last update
+  *
+  * @param m   Built tree
+  * @param out Output buffer (64 bytes), equal to qvortex_tree_hash of the input
+  *
+  * @return 0 on success, QVORTEX_ERROR_UNSUPPORTED if the tree is not built
+  */
+ int qvortex_merkle_root(const qvortex_merkle *m, uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
+   if (!m || !out) return QVORTEX_ERROR_NULL_POINTER;
+   if (!m->valid) return QVORTEX_ERROR_UNSUPPORTED;
+ 
+   memcpy(out, m->root, QVORTEX_LITE_DIGEST_BYTES);
+   return QVORTEX_SUCCESS;
+ }
+ 
+ /**
+  * Size of the serialized tree (84 bytes plus 64 per node)
+  *
+  * @param m Built tree
+  *
+  * @return Bytes needed by qvortex_merkle_export, or 0 if the tree is not built
+  */
+ size_t qvortex_merkle_export_size(const qvortex_merkle *m) {
+   if (!m || !m->valid) return 0;
+   return qvortex_merkle_export_bytes(m->chunks);
  }
  
- static inline void qvortex_lite_init(qvortex_lite_ctx *ctx, const uint8_t *key, size_t key_len) {
-   /* Initialize state with constants */
-   static const uint64_t QL_IV[QVORTEX_LITE_STATE_WORDS] = {
-     0x6A09E667F3BCC908ULL, 0xBB67AE8584CAA73BULL, 0x3C6EF372FE94F82BULL,
-     0xA54FF53A5F1D36F1ULL, 0x510E527FADE682D1ULL, 0x9B05688C2B3E6C1FULL,
-     0x1F83D9ABFB41BD6BULL, 0x5BE0CD19137E2179ULL
-   };
-   memcpy(ctx->state, QL_IV, sizeof(ctx->state));
- 
-   /* Generate the S-box using SHAKE-128 */
-   uint8_t sbox_seed[32];
-   if (key && key_len > 0) {
-     shake128(key, key_len, sbox_seed, 32);
-   } else {
-     /* Default seed if no key */
-     memset(sbox_seed, 0xCC, 32);
-   }
-   shake128(sbox_seed, 32, ctx->sbox, 256);
+ /**
+  * Serialize the root and every chaining value, e.g. to store beside the file
+  *
+  * @param m       Built tree
+  * @param out     Output buffer
+  * @param out_cap Capacity of out, at least qvortex_merkle_export_size(m)
+  * @param out_len Receives the number of bytes written
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_merkle_export(const qvortex_merkle *m, uint8_t *out, size_t out_cap, size_t *out_len) {
+   if (!m || !out || !out_len) return QVORTEX_ERROR_NULL_POINTER;
+   if (!m->valid || out_cap < qvortex_merkle_export_bytes(m->chunks)) return QVORTEX_ERROR_UNSUPPORTED;
  
-   /* Initialize buffer state */
-   ctx->buffer_len = 0;
-   ctx->total_len = 0;
+   qvortex_lite_merkle_export(m, out);
+   *out_len = qvortex_merkle_export_bytes(m->chunks);
+   return QVORTEX_SUCCESS;
  }
  
- static inline void qvortex_lite_update(qvortex_lite_ctx *ctx, const uint8_t *data, size_t len) {
-   ctx->total_len += len;
-   size_t data_off = 0;
+ /**
+  * Load values from qvortex_merkle_export into a tree created with the same key
+  *
+  * The values are trusted to describe the input as it was when exported;
+  * pass every range modified since then to the next update.
+  *
+  * @param m   Tree from qvortex_merkle_new (built or not)
+  * @param in  Serialized tree
+  * @param len Length of in
+  *
+  * @return 0 on success, QVORTEX_ERROR_FORMAT if in is malformed or from another key
+  */
+ int qvortex_merkle_import(qvortex_merkle *m, const uint8_t *in, size_t len) {
+   if (!m || !in) return QVORTEX_ERROR_NULL_POINTER;
  
-   /* Process remaining buffer first */
-   if (ctx->buffer_len > 0) {
-     size_t needed = QVORTEX_LITE_BLOCK_BYTES - ctx->buffer_len;
-     size_t can_copy = (len < needed) ? len : needed;
-     
-     memcpy(&ctx->buffer[ctx->buffer_len], data, can_copy);
-     ctx->buffer_len += can_copy;
-     data_off += can_copy;
-     len -= can_copy;
+   return qvortex_lite_merkle_import(m, in, len);
+ }
  
-     if (ctx->buffer_len == QVORTEX_LITE_BLOCK_BYTES) {
-       qvortex_lite_process_block(ctx, ctx->buffer);
-       ctx->buffer_len = 0;
-     }
-   }
+ /**
+  * Release a tree and wipe its chaining values
+  *
+  * @param m Tree from qvortex_merkle_new (NULL is ignored)
+  */
+ void qvortex_merkle_free(qvortex_merkle *m) {
+   if (!m) return;
  
-   /* Process full blocks */
-   while (len >= QVORTEX_LITE_BLOCK_BYTES) {
-     qvortex_lite_process_block(ctx, data + data_off);
-     data_off += QVORTEX_LITE_BLOCK_BYTES;
-     len -= QVORTEX_LITE_BLOCK_BYTES;
+   if (m->cvs) {
+     memset(m->cvs, 0, (size_t)(2 * m->chunks - 1) * sizeof(m->cvs[0]));
+     free(m->cvs);
    }
+   memset(m, 0, sizeof(*m));
+   free(m);
+ }
  
-   /* Copy remaining data to buffer */
-   if (len > 0) {
-     memcpy(ctx->buffer, data + data_off, len);
-     ctx->buffer_len = len;
+ /**
+  * Create a digest index file with room for a fixed number of entries
+  *
+  * @param path     File to create; it must not already exist
+  * @param capacity Maximum number of entries (at least 1)
+  * @param out      Receives the open, writable index
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_index_create(const char *path, uint64_t capacity, qvortex_index **out) {
+   if (!path || !out) return QVORTEX_ERROR_NULL_POINTER;
+   *out = NULL;
+   if (capacity == 0 || capacity > QVORTEX_INDEX_MAX_CAPACITY) return QVORTEX_ERROR_UNSUPPORTED;
+ 
+ #if HAVE_POSIX_IO
+   qvortex_index *ix = (qvortex_index *)calloc(1, sizeof(*ix));
+   if (!ix) return QVORTEX_ERROR_MEMORY_ALLOCATION;
+   int rc = qvortex_lite_index_create(path, capacity, ix);
+   if (rc != QVORTEX_SUCCESS) {
+     free(ix);
+     return rc;
    }
+   *out = ix;
+   return QVORTEX_SUCCESS;
+ #else
+   return QVORTEX_ERROR_UNSUPPORTED;
+ #endif
  }
  
- static inline void qvortex_lite_final(qvortex_lite_ctx *ctx, uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
-   /* Padding: Append 0x80, then zeros, then length */
-   size_t current_len = ctx->buffer_len;
-   ctx->buffer[current_len++] = 0x80;  /* Append 1 bit (0x80 byte) */
+ /**
+  * Map an existing digest index; nothing is read until it is queried
+  *
+  * @param path     Index file from qvortex_index_create
+  * @param writable Non-zero to allow inserts (one writer at a time)
+  * @param out      Receives the open index
+  *
+  * @return 0 on success, QVORTEX_ERROR_FORMAT if the file is not an index
+  */
+ int qvortex_index_open(const char *path, int writable, qvortex_index **out) {
+   if (!path || !out) return QVORTEX_ERROR_NULL_POINTER;
+   *out = NULL;
  
-   /* Zero pad until space for length encoding */
-   size_t pad_zeros = QVORTEX_LITE_BLOCK_BYTES - (current_len % QVORTEX_LITE_BLOCK_BYTES);
-   if (pad_zeros < 8) {  /* Need at least 8 bytes for length */
-     pad_zeros += QVORTEX_LITE_BLOCK_BYTES;
+ #if HAVE_POSIX_IO
+   qvortex_index *ix = (qvortex_index *)calloc(1, sizeof(*ix));
+   if (!ix) return QVORTEX_ERROR_MEMORY_ALLOCATION;
+   int rc = qvortex_lite_index_open(path, writable, ix);
+   if (rc != QVORTEX_SUCCESS) {
+     free(ix);
+     return rc;
    }
-   pad_zeros -= 8;  /* Reserve space for length */
+   *out = ix;
+   return QVORTEX_SUCCESS;
+ #else
+   (void)writable;
+   return QVORTEX_ERROR_UNSUPPORTED;
+ #endif
+ }
  
-   if (current_len + pad_zeros > QVORTEX_LITE_BLOCK_BYTES) {
-     memset(&ctx->buffer[current_len], 0, QVORTEX_LITE_BLOCK_BYTES - current_len);
-     qvortex_lite_process_block(ctx, ctx->buffer);
-     current_len = 0;
-     memset(ctx->buffer, 0, QVORTEX_LITE_BLOCK_BYTES);
-   } else {
-     memset(&ctx->buffer[current_len], 0, pad_zeros);
-   }
-   current_len += pad_zeros;
+ /**
+  * Look up one digest
+  *
+  * @param ix     Open index
+  * @param digest 64-byte digest
+  * @param value  Receives the stored value if found
+  * @param found  Set to 1 if the digest is present, else 0
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_index_lookup(const qvortex_index *ix, const uint8_t digest[QVORTEX_LITE_DIGEST_BYTES],
+                          uint64_t *value, int *found) {
+   if (!ix || !digest || !value || !found) return QVORTEX_ERROR_NULL_POINTER;
  
-   /* Append total length in bits (little-endian 64-bit) */
-   uint64_t total_bits = ctx->total_len * 8;
-   memcpy(&ctx->buffer[QVORTEX_LITE_BLOCK_BYTES - 8], &total_bits, 8);
+   *found = qvortex_lite_index_lookup(ix, digest, value);
+   return QVORTEX_SUCCESS;
+ }
  
-   /* Process the final padded block */
-   qvortex_lite_process_block(ctx, ctx->buffer);
+ /**
+  * Add a digest unless it is already present
+  *
+  * @param ix       Index opened writable
+  * @param digest   64-byte digest
+  * @param value    Value to store; if the digest exists, receives its value
+  * @param inserted Set to 1 if the entry was added, 0 if it already existed
+  *
+  * @return 0 on success, QVORTEX_ERROR_UNSUPPORTED if read-only or full
+  */
+ int qvortex_index_insert(qvortex_index *ix, const uint8_t digest[QVORTEX_LITE_DIGEST_BYTES],
+                          uint64_t *value, int *inserted) {
+   if (!ix || !digest || !value || !inserted) return QVORTEX_ERROR_NULL_POINTER;
+   if (!ix->writable) return QVORTEX_ERROR_UNSUPPORTED;
  
-   /* Output: First N bytes of the state (little-endian) */
-   uint8_t *state_bytes = (uint8_t *)ctx->state;
-   memcpy(out, state_bytes, QVORTEX_LITE_DIGEST_BYTES);
+   int rc = qvortex_lite_index_insert(ix, digest, value);
+   if (rc < 0) return rc;
+   *inserted = rc;
+   return QVORTEX_SUCCESS;
+ }
  
-   /* Zeroize context state for security */
-   memset(ctx, 0, sizeof(qvortex_lite_ctx));
+ /**
+  * Look up many digests with their memory accesses overlapped
+  *
+  * @param ix      Open index
+  * @param digests n digests of 64 bytes, back to back
+  * @param values  Receives the value of each digest found (n entries)
+  * @param n       Number of digests
+  * @param found   Bitmap of (n + 7) / 8 bytes; bit i is set if digest i was found
+  *
+  * @return 0 on success, non-zero on error
+  */
+ int qvortex_index_lookup_many(const qvortex_index *ix, const uint8_t *digests, uint64_t *values,
+                               size_t n, uint8_t *found) {
+   if (!ix || !found) return QVORTEX_ERROR_NULL_POINTER;
+   if (n > 0 && (!digests || !values)) return QVORTEX_ERROR_NULL_POINTER;
+ 
+   return qvortex_lite_index_many((qvortex_index *)ix, digests, values, n, found, 0);
  }
  
- /* ------------------------------------------------------------------------
-    Public API Functions (with C linkage)
-    ------------------------------------------------------------------------ */
+ /**
+  * Insert-or-get many digests, as qvortex_index_insert for each in turn
+  *
+  * A digest repeated within the batch is added once. If the index fills,
+  * the entries before the failing one remain inserted.
+  *
+  * @param ix       Index opened writable
+  * @param digests  n digests of 64 bytes, back to back
+  * @param values   Values to store; entries already present receive their value
+  * @param n        Number of digests
+  * @param inserted Bitmap of (n + 7) / 8 bytes; bit i is set if digest i was added
+  *
+  * @return 0 on success, QVORTEX_ERROR_UNSUPPORTED if read-only or full
+  */
+ int qvortex_index_insert_many(qvortex_index *ix, const uint8_t *digests, uint64_t *values,
+                               size_t n, uint8_t *inserted) {
+   if (!ix || !inserted) return QVORTEX_ERROR_NULL_POINTER;
+   if (n > 0 && (!digests || !values)) return QVORTEX_ERROR_NULL_POINTER;
+   if (!ix->writable) return QVORTEX_ERROR_UNSUPPORTED;
  
- #ifdef __cplusplus
- extern "C" {
- #endif
+   return qvortex_lite_index_many(ix, digests, values, n, inserted, 1);
+ }
  
  /**
-  * One-shot hash function for Qvortex
+  * Number of entries in the index
   *
-  * @param data            Input data to hash
-  * @param len             Length of input data
-  * @param blocks_per_sbox Legacy parameter (not used in Qvortex)
-  * @param use_precomputed Legacy parameter (not used in Qvortex)
-  * @param key             Optional key for keyed hashing
-  * @param key_len         Length of key
-  * @param out             Output buffer (64 bytes)
+  * @param ix Open index
+  *
+  * @return Entry count, 0 if ix is NULL
+  */
+ uint64_t qvortex_index_count(const qvortex_index *ix) {
+   if (!ix) return 0;
+   return __atomic_load_n(&ix->hdr->count, __ATOMIC_ACQUIRE);
+ }
+ 
+ /**
+  * Flush inserted entries to disk
+  *
+  * @param ix Open index
   *
   * @return 0 on success, non-zero on error
   */
- int qvortex_hash(const uint8_t *data, size_t len,
-                 int blocks_per_sbox, int use_precomputed,
-                 const uint8_t *key, size_t key_len,
-                 uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
-   
-   /* Parameter validation */
-   if (!data && len > 0) return QVORTEX_ERROR_NULL_POINTER;
-   if (!out) return QVORTEX_ERROR_NULL_POINTER;
-   
-   /* Backward compatibility with old VortexHash API, but using new QvortexLite */
-   qvortex_lite_ctx ctx;
-   qvortex_lite_init(&ctx, key, key_len);
-   qvortex_lite_update(&ctx, data, len);
-   qvortex_lite_final(&ctx, out);
-   
+ int qvortex_index_sync(qvortex_index *ix) {
+   if (!ix) return QVORTEX_ERROR_NULL_POINTER;
+ 
+ #if HAVE_POSIX_IO
+   if (ix->writable && msync(ix->map, ix->map_len, MS_SYNC) != 0) return QVORTEX_ERROR_IO;
    return QVORTEX_SUCCESS;
+ #else
+   return QVORTEX_ERROR_UNSUPPORTED;
+ #endif
  }
  
  /**
-  * Initialize a Qvortex context
-  * 
-  * @param ctx     Pointer to context structure
+  * Unmap and close an index; inserts reach the file even without a sync
+  *
+  * @param ix Index from qvortex_index_create or qvortex_index_open (NULL is ignored)
+  */
+ void qvortex_index_close(qvortex_index *ix) {
+   if (!ix) return;
+ 
+ #if HAVE_POSIX_IO
+   munmap(ix->map, ix->map_len);
+   close(ix->fd);
+ #endif
+   free(ix);
+ }
+ 
+ /**
+  * Open the GPU batch backend under a key
+  *
+  * The key schedule runs once on the CPU and its S-box and initial state
+  * are uploaded to the device, to be reused by every batch.
+  *
   * @param key     Optional key for keyed hashing
   * @param key_len Length of key
-  * 
-  * @return 0 on success, non-zero on error
+  * @param out     Receives the handle
+  *
+  * @return 0 on success, QVORTEX_ERROR_UNSUPPORTED if built without a GPU
+  *         backend or no device is present
   */
- int qvortex_init(qvortex_lite_ctx *ctx, const uint8_t *key, size_t key_len) {
-   if (!ctx) return QVORTEX_ERROR_NULL_POINTER;
-   
-   qvortex_lite_init(ctx, key, key_len);
+ int qvortex_gpu_new(const uint8_t *key, size_t key_len, qvortex_gpu **out) {
+   if (!out) return QVORTEX_ERROR_NULL_POINTER;
+   *out = NULL;
+ 
+ #if QVORTEX_GPU
+   qvortex_template scratch;
+   const qvortex_template *tpl = qvortex_lite_template_get(&scratch, key, key_len);
+   qvortex_gpu *g = (qvortex_gpu *)calloc(1, sizeof(*g));
+   if (!g) return QVORTEX_ERROR_MEMORY_ALLOCATION;
+ 
+   int rc = qvortex_gpu_device_open(tpl->sbox, tpl->state, &g->dev);
+   memset(&scratch, 0, sizeof(scratch));
+   if (rc != QVORTEX_SUCCESS) {
+     free(g);
+     return rc;
+   }
+   *out = g;
    return QVORTEX_SUCCESS;
+ #else
+   (void)key;
+   (void)key_len;
+   return QVORTEX_ERROR_UNSUPPORTED;
+ #endif
  }
  
  /**
-  * Update a Qvortex context with new data
-  * 
-  * @param ctx  Pointer to context structure
-  * @param data Input data to hash
-  * @param len  Length of input data
-  * 
-  * @return 0 on success, non-zero on error
+  * Hash a batch of records that share one buffer, one GPU thread per record
+  *
+  * Meant for many small records (each is hashed serially by its thread);
+  * digests equal qvortex_hash of each record under the handle's key.
+  *
+  * @param g       Handle from qvortex_gpu_new
+  * @param data    Buffer holding every record
+  * @param len     Length of data
+  * @param records n (offset, length) pairs, each within data
+  * @param n       Number of records
+  * @param out     Output buffer (n * 64 bytes, digest i at out + 64 * i)
+  *
+  * @return 0 on success, QVORTEX_ERROR_FORMAT if a record lies outside data
   */
- int qvortex_update(qvortex_lite_ctx *ctx, const uint8_t *data, size_t len) {
-   if (!ctx) return QVORTEX_ERROR_NULL_POINTER;
-   if (!data && len > 0) return QVORTEX_ERROR_NULL_POINTER;
-   
-   qvortex_lite_update(ctx, data, len);
-   return QVORTEX_SUCCESS;
+ int qvortex_gpu_hash_records(qvortex_gpu *g, const uint8_t *data, size_t len,
+                              const qvortex_range *records, size_t n, uint8_t *out) {
+   if (!g) return QVORTEX_ERROR_NULL_POINTER;
+   if ((!data && len > 0) || (n > 0 && (!records || !out))) return QVORTEX_ERROR_NULL_POINTER;
+   if (n > SIZE_MAX / QVORTEX_LITE_DIGEST_BYTES) return QVORTEX_ERROR_UNSUPPORTED;
+   for (size_t i = 0; i < n; i++) {
+     if (records[i].offset > len || records[i].length > len - records[i].offset) {
+       return QVORTEX_ERROR_FORMAT;
+     }
+   }
+   if (n == 0) return QVORTEX_SUCCESS;
+ 
+ #if QVORTEX_GPU
+   return qvortex_gpu_device_hash(g->dev, data, len, (const qvortex_gpu_record *)records, n, out);
+ #else
+   return QVORTEX_ERROR_UNSUPPORTED;
+ #endif
  }
  
  /**
-  * Finalize a Qvortex context and output the digest
-  * 
-  * @param ctx Pointer to context structure
-  * @param out Output buffer (64 bytes)
-  * 
-  * @return 0 on success, non-zero on error
+  * Programming interface of the GPU backend built in
+  *
+  * @return "cuda" or "metal", or NULL if the library has no GPU backend
   */
- int qvortex_final(qvortex_lite_ctx *ctx, uint8_t out[QVORTEX_LITE_DIGEST_BYTES]) {
-   if (!ctx) return QVORTEX_ERROR_NULL_POINTER;
+ const char *qvortex_gpu_api(void) {
+ #if QVORTEX_GPU
+   return qvortex_gpu_device_api();
+ #else
+   return NULL;
+ #endif
+ }
+ 
+ /**
+  * Release a GPU handle and its device buffers
+  *
+  * @param g Handle from qvortex_gpu_new (NULL is ignored)
+  */
+ void qvortex_gpu_free(qvortex_gpu *g) {
+   if (!g) return;
+ 
+ #if QVORTEX_GPU
+   qvortex_gpu_device_close(g->dev);
+ #endif
+   free(g);
+ }
+ 
+ /**
+  * Name of the backend selected for this process
+  *
+  * One of "avx512-vbmi", "avx512", "avx2", "sve-sha3", "sve", "neon-sha3",
+  * "neon" or "scalar". The best supported backend is chosen when the library loads;
+  * QVORTEX_BACKEND in the environment or qvortex_set_backend() can
+  * override it.
+  *
+  * @return Backend name
+  */
+ const char* qvortex_backend_name(void) {
+   return qvortex_backend_get()->name;
+ }
+ 
+ /**
+  * Read the performance counters
+  *
+  * Counters are kept per thread, so counting never contends; the snapshot
+  * sums every live thread plus all threads that have exited (only the
+  * calling thread where pthreads are unavailable). Counts from concurrently
+  * running threads may be a few calls behind. Take two snapshots and
+  * subtract them to measure an interval.
+  *
+  * @param out Receives the totals and the selected backend
+  *
+  * @return 0 on success, QVORTEX_ERROR_UNSUPPORTED (with zero counts and
+  *         the backend filled in) if built without -DQVORTEX_STATS=1
+  */
+ int qvortex_stats_snapshot(qvortex_stats *out) {
    if (!out) return QVORTEX_ERROR_NULL_POINTER;
-   
-   qvortex_lite_final(ctx, out);
+ 
+   memset(out, 0, sizeof(*out));
+   out->backend = qvortex_backend_get()->name;
+ #if QVORTEX_STATS
+   qvortex_stats_slot sum;
+   memset(&sum, 0, sizeof(sum));
+ #if HAVE_PTHREADS
+   pthread_mutex_lock(&qvortex_stats_lock);
+   qvortex_stats_accumulate(&sum, &qvortex_stats_retired);
+   for (const qvortex_stats_slot *s = qvortex_stats_live; s; s = s->next) {
+     qvortex_stats_accumulate(&sum, s);
+   }
+   pthread_mutex_unlock(&qvortex_stats_lock);
+ #else
+   sum = qvortex_stats_tls;
+ #endif
+   out->bytes = sum.bytes;
+   out->blocks = sum.blocks;
+   out->shake128_calls = sum.shake128_calls;
+   out->tail_copies = sum.tail_copies;
    return QVORTEX_SUCCESS;
+ #else
+   return QVORTEX_ERROR_UNSUPPORTED;
+ #endif
  }
  
  /**
-  * Return the version string of the Qvortex implementation
-  * 
-  * @return Version string
+  * Force a specific backend (for testing and benchmarking)
+  *
+  * Digests are identical across backends, but switching while other threads
+  * are hashing is not supported.
+  *
+  * @param name Backend name, or NULL to restore the automatic choice
+  *
+  * @return 0 on success, QVORTEX_ERROR_UNSUPPORTED if the backend is unknown
+  *         or this CPU cannot run it
   */
- const char* qvortex_version(void) {
-   static char version[16];
-   snprintf(version, sizeof(version), "%d.%d.%d", 
-            QVORTEX_VERSION_MAJOR, 
-            QVORTEX_VERSION_MINOR, 
-            QVORTEX_VERSION_PATCH);
-   return version;
+ int qvortex_set_backend(const char *name) {
+   const qvortex_backend *b = name ? qvortex_find_backend(name) : qvortex_select_backend();
+   if (!b) return QVORTEX_ERROR_UNSUPPORTED;
+ 
+   __atomic_store_n(&qvortex_active_backend, b, __ATOMIC_RELEASE);
+   return QVORTEX_SUCCESS;
  }
  
  /* Backward compatibility with old VortexHash API */
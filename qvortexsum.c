@@ -0,0 +1,300 @@
+/**
+ * qvortexsum - print or check Qvortex-512 checksums
+ *
+ * Output and --check input use the sha256sum format: the 128-digit hex
+ * digest, two spaces, then the file name. Files are hashed through
+ * qvortex_hash_file, so large files are memory-mapped rather than read,
+ * and -j hashes several files at once.
+ *
+ * Built by build_qvortex.sh alongside the library (POSIX systems only).
+ */
+
+ #include <getopt.h>
+ #include "qvortex_lib.c"
+ 
+ #define QVORTEXSUM_HEX_DIGITS (2 * QVORTEX_LITE_DIGEST_BYTES)
+ 
+ typedef struct {
+   const char *name;                    /* "-" is standard input */
+   uint8_t expected[QVORTEX_LITE_DIGEST_BYTES];
+   uint8_t digest[QVORTEX_LITE_DIGEST_BYTES];
+   int rc;
+   int err;                             /* errno when rc == QVORTEX_ERROR_IO */
+ } qvortexsum_job;
+ 
+ typedef struct {
+   const qvortex_template *tpl;
+   qvortexsum_job *jobs;
+   size_t njobs;
+   size_t next;                         /* claimed with an atomic add */
+ } qvortexsum_batch;
+ 
+ static const char *qvortexsum_prog = "qvortexsum";
+ 
+ static void qvortexsum_run_job(const qvortex_template *tpl, qvortexsum_job *job) {
+   errno = 0;
+   if (strcmp(job->name, "-") == 0) {
+     job->rc = qvortex_lite_hash_fd(tpl, STDIN_FILENO, job->digest);
+   } else {
+     job->rc = qvortex_lite_hash_file(tpl, job->name, job->digest);
+   }
+   job->err = errno;
+ }
+ 
+ static void *qvortexsum_worker(void *arg) {
+   qvortexsum_batch *batch = (qvortexsum_batch *)arg;
+   for (;;) {
+     size_t i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED);
+     if (i >= batch->njobs) break;
+     qvortexsum_run_job(batch->tpl, &batch->jobs[i]);
+   }
+   return NULL;
+ }
+ 
+ /* Hash every job, on up to nthreads threads including the caller */
+ static void qvortexsum_run(const qvortex_template *tpl, qvortexsum_job *jobs, size_t njobs,
+                            long nthreads) {
+   qvortexsum_batch batch = { tpl, jobs, njobs, 0 };
+   pthread_t threads[64];
+   long started = 0;
+ 
+   if (nthreads > 64) nthreads = 64;
+   if ((size_t)nthreads > njobs) nthreads = (long)njobs;
+   while (started < nthreads - 1 &&
+          pthread_create(&threads[started], NULL, qvortexsum_worker, &batch) == 0) {
+     started++;
+   }
+   qvortexsum_worker(&batch);
+   for (long t = 0; t < started; t++) pthread_join(threads[t], NULL);
+ }
+ 
+ static void qvortexsum_report_error(const qvortexsum_job *job) {
+   if (job->rc == QVORTEX_ERROR_IO && job->err) {
+     fprintf(stderr, "%s: %s: %s\n", qvortexsum_prog, job->name, strerror(job->err));
+   } else {
+     fprintf(stderr, "%s: %s: hashing failed (error %d)\n", qvortexsum_prog, job->name, job->rc);
+   }
+ }
+ 
+ static int qvortexsum_hex_value(int c) {
+   if (c >= '0' && c <= '9') return c - '0';
+   if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+   if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+   return -1;
+ }
+ 
+ /* Parse "<hex>  <name>" or "<hex> *<name>"; returns the name or NULL */
+ static char *qvortexsum_parse_line(char *line, uint8_t digest[QVORTEX_LITE_DIGEST_BYTES]) {
+   size_t len = strlen(line);
+   while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) line[--len] = '\0';
+   if (len < QVORTEXSUM_HEX_DIGITS + 2) return NULL;
+ 
+   for (int i = 0; i < QVORTEX_LITE_DIGEST_BYTES; i++) {
+     int hi = qvortexsum_hex_value(line[2 * i]);
+     int lo = qvortexsum_hex_value(line[2 * i + 1]);
+     if (hi < 0 || lo < 0) return NULL;
+     digest[i] = (uint8_t)(hi << 4 | lo);
+   }
+ 
+   char *p = line + QVORTEXSUM_HEX_DIGITS;
+   if (p[0] != ' ' || (p[1] != ' ' && p[1] != '*') || p[2] == '\0') return NULL;
+   return p + 2;
+ }
+ 
+ static int qvortexsum_check(const qvortex_template *tpl, char **lists, int nlists,
+                             long nthreads, int quiet, int status) {
+   qvortexsum_job *jobs = NULL;
+   char **names = NULL;
+   size_t njobs = 0, cap = 0, bad_lines = 0, mismatched = 0, unreadable = 0;
+   int failed = 0;
+ 
+   for (int l = 0; l < nlists; l++) {
+     FILE *f = strcmp(lists[l], "-") == 0 ? stdin : fopen(lists[l], "r");
+     if (!f) {
+       fprintf(stderr, "%s: %s: %s\n", qvortexsum_prog, lists[l], strerror(errno));
+       failed = 1;
+       continue;
+     }
+ 
+     char line[QVORTEXSUM_HEX_DIGITS + 4096];
+     size_t valid = 0;
+     while (fgets(line, sizeof(line), f)) {
+       uint8_t expected[QVORTEX_LITE_DIGEST_BYTES];
+       char *name = qvortexsum_parse_line(line, expected);
+       if (!name) {
+         bad_lines++;
+         continue;
+       }
+       if (njobs == cap) {
+         cap = cap ? 2 * cap : 64;
+         qvortexsum_job *grown = (qvortexsum_job *)realloc(jobs, cap * sizeof(*jobs));
+         char **grown_names = (char **)realloc(names, cap * sizeof(*names));
+         if (grown) jobs = grown;
+         if (grown_names) names = grown_names;
+         if (!grown || !grown_names) {
+           fprintf(stderr, "%s: out of memory\n", qvortexsum_prog);
+           exit(1);
+         }
+       }
+       names[njobs] = strdup(name);
+       if (!names[njobs]) {
+         fprintf(stderr, "%s: out of memory\n", qvortexsum_prog);
+         exit(1);
+       }
+       jobs[njobs].name = names[njobs];
+       memcpy(jobs[njobs].expected, expected, sizeof(expected));
+       njobs++;
+       valid++;
+     }
+     if (f != stdin) fclose(f);
+ 
+     if (valid == 0) {
+       fprintf(stderr, "%s: %s: no properly formatted checksum lines found\n",
+               qvortexsum_prog, lists[l]);
+       failed = 1;
+     }
+   }
+ 
+   if (njobs > 0) qvortexsum_run(tpl, jobs, njobs, nthreads);
+ 
+   for (size_t i = 0; i < njobs; i++) {
+     const qvortexsum_job *job = &jobs[i];
+     if (job->rc != QVORTEX_SUCCESS) {
+       unreadable++;
+       if (!status) {
+         qvortexsum_report_error(job);
+         printf("%s: FAILED open or read\n", job->name);
+       }
+     } else if (memcmp(job->digest, job->expected, QVORTEX_LITE_DIGEST_BYTES) != 0) {
+       mismatched++;
+       if (!status) printf("%s: FAILED\n", job->name);
+     } else if (!status && !quiet) {
+       printf("%s: OK\n", job->name);
+     }
+   }
+ 
+   if (!status) {
+     if (bad_lines) {
+       fprintf(stderr, "%s: WARNING: %zu line%s improperly formatted\n", qvortexsum_prog,
+               bad_lines, bad_lines == 1 ? " is" : "s are");
+     }
+     if (unreadable) {
+       fprintf(stderr, "%s: WARNING: %zu listed file%s could not be read\n", qvortexsum_prog,
+               unreadable, unreadable == 1 ? "" : "s");
+     }
+     if (mismatched) {
+       fprintf(stderr, "%s: WARNING: %zu computed checksum%s did NOT match\n", qvortexsum_prog,
+               mismatched, mismatched == 1 ? "" : "s");
+     }
+   }
+ 
+   for (size_t i = 0; i < njobs; i++) free(names[i]);
+   free(names);
+   free(jobs);
+   return (failed || unreadable || mismatched) ? 1 : 0;
+ }
+ 
+ static int qvortexsum_print(const qvortex_template *tpl, char **files, int nfiles, long nthreads) {
+   static char *stdin_only[] = { (char *)"-" };
+   int failed = 0;
+ 
+   if (nfiles == 0) {
+     files = stdin_only;
+     nfiles = 1;
+   }
+ 
+   qvortexsum_job *jobs = (qvortexsum_job *)calloc((size_t)nfiles, sizeof(*jobs));
+   if (!jobs) {
+     fprintf(stderr, "%s: out of memory\n", qvortexsum_prog);
+     return 1;
+   }
+   for (int i = 0; i < nfiles; i++) jobs[i].name = files[i];
+ 
+   qvortexsum_run(tpl, jobs, (size_t)nfiles, nthreads);
+ 
+   for (int i = 0; i < nfiles; i++) {
+     if (jobs[i].rc != QVORTEX_SUCCESS) {
+       qvortexsum_report_error(&jobs[i]);
+       failed = 1;
+       continue;
+     }
+     for (int j = 0; j < QVORTEX_LITE_DIGEST_BYTES; j++) printf("%02x", jobs[i].digest[j]);
+     printf("  %s\n", jobs[i].name);
+   }
+ 
+   free(jobs);
+   return failed;
+ }
+ 
+ static void qvortexsum_usage(FILE *f) {
+   fprintf(f,
+           "Usage: %s [OPTION]... [FILE]...\n"
+           "Print or check Qvortex-512 checksums.\n"
+           "With no FILE, or when FILE is -, read standard input.\n"
+           "\n"
+           "  -c, --check      read checksums from the FILEs and check them\n"
+           "  -k, --key=KEY    compute keyed checksums\n"
+           "  -j, --jobs=N     hash up to N files in parallel (0 = one per CPU)\n"
+           "      --quiet      don't print OK for each successfully verified file\n"
+           "      --status     don't output anything, status code shows success\n"
+           "  -h, --help       display this help and exit\n"
+           "      --version    output version information and exit\n",
+           qvortexsum_prog);
+ }
+ 
+ int main(int argc, char *argv[]) {
+   enum { OPT_QUIET = 256, OPT_STATUS, OPT_VERSION };
+   static const struct option long_options[] = {
+     { "check", no_argument, NULL, 'c' },
+     { "key", required_argument, NULL, 'k' },
+     { "jobs", required_argument, NULL, 'j' },
+     { "quiet", no_argument, NULL, OPT_QUIET },
+     { "status", no_argument, NULL, OPT_STATUS },
+     { "help", no_argument, NULL, 'h' },
+     { "version", no_argument, NULL, OPT_VERSION },
+     { NULL, 0, NULL, 0 }
+   };
+   const char *key = NULL;
+   int check = 0, quiet = 0, status = 0, opt;
+   long nthreads = 1;
+ 
+   while ((opt = getopt_long(argc, argv, "ck:j:h", long_options, NULL)) != -1) {
+     switch (opt) {
+     case 'c': check = 1; break;
+     case 'k': key = optarg; break;
+     case 'j': {
+       char *end;
+       nthreads = strtol(optarg, &end, 10);
+       if (*optarg == '\0' || *end != '\0' || nthreads < 0) {
+         fprintf(stderr, "%s: invalid number of jobs: '%s'\n", qvortexsum_prog, optarg);
+         return 1;
+       }
+       if (nthreads == 0) nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+       if (nthreads < 1) nthreads = 1;
+       break;
+     }
+     case OPT_QUIET: quiet = 1; break;
+     case OPT_STATUS: status = 1; break;
+     case 'h': qvortexsum_usage(stdout); return 0;
+     case OPT_VERSION: printf("%s (Qvortex) %s\n", qvortexsum_prog, qvortex_version()); return 0;
+     default: qvortexsum_usage(stderr); return 1;
+     }
+   }
+ 
+   if (!check && (quiet || status)) {
+     fprintf(stderr, "%s: --quiet and --status only apply when verifying checksums\n",
+             qvortexsum_prog);
+     return 1;
+   }
+ 
+   qvortex_template tpl;
+   qvortex_lite_template_init(&tpl, (const uint8_t *)key, key ? strlen(key) : 0);
+ 
+   if (check) {
+     static char *stdin_only[] = { (char *)"-" };
+     char **lists = optind < argc ? &argv[optind] : stdin_only;
+     int nlists = optind < argc ? argc - optind : 1;
+     return qvortexsum_check(&tpl, lists, nlists, nthreads, quiet, status);
+   }
+   return qvortexsum_print(&tpl, &argv[optind], argc - optind, nthreads);
+ }